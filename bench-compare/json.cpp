@@ -0,0 +1,315 @@
+#include "json.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#include <cstdlib>
+#include <cstdint>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	class Parser_
+	{
+		public:
+			explicit Parser_( std::string_view aText )
+				: mText( aText )
+			{}
+
+		public:
+			JsonValue parse_document()
+			{
+				auto ret = parse_value_();
+
+				skip_ws_();
+				if( mPos != mText.size() )
+					fail_( "trailing characters after document" );
+
+				return ret;
+			}
+
+		private:
+			JsonValue parse_value_()
+			{
+				skip_ws_();
+				if( mPos >= mText.size() )
+					fail_( "unexpected end of input" );
+
+				JsonValue ret;
+				switch( mText[mPos] )
+				{
+					case '{': parse_object_( ret ); break;
+					case '[': parse_array_( ret ); break;
+					case '"':
+						ret.type = JsonValue::Type::string;
+						ret.string = parse_string_();
+						break;
+					case 't':
+						expect_literal_( "true" );
+						ret.type = JsonValue::Type::boolean;
+						ret.boolean = true;
+						break;
+					case 'f':
+						expect_literal_( "false" );
+						ret.type = JsonValue::Type::boolean;
+						break;
+					case 'n':
+						expect_literal_( "null" );
+						break;
+					default:
+						ret.type = JsonValue::Type::number;
+						ret.number = parse_number_();
+						break;
+				}
+
+				return ret;
+			}
+
+			void parse_object_( JsonValue& aOut )
+			{
+				aOut.type = JsonValue::Type::object;
+				++mPos; // '{'
+
+				skip_ws_();
+				if( consume_( '}' ) )
+					return;
+
+				do
+				{
+					skip_ws_();
+					if( mPos >= mText.size() || '"' != mText[mPos] )
+						fail_( "expected member name" );
+
+					auto name = parse_string_();
+
+					skip_ws_();
+					if( !consume_( ':' ) )
+						fail_( "expected ':'" );
+
+					aOut.object.emplace_back( std::move(name), parse_value_() );
+					skip_ws_();
+				} while( consume_( ',' ) );
+
+				if( !consume_( '}' ) )
+					fail_( "expected ',' or '}'" );
+			}
+
+			void parse_array_( JsonValue& aOut )
+			{
+				aOut.type = JsonValue::Type::array;
+				++mPos; // '['
+
+				skip_ws_();
+				if( consume_( ']' ) )
+					return;
+
+				do
+				{
+					aOut.array.emplace_back( parse_value_() );
+					skip_ws_();
+				} while( consume_( ',' ) );
+
+				if( !consume_( ']' ) )
+					fail_( "expected ',' or ']'" );
+			}
+
+			std::string parse_string_()
+			{
+				++mPos; // '"'
+
+				std::string ret;
+				while( mPos < mText.size() && '"' != mText[mPos] )
+				{
+					char const ch = mText[mPos++];
+					if( '\\' != ch )
+					{
+						ret += ch;
+						continue;
+					}
+
+					if( mPos >= mText.size() )
+						break;
+
+					switch( char const esc = mText[mPos++] )
+					{
+						case '"': case '\\': case '/': ret += esc; break;
+						case 'b': ret += '\b'; break;
+						case 'f': ret += '\f'; break;
+						case 'n': ret += '\n'; break;
+						case 'r': ret += '\r'; break;
+						case 't': ret += '\t'; break;
+						case 'u': append_utf8_( ret, parse_hex4_() ); break;
+						default: fail_( "invalid escape sequence" );
+					}
+				}
+
+				if( !consume_( '"' ) )
+					fail_( "unterminated string" );
+
+				return ret;
+			}
+
+			std::uint32_t parse_hex4_()
+			{
+				if( mPos + 4 > mText.size() )
+					fail_( "truncated \\u escape" );
+
+				std::uint32_t ret = 0;
+				for( int i = 0; i < 4; ++i )
+				{
+					char const ch = mText[mPos++];
+					ret <<= 4;
+					if( ch >= '0' && ch <= '9' ) ret |= std::uint32_t(ch - '0');
+					else if( ch >= 'a' && ch <= 'f' ) ret |= std::uint32_t(ch - 'a' + 10);
+					else if( ch >= 'A' && ch <= 'F' ) ret |= std::uint32_t(ch - 'A' + 10);
+					else fail_( "invalid \\u escape" );
+				}
+
+				return ret;
+			}
+
+			static void append_utf8_( std::string& aOut, std::uint32_t aCode )
+			{
+				// Surrogate pairs are not combined; Google Benchmark does not
+				// produce them.
+				if( aCode < 0x80 )
+					aOut += char(aCode);
+				else if( aCode < 0x800 )
+				{
+					aOut += char(0xC0 | (aCode >> 6));
+					aOut += char(0x80 | (aCode & 0x3F));
+				}
+				else
+				{
+					aOut += char(0xE0 | (aCode >> 12));
+					aOut += char(0x80 | ((aCode >> 6) & 0x3F));
+					aOut += char(0x80 | (aCode & 0x3F));
+				}
+			}
+
+			double parse_number_()
+			{
+				auto const beg = mPos;
+				while( mPos < mText.size() )
+				{
+					char const ch = mText[mPos];
+					if( (ch >= '0' && ch <= '9') || '-' == ch || '+' == ch || '.' == ch || 'e' == ch || 'E' == ch )
+						++mPos;
+					else
+						break;
+				}
+
+				if( beg == mPos )
+					fail_( "unexpected character '{}'", mText[mPos] );
+
+				std::string const num( mText.substr( beg, mPos-beg ) );
+				char* end = nullptr;
+				double const ret = std::strtod( num.c_str(), &end );
+				if( end != num.c_str() + num.size() )
+					fail_( "invalid number '{}'", num );
+
+				return ret;
+			}
+
+			void expect_literal_( std::string_view aLiteral )
+			{
+				if( mText.substr( mPos, aLiteral.size() ) != aLiteral )
+					fail_( "expected '{}'", aLiteral );
+
+				mPos += aLiteral.size();
+			}
+
+			void skip_ws_() noexcept
+			{
+				while( mPos < mText.size() )
+				{
+					char const ch = mText[mPos];
+					if( ' ' != ch && '\t' != ch && '\n' != ch && '\r' != ch )
+						break;
+
+					++mPos;
+				}
+			}
+
+			bool consume_( char aChar ) noexcept
+			{
+				if( mPos < mText.size() && aChar == mText[mPos] )
+				{
+					++mPos;
+					return true;
+				}
+
+				return false;
+			}
+
+			template< typename... tArgs >
+			[[noreturn]] void fail_( std::format_string<tArgs...> aFmt, tArgs&&... aArgs ) const
+			{
+				// Report line number, which is what users will look for
+				std::size_t line = 1;
+				for( std::size_t i = 0; i < mPos && i < mText.size(); ++i )
+				{
+					if( '\n' == mText[i] )
+						++line;
+				}
+
+				throw Error( "JSON parse error on line {}: {}", line, std::format( aFmt, std::forward<tArgs>(aArgs)... ) );
+			}
+
+		private:
+			std::string_view mText;
+			std::size_t mPos = 0;
+	};
+}
+
+JsonValue const* JsonValue::find( std::string_view aName ) const noexcept
+{
+	for( auto const& [name, value] : object )
+	{
+		if( name == aName )
+			return &value;
+	}
+
+	return nullptr;
+}
+
+std::string JsonValue::string_or( std::string_view aName, std::string_view aFallback ) const
+{
+	if( auto const* value = find( aName ); value && Type::string == value->type )
+		return value->string;
+
+	return std::string( aFallback );
+}
+double JsonValue::number_or( std::string_view aName, double aFallback ) const noexcept
+{
+	if( auto const* value = find( aName ); value && Type::number == value->type )
+		return value->number;
+
+	return aFallback;
+}
+
+
+JsonValue parse_json( std::string_view aText )
+{
+	return Parser_( aText ).parse_document();
+}
+
+JsonValue load_json( char const* aPath )
+{
+	std::ifstream file( aPath, std::ios::binary );
+	if( !file )
+		throw Error( "Unable to open '{}' for reading", aPath );
+
+	std::ostringstream text;
+	text << file.rdbuf();
+
+	try
+	{
+		return parse_json( text.str() );
+	}
+	catch( Error const& eErr )
+	{
+		throw Error( "{}: {}", aPath, eErr.what() );
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef JSON_HPP_92482290_66C6_406F_9B65_D5B53C619241
+#define JSON_HPP_92482290_66C6_406F_9B65_D5B53C619241
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <string_view>
+
+/* Minimal JSON document
+ *
+ * Just enough to read Google Benchmark's JSON output. Numbers are stored as
+ * doubles. Object members are kept in their original order; lookup is linear.
+ */
+struct JsonValue
+{
+	enum class Type
+	{
+		null,
+		boolean,
+		number,
+		string,
+		array,
+		object
+	};
+
+	Type type = Type::null;
+
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+
+	std::vector<JsonValue> array;
+	std::vector<std::pair<std::string,JsonValue>> object;
+
+	// Returns the member with the given name, or nullptr if this is not an
+	// object or if there is no such member.
+	JsonValue const* find( std::string_view ) const noexcept;
+
+	// Convenience accessors. Return the fallback if the member does not exist
+	// or has a different type.
+	std::string string_or( std::string_view aName, std::string_view aFallback ) const;
+	double number_or( std::string_view aName, double aFallback ) const noexcept;
+};
+
+// Parse JSON text. Throws Error on malformed input.
+JsonValue parse_json( std::string_view );
+
+// Read and parse a JSON file. Throws Error on failure.
+JsonValue load_json( char const* aPath );
+
+#endif // JSON_HPP_92482290_66C6_406F_9B65_D5B53C619241
@@ -0,0 +1,348 @@
+#include <print>
+#include <regex>
+#include <string>
+#include <vector>
+#include <typeinfo>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+#include <cmath>
+#include <cstdlib>
+
+#include "../support/error.hpp"
+
+#include "json.hpp"
+#include "stats.hpp"
+
+/* bench-compare: compare two Google Benchmark JSON results
+ *
+ *   bench-compare [options] <baseline.json> <contender.json>
+ *
+ * For each benchmark present in both runs, prints the median time of each run,
+ * the relative change and the p-value of a significance test. A benchmark is
+ * flagged as a regression if it got slower by more than the threshold AND the
+ * difference is statistically significant. The exit code is 1 if any
+ * regressions were found, and 0 otherwise.
+ *
+ * Runs should be made with repetitions, e.g.
+ *
+ *   bin/triangles-benchmark-release-x64-gcc.exe --benchmark_repetitions=10
+ *
+ * With per-repetition results available, the Mann-Whitney U test is used.
+ * With --benchmark_report_aggregates_only, the tool falls back to Welch's
+ * t-test on the mean/stddev aggregates.
+ */
+
+namespace
+{
+	struct Config_
+	{
+		char const* baseline = nullptr;
+		char const* contender = nullptr;
+
+		bool useCpuTime = true;
+		double alpha = 0.05;
+		double threshold = 0.05;
+		std::string filter;
+	};
+
+	struct Run_
+	{
+		std::vector<double> samples; // ns, one per repetition
+
+		double mean = NAN, median = NAN, stddev = NAN; // ns, from aggregates
+		double repetitions = 0.0;
+	};
+
+	struct Results_
+	{
+		std::string revision, cpuModel, date;
+
+		std::vector<std::string> order;
+		std::unordered_map<std::string, Run_> runs;
+	};
+
+	enum class Status_
+	{
+		unchanged,
+		improved,
+		regressed,
+		insufficient
+	};
+
+	Config_ parse_command_line_( int, char** );
+	void synopsis_( char const* );
+
+	Results_ load_results_( char const*, bool aUseCpuTime );
+
+	double to_ns_( double aTime, std::string const& aUnit );
+	std::string format_time_( double aNs );
+}
+
+int main( int aArgc, char* aArgv[] ) try
+{
+	auto const config = parse_command_line_( aArgc, aArgv );
+
+	auto const base = load_results_( config.baseline, config.useCpuTime );
+	auto const cont = load_results_( config.contender, config.useCpuTime );
+
+	std::print( "Baseline:  {} (revision {}, {})\n", config.baseline, base.revision, base.date );
+	std::print( "Contender: {} (revision {}, {})\n", config.contender, cont.revision, cont.date );
+	std::print( "CPU:       {}\n", base.cpuModel );
+
+	if( base.cpuModel != cont.cpuModel )
+	{
+		std::print( "WARNING: runs are from different CPUs ('{}' vs '{}'). Results are not comparable.\n", base.cpuModel, cont.cpuModel );
+	}
+
+	std::print( "Metric:    {} time, alpha = {}, threshold = {:.1f}%\n\n", config.useCpuTime ? "cpu" : "real", config.alpha, 100.0 * config.threshold );
+
+	std::regex filter;
+	if( !config.filter.empty() )
+		filter = std::regex( config.filter );
+
+	std::size_t nameWidth = 9;
+	for( auto const& name : base.order )
+		nameWidth = std::max( nameWidth, name.size() );
+
+	std::print( "{:<{}}  {:>12}  {:>12}  {:>8}  {:>7}  {}\n", "Benchmark", nameWidth, "Baseline", "Contender", "Change", "p", "Status" );
+	std::print( "{:-<{}}\n", "", nameWidth + 60 );
+
+	std::size_t compared = 0, regressions = 0, improvements = 0, fewSamples = 0;
+	for( auto const& name : base.order )
+	{
+		if( !config.filter.empty() && !std::regex_search( name, filter ) )
+			continue;
+
+		auto const it = cont.runs.find( name );
+		if( cont.runs.end() == it )
+			continue;
+
+		auto const& a = base.runs.at( name );
+		auto const& b = it->second;
+
+		// Prefer the median over the mean: it is less sensitive to outliers
+		// from e.g. the OS scheduling other work.
+		auto const central_ = [] (Run_ const& aRun) {
+			if( !aRun.samples.empty() ) return median( aRun.samples );
+			if( !std::isnan( aRun.median ) ) return aRun.median;
+			return aRun.mean;
+		};
+
+		double const ma = central_( a );
+		double const mb = central_( b );
+		double const change = (mb - ma) / ma;
+
+		double p = NAN;
+		if( a.samples.size() >= 2 && b.samples.size() >= 2 )
+		{
+			p = mann_whitney_u_test( a.samples, b.samples );
+			if( a.samples.size() < 9 || b.samples.size() < 9 )
+				++fewSamples;
+		}
+		else if( a.repetitions >= 2.0 && b.repetitions >= 2.0 && !std::isnan( a.stddev ) && !std::isnan( b.stddev ) )
+		{
+			p = welch_t_test( a.mean, a.stddev, a.repetitions, b.mean, b.stddev, b.repetitions );
+		}
+
+		Status_ status = Status_::insufficient;
+		if( !std::isnan( p ) )
+		{
+			status = Status_::unchanged;
+			if( p < config.alpha && change > config.threshold )
+				status = Status_::regressed;
+			else if( p < config.alpha && change < -config.threshold )
+				status = Status_::improved;
+		}
+
+		char const* statusStr = "";
+		switch( status )
+		{
+			case Status_::unchanged: statusStr = ""; break;
+			case Status_::improved: statusStr = "improved"; ++improvements; break;
+			case Status_::regressed: statusStr = "REGRESSION"; ++regressions; break;
+			case Status_::insufficient: statusStr = "(no repetitions)"; break;
+		}
+
+		std::print( "{:<{}}  {:>12}  {:>12}  {:>+7.1f}%  {:>7}  {}\n",
+			name, nameWidth,
+			format_time_( ma ), format_time_( mb ),
+			100.0 * change,
+			std::isnan( p ) ? std::string( "-" ) : std::format( "{:.4f}", p ),
+			statusStr
+		);
+
+		++compared;
+	}
+
+	std::print( "\n{} benchmarks compared: {} regression(s), {} improvement(s)\n", compared, regressions, improvements );
+
+	if( fewSamples )
+		std::print( "NOTE: {} benchmark(s) have fewer than 9 repetitions; the U test is unreliable. Use --benchmark_repetitions=10 or more.\n", fewSamples );
+
+	return regressions ? 1 : 0;
+}
+catch( std::exception const& eErr )
+{
+	std::print( stderr, "Top-level Exception ({}):\n", typeid(eErr).name() );
+	std::print( stderr, "{}\n", eErr.what() );
+	std::print( stderr, "Bye.\n" );
+	return 2;
+}
+
+
+namespace
+{
+	Config_ parse_command_line_( int aArgc, char** aArgv )
+	{
+		Config_ config;
+
+		for( int i = 1; i < aArgc; ++i )
+		{
+			std::string_view const arg = aArgv[i];
+
+			if( !arg.starts_with( "--" ) )
+			{
+				if( !config.baseline )
+					config.baseline = aArgv[i];
+				else if( !config.contender )
+					config.contender = aArgv[i];
+				else
+					throw Error( "Unexpected argument '{}'\nUse --help to print available command line options", arg );
+
+				continue;
+			}
+
+			auto const eq = arg.find( '=' );
+			auto const name = arg.substr( 2, eq == std::string_view::npos ? std::string_view::npos : eq-2 );
+			auto const value = eq == std::string_view::npos ? std::string_view() : arg.substr( eq+1 );
+
+			if( "help" == name )
+			{
+				synopsis_( aArgv[0] );
+				std::exit( 0 );
+			}
+			else if( "metric" == name && ("cpu" == value || "real" == value) )
+			{
+				config.useCpuTime = ("cpu" == value);
+			}
+			else if( "alpha" == name && !value.empty() )
+			{
+				config.alpha = std::strtod( std::string(value).c_str(), nullptr );
+			}
+			else if( "threshold" == name && !value.empty() )
+			{
+				config.threshold = 0.01 * std::strtod( std::string(value).c_str(), nullptr );
+			}
+			else if( "filter" == name )
+			{
+				config.filter = value;
+			}
+			else
+			{
+				throw Error( "Error while parsing command line\n"
+					"Unrecognized flag '{}'\n"
+					"Use --help to print available command line options", arg );
+			}
+		}
+
+		if( !config.baseline || !config.contender )
+			throw Error( "Expected two JSON files\nUse --help to print available command line options" );
+
+		return config;
+	}
+
+	void synopsis_( char const* aProgName )
+	{
+		std::print( "Synopsis: {} [options] <baseline.json> <contender.json>\n", aProgName );
+		std::print( "Compares two Google Benchmark JSON results.\n" );
+		std::print( "Options:\n" );
+		std::print( "  --help              : print this help and exit\n" );
+		std::print( "  --metric=cpu|real   : compare CPU time (default) or real time\n" );
+		std::print( "  --alpha=<p>         : significance level (default: 0.05)\n" );
+		std::print( "  --threshold=<pct>   : minimum slowdown in percent to report as\n" );
+		std::print( "                        regression (default: 5)\n" );
+		std::print( "  --filter=<regex>    : only compare matching benchmarks\n" );
+		std::print( "Exit code is 1 if there are regressions, 2 on errors, 0 otherwise.\n" );
+	}
+
+	Results_ load_results_( char const* aPath, bool aUseCpuTime )
+	{
+		auto const doc = load_json( aPath );
+
+		Results_ ret;
+		if( auto const* context = doc.find( "context" ) )
+		{
+			ret.revision = context->string_or( "git_revision", "unknown" );
+			ret.cpuModel = context->string_or( "cpu_model", "unknown" );
+			ret.date = context->string_or( "date", "unknown date" );
+		}
+
+		auto const* benchmarks = doc.find( "benchmarks" );
+		if( !benchmarks || JsonValue::Type::array != benchmarks->type )
+			throw Error( "{}: no 'benchmarks' array. Is this Google Benchmark JSON output?", aPath );
+
+		char const* const timeKey = aUseCpuTime ? "cpu_time" : "real_time";
+
+		for( auto const& bench : benchmarks->array )
+		{
+			if( auto const* err = bench.find( "error_occurred" ); err && err->boolean )
+				continue;
+
+			auto const name = bench.string_or( "run_name", bench.string_or( "name", "" ) );
+			if( name.empty() )
+				continue;
+
+			auto const* time = bench.find( timeKey );
+			if( !time || JsonValue::Type::number != time->type )
+				continue;
+
+			auto [it, inserted] = ret.runs.try_emplace( name );
+			if( inserted )
+				ret.order.emplace_back( name );
+
+			auto& run = it->second;
+			double const ns = to_ns_( time->number, bench.string_or( "time_unit", "ns" ) );
+
+			if( "aggregate" != bench.string_or( "run_type", "iteration" ) )
+			{
+				run.samples.push_back( ns );
+				continue;
+			}
+
+			// Aggregates: only the time-based ones are of interest (e.g., not
+			// the coefficient of variation "cv", which is a percentage).
+			if( "time" != bench.string_or( "aggregate_unit", "time" ) )
+				continue;
+
+			run.repetitions = bench.number_or( "repetitions", run.repetitions );
+
+			auto const aggregate = bench.string_or( "aggregate_name", "" );
+			if( "mean" == aggregate ) run.mean = ns;
+			else if( "median" == aggregate ) run.median = ns;
+			else if( "stddev" == aggregate ) run.stddev = ns;
+		}
+
+		return ret;
+	}
+
+	double to_ns_( double aTime, std::string const& aUnit )
+	{
+		if( "ns" == aUnit ) return aTime;
+		if( "us" == aUnit ) return aTime * 1e3;
+		if( "ms" == aUnit ) return aTime * 1e6;
+		if( "s" == aUnit ) return aTime * 1e9;
+
+		throw Error( "Unknown time unit '{}'", aUnit );
+	}
+
+	std::string format_time_( double aNs )
+	{
+		if( std::isnan( aNs ) ) return "-";
+		if( aNs < 1e3 ) return std::format( "{:.1f} ns", aNs );
+		if( aNs < 1e6 ) return std::format( "{:.1f} us", aNs * 1e-3 );
+		if( aNs < 1e9 ) return std::format( "{:.2f} ms", aNs * 1e-6 );
+		return std::format( "{:.2f} s", aNs * 1e-9 );
+	}
+}
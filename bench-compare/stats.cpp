@@ -0,0 +1,155 @@
+#include "stats.hpp"
+
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+#include <cmath>
+
+namespace
+{
+	// Continued fraction for the regularized incomplete beta function
+	// (modified Lentz's method).
+	double beta_cf_( double aA, double aB, double aX )
+	{
+		constexpr int kMaxIterations = 200;
+		constexpr double kEps = 1e-14;
+		constexpr double kTiny = 1e-300;
+
+		double const qab = aA + aB;
+		double const qap = aA + 1.0;
+		double const qam = aA - 1.0;
+
+		double c = 1.0;
+		double d = 1.0 - qab * aX / qap;
+		if( std::abs( d ) < kTiny ) d = kTiny;
+		d = 1.0 / d;
+
+		double h = d;
+		for( int m = 1; m <= kMaxIterations; ++m )
+		{
+			double const m2 = 2.0 * m;
+
+			double aa = m * (aB - m) * aX / ((qam + m2) * (aA + m2));
+			d = 1.0 + aa * d;
+			if( std::abs( d ) < kTiny ) d = kTiny;
+			c = 1.0 + aa / c;
+			if( std::abs( c ) < kTiny ) c = kTiny;
+			d = 1.0 / d;
+			h *= d * c;
+
+			aa = -(aA + m) * (qab + m) * aX / ((aA + m2) * (qap + m2));
+			d = 1.0 + aa * d;
+			if( std::abs( d ) < kTiny ) d = kTiny;
+			c = 1.0 + aa / c;
+			if( std::abs( c ) < kTiny ) c = kTiny;
+			d = 1.0 / d;
+
+			double const delta = d * c;
+			h *= delta;
+			if( std::abs( delta - 1.0 ) < kEps )
+				break;
+		}
+
+		return h;
+	}
+
+	// Regularized incomplete beta function I_x(a,b)
+	double incomplete_beta_( double aA, double aB, double aX )
+	{
+		if( aX <= 0.0 ) return 0.0;
+		if( aX >= 1.0 ) return 1.0;
+
+		double const lbeta = std::lgamma( aA + aB ) - std::lgamma( aA ) - std::lgamma( aB );
+		double const front = std::exp( lbeta + aA * std::log( aX ) + aB * std::log( 1.0 - aX ) );
+
+		// Use the symmetry relation where the continued fraction converges
+		// faster.
+		if( aX < (aA + 1.0) / (aA + aB + 2.0) )
+			return front * beta_cf_( aA, aB, aX ) / aA;
+
+		return 1.0 - front * beta_cf_( aB, aA, 1.0 - aX ) / aB;
+	}
+}
+
+double median( std::span<double const> aSamples )
+{
+	if( aSamples.empty() )
+		return std::numeric_limits<double>::quiet_NaN();
+
+	std::vector<double> sorted( aSamples.begin(), aSamples.end() );
+	std::sort( sorted.begin(), sorted.end() );
+
+	auto const n = sorted.size();
+	if( n % 2 )
+		return sorted[n/2];
+
+	return 0.5 * (sorted[n/2 - 1] + sorted[n/2]);
+}
+
+double mann_whitney_u_test( std::span<double const> aA, std::span<double const> aB )
+{
+	auto const n1 = double(aA.size());
+	auto const n2 = double(aB.size());
+	if( aA.empty() || aB.empty() )
+		return 1.0;
+
+	// Rank the pooled samples; ties receive the average of their ranks.
+	struct Sample_ { double value; bool fromA; };
+
+	std::vector<Sample_> pooled;
+	pooled.reserve( aA.size() + aB.size() );
+	for( auto const v : aA ) pooled.push_back( { v, true } );
+	for( auto const v : aB ) pooled.push_back( { v, false } );
+
+	std::sort( pooled.begin(), pooled.end(), [] (Sample_ const& aX, Sample_ const& aY) {
+		return aX.value < aY.value;
+	} );
+
+	double rankSumA = 0.0;
+	double tieTerm = 0.0; // sum over tie groups of t^3 - t
+	for( std::size_t i = 0; i < pooled.size(); )
+	{
+		std::size_t j = i + 1;
+		while( j < pooled.size() && pooled[j].value == pooled[i].value )
+			++j;
+
+		double const t = double(j - i);
+		double const rank = 0.5 * double(i + 1 + j); // average of ranks i+1 .. j
+		for( std::size_t k = i; k < j; ++k )
+		{
+			if( pooled[k].fromA )
+				rankSumA += rank;
+		}
+
+		tieTerm += t*t*t - t;
+		i = j;
+	}
+
+	double const n = n1 + n2;
+	double const u = rankSumA - n1 * (n1 + 1.0) * 0.5;
+	double const mu = n1 * n2 * 0.5;
+	double const sigma2 = n1 * n2 / 12.0 * ((n + 1.0) - tieTerm / (n * (n - 1.0)));
+	if( sigma2 <= 0.0 )
+		return 1.0; // all samples identical
+
+	double const z = std::max( 0.0, std::abs( u - mu ) - 0.5 ) / std::sqrt( sigma2 );
+	return std::erfc( z / std::sqrt( 2.0 ) );
+}
+
+double welch_t_test( double aMeanA, double aStddevA, double aCountA, double aMeanB, double aStddevB, double aCountB )
+{
+	if( aCountA < 2.0 || aCountB < 2.0 )
+		return 1.0;
+
+	double const va = aStddevA * aStddevA / aCountA;
+	double const vb = aStddevB * aStddevB / aCountB;
+	if( va + vb <= 0.0 )
+		return aMeanA == aMeanB ? 1.0 : 0.0;
+
+	double const t = (aMeanB - aMeanA) / std::sqrt( va + vb );
+	double const df = (va + vb) * (va + vb) / (va*va / (aCountA - 1.0) + vb*vb / (aCountB - 1.0));
+
+	// Two-sided p-value of Student's t distribution with df degrees of freedom
+	return incomplete_beta_( 0.5 * df, 0.5, df / (df + t*t) );
+}
@@ -0,0 +1,28 @@
+#ifndef STATS_HPP_CCD8E586_EA59_4F8F_8A60_4A8E2AF00F62
+#define STATS_HPP_CCD8E586_EA59_4F8F_8A60_4A8E2AF00F62
+
+#include <span>
+
+// Median of the samples. Returns NaN for an empty input.
+double median( std::span<double const> );
+
+/* Two-sided Mann-Whitney U test
+ *
+ * Tests whether samples in aA tend to be larger or smaller than those in aB,
+ * without assuming a particular distribution. This is the same test as used
+ * by Google Benchmark's tools/compare.py. Returns the p-value; uses the normal
+ * approximation with tie and continuity corrections, which is reasonable from
+ * around nine samples per side onwards.
+ */
+double mann_whitney_u_test( std::span<double const> aA, std::span<double const> aB );
+
+/* Two-sided Welch's t-test
+ *
+ * Tests whether two means differ, given only the per-group mean, standard
+ * deviation and sample count. Used when only aggregates are available (i.e.,
+ * the runs were made with --benchmark_report_aggregates_only). Returns the
+ * p-value.
+ */
+double welch_t_test( double aMeanA, double aStddevA, double aCountA, double aMeanB, double aStddevB, double aCountB );
+
+#endif // STATS_HPP_CCD8E586_EA59_4F8F_8A60_4A8E2AF00F62
@@ -8,6 +8,9 @@
 #include "../draw2d/draw-ex.hpp"
 #include "../draw2d/surface-ex.hpp"
 
+#include "../support/benchmark_main.hpp"
+#include "../support/perf_counters_benchmark.hpp"
+
 namespace
 {
 	void blit_masked_benchmark_( benchmark::State& aState )
@@ -25,15 +28,22 @@ namespace
 		float posX = width * 0.5f;
 		float posY = height * 0.5f;
 
+		PerfCounters perf;
+		perf.start();
+
 		for( auto _ : aState )
 		{
 			blit_masked( surface, *source, {posX, posY} );
 			benchmark::ClobberMemory(); 
 		}
 
+		perf.stop();
+
 		auto const maxBlitX = std::min( width, source->get_width() );
 		auto const maxBlitY = std::min( height, source->get_height() );
 		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(maxBlitX)*maxBlitY );
 	}
 
 	void blit_ex_solid_benchmark_( benchmark::State& aState )
@@ -50,15 +60,22 @@ namespace
 		float posX = width * 0.5f;
 		float posY = height * 0.5f;
 
+		PerfCounters perf;
+		perf.start();
+
 		for( auto _ : aState )
 		{
 			blit_ex_solid( surface, *source, {posX, posY} );
 			benchmark::ClobberMemory(); 
 		}
 
+		perf.stop();
+
 		auto const maxBlitX = std::min( width, source->get_width() );
 		auto const maxBlitY = std::min( height, source->get_height() );
 		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(maxBlitX)*maxBlitY );
 	}
 
 	void blit_ex_memcpy_benchmark_( benchmark::State& aState )
@@ -75,15 +92,22 @@ namespace
 		float posX = width * 0.5f;
 		float posY = height * 0.5f;
 
+		PerfCounters perf;
+		perf.start();
+
 		for( auto _ : aState )
 		{
 			blit_ex_memcpy( surface, *source, {posX, posY} );
 			benchmark::ClobberMemory(); 
 		}
 
+		perf.stop();
+
 		auto const maxBlitX = std::min( width, source->get_width() );
 		auto const maxBlitY = std::min( height, source->get_height() );
 		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(maxBlitX)*maxBlitY );
 	}
 }
 
@@ -109,4 +133,4 @@ BENCHMARK( blit_ex_memcpy_benchmark_ )
 	->Args( { 7680, 4320 } )
 	->Unit( benchmark::kMicrosecond );
 
-BENCHMARK_MAIN();
+COMP3811_BENCHMARK_MAIN();
@@ -0,0 +1,73 @@
+#ifndef BRESENHAM_HPP_1AE9FF9C_FCE7_4E9B_96BA_9B74B84224CB
+#define BRESENHAM_HPP_1AE9FF9C_FCE7_4E9B_96BA_9B74B84224CB
+
+#include <utility>
+
+#include <cstdint>
+
+#include "rect.hpp"
+
+#include "../vmlib/vec2.hpp"
+
+/* Bresenham lines between integer pixel coordinates
+ *
+ * These are the pixels that draw_line_solid() visits. The line is stepped
+ * along its major axis (the one in which it is longer), from the endpoint
+ * with the smaller major coordinate; step k visits the pixel at major
+ * coordinate major0+k. Ties (|dx| == |dy|) are x-major.
+ *
+ * The minor offset after k steps has a closed form (see the .inl), so a line
+ * can be started at any step without walking to it. This lets callers clip a
+ * line, or split it into pieces (e.g., by rows), in integers: the pieces
+ * visit exactly the pixels of the whole line.
+ */
+struct BresenhamLine
+{
+	int major0, minor0; // first pixel
+	int dMajor, dMinor; // both >= 0, dMinor <= dMajor
+	int minorStep; // +1 or -1
+	bool steep; // major axis is y
+};
+
+BresenhamLine bresenham_setup( int aX0, int aY0, int aX1, int aY1 ) noexcept;
+
+// Minor offset (in units of minorStep) of the pixel visited in step aStep.
+int bresenham_minor_offset( BresenhamLine const&, int aStep ) noexcept;
+
+// Range [first, last) of steps that visit pixels in rows [aRowBegin, aRowEnd).
+std::pair<int,int> bresenham_steps_in_rows( BresenhamLine const&, int aRowBegin, int aRowEnd ) noexcept;
+
+// Range [first, last) of steps that visit pixels in [aXBegin, aXEnd) x
+// [aYBegin, aYEnd).
+std::pair<int,int> bresenham_steps_in_rect( BresenhamLine const&, int aXBegin, int aYBegin, int aXEnd, int aYEnd ) noexcept;
+
+// Visit steps [aStepBegin, aStepEnd), calling aPlot( x, y ) for each pixel.
+template< typename tPlot > inline
+void bresenham_run( BresenhamLine const&, int aStepBegin, int aStepEnd, tPlot&& aPlot );
+
+
+/* Clipped lines between two points
+ *
+ * bresenham_clip() sets up the line between the pixels nearest to aBegin and
+ * aEnd, and finds the steps whose pixels lie in the clip area (pixel centers
+ * are at integer coordinates; the area includes its minimum but not its
+ * maximum edges) and on an aWidth x aHeight surface. It returns false if
+ * there are none.
+ *
+ * Clipping is exact: the steps visit precisely the pixels of the unclipped
+ * line that lie in the area. Only endpoints more than kBresenhamGuard pixels
+ * outside of the area are first moved (with clip_line()), to keep the
+ * integer arithmetic from overflowing.
+ */
+constexpr float kBresenhamGuard = float(1 << 20);
+
+struct BresenhamSpan
+{
+	BresenhamLine line;
+	int first, last; // steps
+};
+
+bool bresenham_clip( Rect2F const& aClipArea, int aWidth, int aHeight, Vec2f aBegin, Vec2f aEnd, BresenhamSpan& ) noexcept;
+
+#include "bresenham.inl"
+#endif // BRESENHAM_HPP_1AE9FF9C_FCE7_4E9B_96BA_9B74B84224CB
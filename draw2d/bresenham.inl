@@ -0,0 +1,209 @@
+#include <algorithm>
+
+#include <cmath>
+#include <cstdlib>
+
+#include "draw.hpp"
+
+/* Closed form
+ *
+ * With a = dMajor and b = dMinor, the decision variable starts at 2b - a.
+ * Each step adds 2b; each minor step (taken when it is >= 0) subtracts 2a.
+ * By induction, the minor offset after k steps is
+ *
+ *   n(k) = floor( (2bk + a) / 2a ),
+ *
+ * and the decision variable at step k is 2b(k+1) - a - 2a n(k). Both are
+ * exact in integers. With coordinates within kBresenhamGuard of the surface,
+ * 64-bit intermediates cannot overflow, and the decision variable, which
+ * stays in [-2a, 2b), fits an int.
+ */
+
+inline
+BresenhamLine bresenham_setup( int aX0, int aY0, int aX1, int aY1 ) noexcept
+{
+	BresenhamLine line;
+	line.steep = std::abs( aY1 - aY0 ) > std::abs( aX1 - aX0 );
+
+	if( line.steep )
+	{
+		std::swap( aX0, aY0 );
+		std::swap( aX1, aY1 );
+	}
+	if( aX0 > aX1 )
+	{
+		std::swap( aX0, aX1 );
+		std::swap( aY0, aY1 );
+	}
+
+	line.major0 = aX0;
+	line.minor0 = aY0;
+	line.dMajor = aX1 - aX0;
+	line.dMinor = std::abs( aY1 - aY0 );
+	line.minorStep = aY0 < aY1 ? 1 : -1;
+	return line;
+}
+
+inline
+int bresenham_minor_offset( BresenhamLine const& aLine, int aStep ) noexcept
+{
+	if( 0 == aLine.dMajor )
+		return 0;
+
+	auto const a = std::int64_t(aLine.dMajor), b = std::int64_t(aLine.dMinor);
+	return int((2*b*aStep + a) / (2*a));
+}
+
+namespace draw2d_detail
+{
+	// Steps whose major coordinate is in [aBegin, aEnd).
+	inline
+	std::pair<int,int> bresenham_steps_major_( BresenhamLine const& aLine, int aBegin, int aEnd ) noexcept
+	{
+		int const count = aLine.dMajor + 1;
+		int const first = std::clamp( aBegin - aLine.major0, 0, count );
+		int const last = std::clamp( aEnd - aLine.major0, first, count );
+		return { first, last };
+	}
+
+	// Steps whose minor coordinate is in [aBegin, aEnd). n(k) is
+	// non-decreasing: find the offsets [nLo, nHi] that fall into the range,
+	// then the first step at which n(k) reaches each of nLo and nHi+1.
+	inline
+	std::pair<int,int> bresenham_steps_minor_( BresenhamLine const& aLine, int aBegin, int aEnd ) noexcept
+	{
+		int const count = aLine.dMajor + 1;
+
+		std::int64_t nLo, nHi;
+		if( aLine.minorStep > 0 )
+		{
+			nLo = std::int64_t(aBegin) - aLine.minor0;
+			nHi = std::int64_t(aEnd) - 1 - aLine.minor0;
+		}
+		else
+		{
+			nLo = std::int64_t(aLine.minor0) - (aEnd - 1);
+			nHi = std::int64_t(aLine.minor0) - aBegin;
+		}
+
+		auto const first_reaching = [&] (std::int64_t aOffset) -> int {
+			if( aOffset <= 0 )
+				return 0;
+			if( aOffset > aLine.dMinor )
+				return count;
+
+			// n(k) >= m  <=>  2bk + a >= 2am  <=>  k >= (2am - a) / 2b
+			auto const a = std::int64_t(aLine.dMajor), b = std::int64_t(aLine.dMinor);
+			auto const num = 2*a*aOffset - a, den = 2*b;
+			return int((num + den - 1) / den);
+		};
+
+		int const first = first_reaching( nLo );
+		int const last = std::max( first, first_reaching( nHi+1 ) );
+		return { first, last };
+	}
+}
+
+inline
+std::pair<int,int> bresenham_steps_in_rows( BresenhamLine const& aLine, int aRowBegin, int aRowEnd ) noexcept
+{
+	using namespace draw2d_detail;
+	return aLine.steep
+		? bresenham_steps_major_( aLine, aRowBegin, aRowEnd )
+		: bresenham_steps_minor_( aLine, aRowBegin, aRowEnd )
+	;
+}
+
+inline
+std::pair<int,int> bresenham_steps_in_rect( BresenhamLine const& aLine, int aXBegin, int aYBegin, int aXEnd, int aYEnd ) noexcept
+{
+	using namespace draw2d_detail;
+
+	auto const [majorFirst, majorLast] = aLine.steep
+		? bresenham_steps_major_( aLine, aYBegin, aYEnd )
+		: bresenham_steps_major_( aLine, aXBegin, aXEnd )
+	;
+	auto const [minorFirst, minorLast] = aLine.steep
+		? bresenham_steps_minor_( aLine, aXBegin, aXEnd )
+		: bresenham_steps_minor_( aLine, aYBegin, aYEnd )
+	;
+
+	int const first = std::max( majorFirst, minorFirst );
+	return { first, std::max( first, std::min( majorLast, minorLast ) ) };
+}
+
+// The minor step is taken without a branch. For lines with slopes other than
+// 0 and 1, it is taken at irregular steps and would frequently be mispredicted.
+template< typename tPlot > inline
+void bresenham_run( BresenhamLine const& aLine, int aStepBegin, int aStepEnd, tPlot&& aPlot )
+{
+	if( aStepBegin >= aStepEnd )
+		return;
+
+	int const a = aLine.dMajor, b = aLine.dMinor;
+
+	int const offset = bresenham_minor_offset( aLine, aStepBegin );
+	int major = aLine.major0 + aStepBegin;
+	int minor = aLine.minor0 + aLine.minorStep * offset;
+	int p = int(2*std::int64_t(b)*(aStepBegin+1) - a - 2*std::int64_t(a)*offset);
+
+	int const majorEnd = aLine.major0 + aStepEnd;
+	if( aLine.steep )
+	{
+		for( ; major < majorEnd; ++major )
+		{
+			aPlot( minor, major );
+			int const take = -int(p >= 0); // all ones if stepping
+			minor += aLine.minorStep & take;
+			p += 2*b - (2*a & take);
+		}
+	}
+	else
+	{
+		for( ; major < majorEnd; ++major )
+		{
+			aPlot( major, minor );
+			int const take = -int(p >= 0); // all ones if stepping
+			minor += aLine.minorStep & take;
+			p += 2*b - (2*a & take);
+		}
+	}
+}
+
+inline
+bool bresenham_clip( Rect2F const& aClipArea, int aWidth, int aHeight, Vec2f aBegin, Vec2f aEnd, BresenhamSpan& aSpan ) noexcept
+{
+	// Pixels in the area: xmin <= x < xmax, i.e., ceil(xmin) <= x < ceil(xmax).
+	auto const pixel_bound = [] (float aEdge, int aSize) {
+		return int(std::clamp( std::ceil( aEdge ), 0.f, float(aSize) ));
+	};
+
+	int const xBegin = pixel_bound( aClipArea.xmin, aWidth );
+	int const xEnd = pixel_bound( aClipArea.xmin + aClipArea.width, aWidth );
+	int const yBegin = pixel_bound( aClipArea.ymin, aHeight );
+	int const yEnd = pixel_bound( aClipArea.ymin + aClipArea.height, aHeight );
+
+	if( xBegin >= xEnd || yBegin >= yEnd )
+		return false;
+
+	// Guard band. Lines within it pass the trivial accept test of clip_line()
+	// unchanged.
+	Rect2F const guard{
+		float(xBegin) - kBresenhamGuard, float(yBegin) - kBresenhamGuard,
+		float(xEnd - xBegin) + 2.f*kBresenhamGuard, float(yEnd - yBegin) + 2.f*kBresenhamGuard
+	};
+	if( !clip_line( guard, aBegin, aEnd ) )
+		return false;
+
+	// Round halfway cases up. v + 0.5 is exact in double precision.
+	auto const round = [] (float aValue) {
+		return int(std::floor( double(aValue) + 0.5 ));
+	};
+
+	aSpan.line = bresenham_setup( round( aBegin.x ), round( aBegin.y ), round( aEnd.x ), round( aEnd.y ) );
+
+	auto const [first, last] = bresenham_steps_in_rect( aSpan.line, xBegin, yBegin, xEnd, yEnd );
+	aSpan.first = first;
+	aSpan.last = last;
+	return first < last;
+}
@@ -0,0 +1,202 @@
+#include "clip-batch.hpp"
+
+#include <array>
+#include <bit>
+#include <limits>
+
+#include <cassert>
+#include <cstring>
+
+#include "draw.hpp"
+
+#include "../vmlib/simd.hpp"
+
+namespace
+{
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	/* Lane permutations for compaction
+	 *
+	 * For each 8-bit mask of visible lanes, byte k of entry [mask] holds the
+	 * index of the k-th visible lane. _mm256_permutevar8x32_ps() then moves
+	 * the visible lanes to the front, in order.
+	 */
+	constexpr std::array<std::uint64_t,256> make_compaction_table_() noexcept
+	{
+		std::array<std::uint64_t,256> table{};
+		for( unsigned mask = 0; mask < 256; ++mask )
+		{
+			std::uint64_t entry = 0;
+			unsigned out = 0;
+			for( unsigned lane = 0; lane < 8; ++lane )
+			{
+				if( mask & (1u << lane) )
+					entry |= std::uint64_t(lane) << (8 * out++);
+			}
+			table[mask] = entry;
+		}
+		return table;
+	}
+
+	constexpr auto kCompactionTable_ = make_compaction_table_();
+
+	inline
+	__m256i compaction_permutation_( unsigned aMask ) noexcept
+	{
+		return _mm256_cvtepu8_epi32( _mm_cvtsi64_si128( std::int64_t(kCompactionTable_[aMask]) ) );
+	}
+
+	// Mirrors the parameter computation of clip_line() for one axis. Lanes
+	// with a zero direction are unconstrained.
+	inline
+	void clip_axis_( __m256 aMin, __m256 aMax, __m256 aStart, __m256 aDelta, __m256& aEnter, __m256& aLeave ) noexcept
+	{
+		__m256 const zero = _mm256_setzero_ps();
+		__m256 const inf = _mm256_set1_ps( std::numeric_limits<float>::infinity() );
+
+		__m256 const moving = _mm256_cmp_ps( aDelta, zero, _CMP_NEQ_UQ );
+
+		__m256 const t0 = _mm256_div_ps( _mm256_sub_ps( aMin, aStart ), aDelta );
+		__m256 const t1 = _mm256_div_ps( _mm256_sub_ps( aMax, aStart ), aDelta );
+
+		__m256 const lo = _mm256_blendv_ps( _mm256_sub_ps( zero, inf ), _mm256_min_ps( t0, t1 ), moving );
+		__m256 const hi = _mm256_blendv_ps( inf, _mm256_max_ps( t0, t1 ), moving );
+
+		aEnter = _mm256_max_ps( aEnter, lo );
+		aLeave = _mm256_min_ps( aLeave, hi );
+	}
+#	endif // ~ AVX2
+}
+
+std::size_t clip_lines( Rect2F const& aArea, std::size_t aCount, float const* aX0, float const* aY0, float const* aX1, float const* aY1, float* aOutX0, float* aOutY0, float* aOutX1, float* aOutY1, std::uint32_t* aOutIndex ) noexcept
+{
+	assert( aCount <= std::numeric_limits<std::uint32_t>::max() );
+
+	std::size_t i = 0, n = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		__m256 const xmin = _mm256_set1_ps( aArea.xmin );
+		__m256 const xmax = _mm256_set1_ps( aArea.xmin + aArea.width );
+		__m256 const ymin = _mm256_set1_ps( aArea.ymin );
+		__m256 const ymax = _mm256_set1_ps( aArea.ymin + aArea.height );
+
+		__m256 const zero = _mm256_setzero_ps();
+		__m256 const one = _mm256_set1_ps( 1.f );
+		__m256i const lanes = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+
+		// Note: n <= i, so the full-width stores at n stay within the
+		// first i+8 <= aCount elements of the outputs.
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			__m256 const x0 = _mm256_loadu_ps( aX0+i ), y0 = _mm256_loadu_ps( aY0+i );
+			__m256 const x1 = _mm256_loadu_ps( aX1+i ), y1 = _mm256_loadu_ps( aY1+i );
+
+			// Outcode bits, as in clip_line(): set if !(inside), so that NaNs
+			// are outside.
+			__m256 const left0 = _mm256_cmp_ps( x0, xmin, _CMP_NGE_UQ );
+			__m256 const right0 = _mm256_cmp_ps( x0, xmax, _CMP_NLT_UQ );
+			__m256 const top0 = _mm256_cmp_ps( y0, ymin, _CMP_NGE_UQ );
+			__m256 const bottom0 = _mm256_cmp_ps( y0, ymax, _CMP_NLT_UQ );
+
+			__m256 const left1 = _mm256_cmp_ps( x1, xmin, _CMP_NGE_UQ );
+			__m256 const right1 = _mm256_cmp_ps( x1, xmax, _CMP_NLT_UQ );
+			__m256 const top1 = _mm256_cmp_ps( y1, ymin, _CMP_NGE_UQ );
+			__m256 const bottom1 = _mm256_cmp_ps( y1, ymax, _CMP_NLT_UQ );
+
+			__m256 const outside = _mm256_or_ps(
+				_mm256_or_ps( _mm256_or_ps( left0, right0 ), _mm256_or_ps( top0, bottom0 ) ),
+				_mm256_or_ps( _mm256_or_ps( left1, right1 ), _mm256_or_ps( top1, bottom1 ) )
+			);
+			__m256 const rejected = _mm256_or_ps(
+				_mm256_or_ps( _mm256_and_ps( left0, left1 ), _mm256_and_ps( right0, right1 ) ),
+				_mm256_or_ps( _mm256_and_ps( top0, top1 ), _mm256_and_ps( bottom0, bottom1 ) )
+			);
+
+			unsigned const outsideMask = unsigned(_mm256_movemask_ps( outside ));
+			unsigned const rejectedMask = unsigned(_mm256_movemask_ps( rejected ));
+
+			__m256i const index = _mm256_add_epi32( _mm256_set1_epi32( int(i) ), lanes );
+
+			if( 0 == outsideMask )
+			{
+				// All inside: copy.
+				_mm256_storeu_ps( aOutX0+n, x0 ); _mm256_storeu_ps( aOutY0+n, y0 );
+				_mm256_storeu_ps( aOutX1+n, x1 ); _mm256_storeu_ps( aOutY1+n, y1 );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>(aOutIndex+n), index );
+				n += 8;
+				continue;
+			}
+
+			if( 0xff == rejectedMask )
+				continue; // All outside.
+
+			// Liang-Barsky on all lanes.
+			__m256 const dx = _mm256_sub_ps( x1, x0 );
+			__m256 const dy = _mm256_sub_ps( y1, y0 );
+
+			__m256 enter = zero, leave = one;
+			clip_axis_( xmin, xmax, x0, dx, enter, leave );
+			clip_axis_( ymin, ymax, y0, dy, enter, leave );
+
+			__m256 const clipped = _mm256_and_ps(
+				_mm256_cmp_ps( enter, leave, _CMP_LE_OQ ),
+				_mm256_andnot_ps( rejected, outside )
+			);
+			unsigned const visible = (~outsideMask & 0xffu) | unsigned(_mm256_movemask_ps( clipped ));
+
+			// Endpoints are only replaced where the line was actually cut,
+			// i.e., never for lanes that were inside.
+			__m256 const cutBegin = _mm256_and_ps( outside, _mm256_cmp_ps( enter, zero, _CMP_GT_OQ ) );
+			__m256 const cutEnd = _mm256_and_ps( outside, _mm256_cmp_ps( leave, one, _CMP_LT_OQ ) );
+
+			__m256 const cx0 = _mm256_blendv_ps( x0, _mm256_add_ps( x0, _mm256_mul_ps( enter, dx ) ), cutBegin );
+			__m256 const cy0 = _mm256_blendv_ps( y0, _mm256_add_ps( y0, _mm256_mul_ps( enter, dy ) ), cutBegin );
+			__m256 const cx1 = _mm256_blendv_ps( x1, _mm256_add_ps( x0, _mm256_mul_ps( leave, dx ) ), cutEnd );
+			__m256 const cy1 = _mm256_blendv_ps( y1, _mm256_add_ps( y0, _mm256_mul_ps( leave, dy ) ), cutEnd );
+
+			// Compact.
+			__m256i const perm = compaction_permutation_( visible );
+			_mm256_storeu_ps( aOutX0+n, _mm256_permutevar8x32_ps( cx0, perm ) );
+			_mm256_storeu_ps( aOutY0+n, _mm256_permutevar8x32_ps( cy0, perm ) );
+			_mm256_storeu_ps( aOutX1+n, _mm256_permutevar8x32_ps( cx1, perm ) );
+			_mm256_storeu_ps( aOutY1+n, _mm256_permutevar8x32_ps( cy1, perm ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(aOutIndex+n), _mm256_permutevar8x32_epi32( index, perm ) );
+
+			n += std::popcount( visible );
+		}
+	}
+#	endif // ~ AVX2
+
+	for( ; i < aCount; ++i )
+	{
+		Vec2f begin{ aX0[i], aY0[i] }, end{ aX1[i], aY1[i] };
+		if( !clip_line( aArea, begin, end ) )
+			continue;
+
+		aOutX0[n] = begin.x; aOutY0[n] = begin.y;
+		aOutX1[n] = end.x; aOutY1[n] = end.y;
+		aOutIndex[n] = std::uint32_t(i);
+		++n;
+	}
+
+	return n;
+}
+
+void clip_lines( Rect2F const& aArea, LineBatch const& aBatch, ClippedLines& aOut )
+{
+	auto const count = aBatch.size();
+
+	aOut.x0.resize( count ); aOut.y0.resize( count );
+	aOut.x1.resize( count ); aOut.y1.resize( count );
+	aOut.index.resize( count );
+
+	auto const visible = clip_lines( aArea, count,
+		aBatch.x0.data(), aBatch.y0.data(), aBatch.x1.data(), aBatch.y1.data(),
+		aOut.x0.data(), aOut.y0.data(), aOut.x1.data(), aOut.y1.data(),
+		aOut.index.data()
+	);
+
+	aOut.x0.resize( visible ); aOut.y0.resize( visible );
+	aOut.x1.resize( visible ); aOut.y1.resize( visible );
+	aOut.index.resize( visible );
+}
@@ -0,0 +1,49 @@
+#ifndef CLIP_BATCH_HPP_1AC1C8A9_16F1_40F0_BFD0_9EFF12CFED51
+#define CLIP_BATCH_HPP_1AC1C8A9_16F1_40F0_BFD0_9EFF12CFED51
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rect.hpp"
+#include "draw-batch.hpp"
+
+/** ClippedLines : visible parts of the segments of a LineBatch
+ *
+ * Segment i is the visible part of segment index[i] of the input. Segments
+ * keep their relative order.
+ */
+struct ClippedLines
+{
+	std::vector<float> x0, y0, x1, y1;
+	std::vector<std::uint32_t> index;
+
+	std::size_t size() const noexcept { return x0.size(); }
+	bool empty() const noexcept { return x0.empty(); }
+};
+
+/* Clip many segments at once
+ *
+ * Each segment is clipped exactly like clip_line() clips it, with the same
+ * results (for finite coordinates). Visible segments are written to the outputs, compacted, and
+ * their number is returned. Each output array must have room for aCount
+ * elements.
+ *
+ * With AVX2, eight segments are processed per iteration. Outcodes are
+ * computed first; if all eight segments are inside, they are copied, and if
+ * all are outside of one of the edges, they are skipped, without any
+ * divisions. Otherwise all eight are clipped (Liang-Barsky) without branches.
+ * The remaining segments, and all segments without AVX2, use clip_line().
+ */
+std::size_t clip_lines(
+	Rect2F const&,
+	std::size_t aCount,
+	float const* aX0, float const* aY0, float const* aX1, float const* aY1,
+	float* aOutX0, float* aOutY0, float* aOutX1, float* aOutY1,
+	std::uint32_t* aOutIndex
+) noexcept;
+
+void clip_lines( Rect2F const&, LineBatch const&, ClippedLines& );
+
+#endif // CLIP_BATCH_HPP_1AC1C8A9_16F1_40F0_BFD0_9EFF12CFED51
@@ -0,0 +1,31 @@
+#include "color-lut.hpp"
+
+#include <array>
+
+#include <cmath>
+
+#include "color.hpp"
+
+std::uint8_t const* linear_to_srgb_lut() noexcept
+{
+	static std::array<std::uint8_t, kLinearToSrgbLutSize> const lut = [] {
+		std::array<std::uint8_t, kLinearToSrgbLutSize> ret{};
+		for( std::uint32_t i = 0; i < kLinearToSrgbLutSize; ++i )
+			ret[i] = linear_to_srgb( float(i) / float(kLinearToSrgbLutSize-1) );
+		return ret;
+	}();
+
+	return lut.data();
+}
+
+std::uint16_t const* srgb_to_linear_lut() noexcept
+{
+	static std::array<std::uint16_t, 256> const lut = [] {
+		std::array<std::uint16_t, 256> ret{};
+		for( std::uint32_t i = 0; i < 256; ++i )
+			ret[i] = std::uint16_t(std::lround( linear_from_srgb( std::uint8_t(i) ) * float(kLinearToSrgbLutSize-1) ));
+		return ret;
+	}();
+
+	return lut.data();
+}
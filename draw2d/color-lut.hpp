@@ -0,0 +1,32 @@
+#ifndef COLOR_LUT_HPP_EAE53F4E_7F2F_4CE4_A9C6_3CC1BDFF5FF5
+#define COLOR_LUT_HPP_EAE53F4E_7F2F_4CE4_A9C6_3CC1BDFF5FF5
+
+#include <cstdint>
+
+/* Lookup table for linear_to_srgb()
+ *
+ * Entry i holds linear_to_srgb( i / (kLinearToSrgbLutSize-1) ), using the
+ * configured DRAW2D_CFG_SRGB_MODE. Indexing with a linear value quantized to
+ * 12 bits stays within 1 LSB of linear_to_srgb(): the steepest part of the
+ * sRGB curve is the linear segment near zero, where one step of 1/4095 maps
+ * to 255 * 12.92 / 4095 = 0.8 LSB.
+ *
+ * The table is built on first use.
+ */
+constexpr std::uint32_t kLinearToSrgbLutBits = 12;
+constexpr std::uint32_t kLinearToSrgbLutSize = 1u << kLinearToSrgbLutBits;
+
+std::uint8_t const* linear_to_srgb_lut() noexcept;
+
+/* Lookup table for linear_from_srgb()
+ *
+ * Entry v holds linear_from_srgb( v ), quantized to the 12-bit linear scale
+ * of linear_to_srgb_lut() (i.e., scaled by kLinearToSrgbLutSize-1 and
+ * rounded). Decoding with this table and encoding with linear_to_srgb_lut()
+ * returns the original 8-bit value.
+ *
+ * The table is built on first use.
+ */
+std::uint16_t const* srgb_to_linear_lut() noexcept;
+
+#endif // COLOR_LUT_HPP_EAE53F4E_7F2F_4CE4_A9C6_3CC1BDFF5FF5
@@ -0,0 +1,345 @@
+#include "draw-aa.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "draw.hpp"
+#include "surface.hpp"
+#include "color-lut.hpp"
+
+namespace
+{
+	ELineStyle gLineStripStyle_ = ELineStyle::aliased;
+
+	// Fractional bits of the minor coordinate in the inner loop.
+	constexpr int kFracBits_ = 16;
+
+	// Coverage is quantized to kCoverageLevels_+1 levels, 0 (none) to
+	// kCoverageLevels_ (full). Like in Wu's original formulation, a handful
+	// of levels is plenty.
+	constexpr int kCoverageBits_ = 4;
+	constexpr std::int32_t kCoverageLevels_ = 1 << kCoverageBits_;
+
+	// Table rows for one coverage level: [channel][dst], see BlendTable_. The
+	// fourth row is padding, so that a level's rows are 1 KiB apart.
+	using BlendRows_ = std::uint8_t[4][256];
+
+	/* Blend table for one line color
+	 *
+	 * Row [c][dst] for a coverage level holds the result of blending the line
+	 * color over the 8-bit sRGB value dst in channel c, in linear space:
+	 * srgb( lin(dst) + (lin(color) - lin(dst)) * level/kCoverageLevels_ ),
+	 * computed with srgb_to_linear_lut() and linear_to_srgb_lut(). With it,
+	 * blending a pixel takes a single lookup per channel.
+	 *
+	 * The two pixels of a column have levels kCoverageLevels_-l and l. The
+	 * rows are stored in these pairs, pairs[l][0] and pairs[l][1], so that
+	 * the inner loop finds both from a single offset. Level kCoverageLevels_
+	 * is pairs[0][0].
+	 *
+	 * Building the table takes about as long as drawing several thousand
+	 * pixels, so the table of the most recently used color is kept (per
+	 * thread). Lines are usually drawn in batches of one color, e.g. by
+	 * LineStrip::draw().
+	 */
+	struct BlendTable_
+	{
+		bool valid = false;
+		ColorU8_sRGB color;
+		BlendRows_ pairs[kCoverageLevels_][2];
+	};
+
+	BlendTable_ const& blend_table_( ColorU8_sRGB aColor ) noexcept
+	{
+		thread_local BlendTable_ table;
+
+		if( table.valid && table.color.r == aColor.r && table.color.g == aColor.g && table.color.b == aColor.b )
+			return table;
+
+		std::uint16_t const* decode = srgb_to_linear_lut();
+		std::uint8_t const* encode = linear_to_srgb_lut();
+
+		std::int32_t const color[3] = { decode[aColor.r], decode[aColor.g], decode[aColor.b] };
+
+		for( std::int32_t level = 0; level < kCoverageLevels_; ++level )
+		{
+			for( int half = 0; half < 2; ++half )
+			{
+				std::int32_t const coverage = half ? level : kCoverageLevels_ - level;
+				for( int c = 0; c < 3; ++c )
+				{
+					// The (arithmetic) shift rounds towards dst, so the result
+					// always stays between dst and the line color.
+					for( std::int32_t dst = 0; dst < 256; ++dst )
+					{
+						std::int32_t const lin = decode[dst];
+						table.pairs[level][half][c][dst] = encode[lin + (((color[c] - lin) * coverage) >> kCoverageBits_)];
+					}
+				}
+			}
+		}
+
+		table.valid = true;
+		table.color = aColor;
+		return table;
+	}
+
+	// The line is drawn along its major axis (the one in which it is longer).
+	// Pixels are addressed as (major, minor); the strides map this to x or y.
+	struct WuTarget_
+	{
+		std::uint8_t* pixels;
+		std::ptrdiff_t majorStride, minorStride; // bytes
+		std::uint32_t majorSize, minorSize; // pixels
+
+		BlendRows_ const (*blend)[2]; // BlendTable_::pairs
+	};
+
+	// Table rows for coverage level aLevel, 0..kCoverageLevels_.
+	inline
+	BlendRows_ const& blend_rows_( WuTarget_ const& aTarget, std::int32_t aLevel ) noexcept
+	{
+		return kCoverageLevels_ == aLevel ? aTarget.blend[0][0] : aTarget.blend[aLevel][1];
+	}
+
+	/* Blend the pixel with the line color, using the table rows aLut of one
+	 * coverage level (see BlendTable_).
+	 *
+	 * The pixel is read as a single 32-bit word, but written one channel
+	 * at a time; the padding byte is not touched. The inner loop is limited
+	 * by loads: this takes four per pixel, byte reads would take six. Putting
+	 * the channels back together for a single store costs more than the two
+	 * stores it saves.
+	 */
+	inline
+	void blend_pixel_( std::uint8_t* aPixel, BlendRows_ const& aLut ) noexcept
+	{
+		static_assert( std::endian::native == std::endian::little );
+
+		std::uint32_t pixel;
+		std::memcpy( &pixel, aPixel, sizeof(pixel) );
+		aPixel[0] = aLut[0][pixel & 0xff];
+		aPixel[1] = aLut[1][(pixel >> 8) & 0xff];
+		aPixel[2] = aLut[2][(pixel >> 16) & 0xff];
+	}
+
+	// As blend_pixel_(), but skips pixels outside of the surface.
+	inline
+	void blend_( WuTarget_ const& aTarget, int aMajor, int aMinor, std::int32_t aLevel ) noexcept
+	{
+		if( std::uint32_t(aMajor) >= aTarget.majorSize || std::uint32_t(aMinor) >= aTarget.minorSize )
+			return;
+
+		blend_pixel_( aTarget.pixels + aMajor * aTarget.majorStride + aMinor * aTarget.minorStride, blend_rows_( aTarget, aLevel ) );
+	}
+
+	inline
+	std::int32_t coverage_( float aValue ) noexcept
+	{
+		return std::int32_t(std::lround( aValue * float(kCoverageLevels_) ));
+	}
+
+	constexpr std::int32_t kHalfLevel_ = 1 << (kFracBits_-kCoverageBits_-1);
+
+	/* Draw the two pixels of one column (one step along the major axis).
+	 *
+	 * aMinor is the 16.16 minor coordinate, offset by kHalfLevel_. A fraction
+	 * that rounds up to a full level thus moves the line to the next row.
+	 */
+	inline
+	void wu_column_( WuTarget_ const& aTarget, int aMajor, std::int32_t aMinor ) noexcept
+	{
+		int const row = aMinor >> kFracBits_;
+		std::int32_t const level = (aMinor >> (kFracBits_-kCoverageBits_)) & (kCoverageLevels_-1);
+
+		blend_( aTarget, aMajor, row, kCoverageLevels_ - level );
+		blend_( aTarget, aMajor, row+1, level );
+	}
+
+	/* Draw aCount columns, starting at aMajor, as wu_column_() would. The two
+	 * pixels of each column must be inside the surface.
+	 *
+	 * This is the inner loop for all but a few columns of a line. It walks a
+	 * pointer along the major axis, and finds the table rows of both pixels
+	 * from a single offset (BlendTable_::pairs).
+	 */
+	void wu_span_( WuTarget_ const aTarget, int aMajor, int aCount, std::int64_t aMinor, std::int64_t aStep ) noexcept
+	{
+		std::uint8_t* column = aTarget.pixels + aMajor * aTarget.majorStride;
+		std::uint8_t* const end = column + aCount * aTarget.majorStride;
+		for( ; column < end; aMinor += aStep, column += aTarget.majorStride )
+		{
+			auto const level = (aMinor >> (kFracBits_-kCoverageBits_)) & (kCoverageLevels_-1);
+			std::uint8_t* const pixel = column + (aMinor >> kFracBits_) * aTarget.minorStride;
+
+			auto const& pair = aTarget.blend[level];
+			blend_pixel_( pixel, pair[0] );
+			blend_pixel_( pixel + aTarget.minorStride, pair[1] );
+		}
+	}
+
+	// Integer division, rounding down/up. aB must be positive.
+	inline
+	std::int64_t floor_div_( std::int64_t aA, std::int64_t aB ) noexcept
+	{
+		std::int64_t const q = aA / aB;
+		return (aA % aB != 0 && aA < 0) ? q-1 : q;
+	}
+	inline
+	std::int64_t ceil_div_( std::int64_t aA, std::int64_t aB ) noexcept
+	{
+		return -floor_div_( -aA, aB );
+	}
+
+	/* Find the steps k in [0, aCount) for which both pixels of the column
+	 * aMajor0+k are inside the surface, i.e., where wu_span_() may be used.
+	 * The minor coordinate is linear in k, so these form a single range
+	 * [begin, end) (which may be empty). Usually, this is all of them, except
+	 * for a few at the ends of lines that were clipped.
+	 */
+	std::pair<int,int> safe_columns_( WuTarget_ const& aTarget, int aMajor0, int aCount, std::int32_t aMinor0, std::int32_t aStep ) noexcept
+	{
+		std::int64_t lo = std::max( 0, -aMajor0 );
+		std::int64_t hi = std::min( std::int64_t(aCount), std::int64_t(aTarget.majorSize) - aMajor0 ) - 1;
+
+		// 0 <= aMinor0 + aStep*k <= limit
+		std::int64_t const limit = (std::int64_t(aTarget.minorSize-1) << kFracBits_) - 1;
+		if( aStep > 0 )
+		{
+			lo = std::max( lo, ceil_div_( -aMinor0, aStep ) );
+			hi = std::min( hi, floor_div_( limit - aMinor0, aStep ) );
+		}
+		else if( aStep < 0 )
+		{
+			lo = std::max( lo, ceil_div_( aMinor0 - limit, -aStep ) );
+			hi = std::min( hi, floor_div_( aMinor0, -aStep ) );
+		}
+		else if( aMinor0 < 0 || aMinor0 > limit )
+		{
+			hi = -1;
+		}
+
+		if( lo > hi )
+			return { 0, 0 };
+
+		return { int(lo), int(hi+1) };
+	}
+
+	// aTarget is passed by value: the pixels are written through byte
+	// pointers, which the compiler must otherwise assume to alias it.
+	void draw_wu_( WuTarget_ const aTarget, float aMajor0, float aMinor0, float aMajor1, float aMinor1 ) noexcept
+	{
+		if( aMajor0 > aMajor1 )
+		{
+			std::swap( aMajor0, aMajor1 );
+			std::swap( aMinor0, aMinor1 );
+		}
+
+		float const length = aMajor1 - aMajor0;
+		float const gradient = length > 0.f ? (aMinor1 - aMinor0) / length : 0.f;
+
+		// Endpoints. Each covers the pixel it falls into in proportion to how
+		// much of that pixel's extent along the major axis the line spans.
+		int first, last;
+		float minorFirst;
+		{
+			float const major = std::round( aMajor0 );
+			float const minor = aMinor0 + gradient * (major - aMajor0);
+			float const gap = major + 0.5f - aMajor0;
+
+			float const row = std::floor( minor );
+			float const frac = minor - row;
+
+			first = int(major);
+			blend_( aTarget, first, int(row), coverage_( (1.f - frac) * gap ) );
+			blend_( aTarget, first, int(row)+1, coverage_( frac * gap ) );
+
+			minorFirst = minor + gradient;
+		}
+		{
+			float const major = std::round( aMajor1 );
+			float const minor = aMinor1 + gradient * (major - aMajor1);
+			float const gap = aMajor1 + 0.5f - major;
+
+			float const row = std::floor( minor );
+			float const frac = minor - row;
+
+			last = int(major);
+			blend_( aTarget, last, int(row), coverage_( (1.f - frac) * gap ) );
+			blend_( aTarget, last, int(row)+1, coverage_( frac * gap ) );
+		}
+
+		// Interior: integer only. The minor coordinate is offset by half a
+		// coverage level, so that truncating it rounds to the nearest level.
+		constexpr float scale = float(1 << kFracBits_);
+		auto minor = std::int32_t(std::lround( minorFirst * scale )) + kHalfLevel_;
+		auto const step = std::int32_t(std::lround( gradient * scale ));
+
+		int const count = last - first - 1;
+		auto const [safeBegin, safeEnd] = safe_columns_( aTarget, first+1, count, minor, step );
+
+		for( int k = 0; k < safeBegin; ++k )
+			wu_column_( aTarget, first+1+k, minor + k*step );
+
+		wu_span_( aTarget, first+1+safeBegin, safeEnd-safeBegin, minor + std::int64_t(safeBegin)*step, step );
+
+		for( int k = std::max( safeBegin, safeEnd ); k < count; ++k )
+			wu_column_( aTarget, first+1+k, minor + k*step );
+	}
+}
+
+void draw_line_aa( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+{
+	draw_line_aa( aSurface, aSurface.clip_area(), aBegin, aEnd, aColor );
+}
+void draw_line_aa( Surface& aSurface, Rect2F const& aClipArea, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+{
+	// The two pixels next to the line may lie one pixel outside the area.
+	Rect2F const area{ aClipArea.xmin - 1.f, aClipArea.ymin - 1.f, aClipArea.width + 2.f, aClipArea.height + 2.f };
+	if( !clip_line( area, aBegin, aEnd ) )
+		return;
+
+	auto const width = aSurface.get_width(), height = aSurface.get_height();
+	auto const pitch = std::ptrdiff_t(width) * 4;
+
+	BlendTable_ const& table = blend_table_( aColor );
+
+	WuTarget_ target;
+	target.pixels = const_cast<std::uint8_t*>(aSurface.get_surface_ptr());
+	target.blend = table.pairs;
+
+	if( std::abs( aEnd.x - aBegin.x ) >= std::abs( aEnd.y - aBegin.y ) )
+	{
+		target.majorStride = 4;
+		target.minorStride = pitch;
+		target.majorSize = width;
+		target.minorSize = height;
+
+		draw_wu_( target, aBegin.x, aBegin.y, aEnd.x, aEnd.y );
+	}
+	else
+	{
+		target.majorStride = pitch;
+		target.minorStride = 4;
+		target.majorSize = height;
+		target.minorSize = width;
+
+		draw_wu_( target, aBegin.y, aBegin.x, aEnd.y, aEnd.x );
+	}
+}
+
+
+void set_line_strip_style( ELineStyle aStyle ) noexcept
+{
+	gLineStripStyle_ = aStyle;
+}
+ELineStyle line_strip_style() noexcept
+{
+	return gLineStripStyle_;
+}
@@ -0,0 +1,55 @@
+#ifndef DRAW_AA_HPP_61F3EAB6_D4B0_4014_AA8E_CC3C45F07E9A
+#define DRAW_AA_HPP_61F3EAB6_D4B0_4014_AA8E_CC3C45F07E9A
+
+#include "forward.hpp"
+
+#include "rect.hpp"
+#include "color.hpp"
+
+#include "../vmlib/vec2.hpp"
+
+/* Anti-aliased lines (Xiaolin Wu)
+ *
+ * Draws a 1 pixel wide line that covers the two pixels closest to it in the
+ * minor direction, each in proportion to its distance from the line. Pixel
+ * centers are at integer coordinates, as with draw_line_solid(), so both
+ * draw the same line.
+ *
+ * Coverage is quantized to 16 levels and blended with the existing pixel in
+ * linear space: the surface and line colors are decoded with
+ * srgb_to_linear_lut(), mixed in 12-bit integers and encoded again with
+ * linear_to_srgb_lut() (see color-lut.hpp). The results for each level and
+ * 8-bit surface value are precomputed once per line color, so the inner loop
+ * does a single lookup per channel. It is integer only; the line is stepped
+ * in 16.16 fixed point.
+ *
+ * The line is clipped to the surface (or to the given area), extended by one
+ * pixel on each side so that partially covered pixels on the border are kept.
+ */
+void draw_line_aa(
+	Surface&,
+	Vec2f aBegin, Vec2f aEnd,
+	ColorU8_sRGB
+);
+void draw_line_aa(
+	Surface&,
+	Rect2F const&,
+	Vec2f aBegin, Vec2f aEnd,
+	ColorU8_sRGB
+);
+
+/* Line style used by LineStrip::draw()
+ *
+ * LineStrip's interface is fixed, so the style is a (global) setting instead
+ * of a parameter. The default is ELineStyle::aliased, i.e., draw_line_solid().
+ */
+enum class ELineStyle
+{
+	aliased,
+	antialiased
+};
+
+void set_line_strip_style( ELineStyle ) noexcept;
+ELineStyle line_strip_style() noexcept;
+
+#endif // DRAW_AA_HPP_61F3EAB6_D4B0_4014_AA8E_CC3C45F07E9A
@@ -0,0 +1,166 @@
+#include "draw-batch.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include <cassert>
+#include <cstdint>
+
+#include "draw.hpp"
+#include "surface.hpp"
+#include "bresenham.hpp"
+#include "clip-batch.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+	// Handing work to another thread costs about as much as drawing a few
+	// thousand pixels. Give each thread at least this many segments.
+	constexpr std::size_t kMinSegmentsPerThread_ = 1024;
+
+	// More bands than threads balances the load when the segments are
+	// concentrated in a part of the surface. Bands are at least a few rows
+	// high, as each band revisits the segments that cross it.
+	constexpr unsigned kBandsPerThread_ = 4;
+	constexpr int kMinBandRows_ = 16;
+
+	struct RasterLine_
+	{
+		BresenhamLine line;
+		int first, last; // visible steps
+		int rowMin, rowMax; // of the visible steps, inclusive
+		ColorU8_sRGB color;
+	};
+
+	void clip_segments_( Surface const& aSurface, LineBatch const& aBatch, std::vector<RasterLine_>& aOut )
+	{
+		// Cull with the vectorized clipper first. Drawn pixels lie within
+		// one pixel (in x and y) of the segment, so segments that miss the
+		// area grown by two pixels cannot draw anything. The clipped
+		// endpoints are not used: bresenham_clip() clips exactly.
+		Rect2F const area = aSurface.clip_area();
+		Rect2F const cull{ area.xmin - 2.f, area.ymin - 2.f, area.width + 4.f, area.height + 4.f };
+
+		thread_local ClippedLines visible;
+		clip_lines( cull, aBatch, visible );
+
+		int const width = int(aSurface.get_width()), height = int(aSurface.get_height());
+
+		aOut.clear();
+		aOut.reserve( visible.size() );
+
+		for( auto const index : visible.index )
+		{
+			Vec2f const begin{ aBatch.x0[index], aBatch.y0[index] };
+			Vec2f const end{ aBatch.x1[index], aBatch.y1[index] };
+
+			BresenhamSpan span;
+			if( !bresenham_clip( area, width, height, begin, end, span ) )
+				continue;
+
+			RasterLine_ raster;
+			raster.line = span.line;
+			raster.first = span.first;
+			raster.last = span.last;
+			raster.color = aBatch.color[index];
+
+			// Rows of the first and last visible pixels
+			BresenhamLine const& line = raster.line;
+			int const row0 = line.steep ? line.major0 + span.first : line.minor0 + line.minorStep * bresenham_minor_offset( line, span.first );
+			int const row1 = line.steep ? line.major0 + span.last-1 : line.minor0 + line.minorStep * bresenham_minor_offset( line, span.last-1 );
+			raster.rowMin = std::min( row0, row1 );
+			raster.rowMax = std::max( row0, row1 );
+
+			aOut.emplace_back( raster );
+		}
+	}
+
+	// Pixels are written through byte pointers, which may alias anything.
+	// Keeping the color and surface in locals (whose address is not taken)
+	// avoids reloading them for every pixel.
+	inline
+	void draw_steps_( std::uint8_t* aPixels, std::size_t aWidth, RasterLine_ const& aRaster, int aFirst, int aLast )
+	{
+		ColorU8_sRGB const color = aRaster.color;
+		bresenham_run( aRaster.line, aFirst, aLast, [=] (int aX, int aY) {
+			std::uint8_t* const pixel = aPixels + 4 * (std::size_t(aY) * aWidth + std::size_t(aX));
+			pixel[0] = color.r;
+			pixel[1] = color.g;
+			pixel[2] = color.b;
+		} );
+	}
+}
+
+void draw_lines_batch( Surface& aSurface, LineBatch const& aBatch, unsigned aThreadCount )
+{
+	assert( aBatch.y0.size() == aBatch.size() && aBatch.x1.size() == aBatch.size() );
+	assert( aBatch.y1.size() == aBatch.size() && aBatch.color.size() == aBatch.size() );
+
+	// Reused between calls. The bands, which may run on other threads, access
+	// it through the reference; naming the thread_local there would refer to
+	// those threads' own instances.
+	thread_local std::vector<RasterLine_> clipped;
+	auto& lines = clipped;
+	clip_segments_( aSurface, aBatch, lines );
+
+	if( 0 == aThreadCount )
+		aThreadCount = executor_concurrency();
+
+	auto const useful = std::max( std::size_t(1), lines.size() / kMinSegmentsPerThread_ );
+	auto const threads = unsigned(std::min( std::size_t(aThreadCount), useful ));
+
+	auto* const pixels = const_cast<std::uint8_t*>(aSurface.get_surface_ptr());
+	std::size_t const width = aSurface.get_width();
+	int const height = int(aSurface.get_height());
+
+	if( 1 == threads )
+	{
+		for( auto const& raster : lines )
+			draw_steps_( pixels, width, raster, raster.first, raster.last );
+		return;
+	}
+
+	// Bin segments by band. Bins keep the segments' order.
+	int const bandRows = std::max( kMinBandRows_, int((height + threads*kBandsPerThread_ - 1) / (threads*kBandsPerThread_)) );
+	int const bandCount = (height + bandRows - 1) / bandRows;
+
+	// All bins share one array, sorted by band (counting sort): bin b is
+	// binned[binStart[b]] ... binned[binStart[b+1]-1]. Both arrays are
+	// reused between calls, like the clipped segments.
+	thread_local std::vector<std::uint32_t> binnedStorage, binStartStorage;
+	auto& binned = binnedStorage;
+	auto& binStart = binStartStorage;
+
+	// Count each band's segments into binStart[band+2]. The prefix sum then
+	// leaves the start of band b in binStart[b+1], which serves as its fill
+	// cursor; after filling, it has advanced to the start of band b+1.
+	binStart.assign( std::size_t(bandCount) + 2, 0 );
+	for( auto const& raster : lines )
+	{
+		for( int band = raster.rowMin / bandRows; band <= raster.rowMax / bandRows; ++band )
+			++binStart[band+2];
+	}
+
+	for( int band = 0; band < bandCount; ++band )
+		binStart[band+2] += binStart[band+1];
+
+	binned.resize( binStart[bandCount+1] );
+	for( std::size_t i = 0; i < lines.size(); ++i )
+	{
+		for( int band = lines[i].rowMin / bandRows; band <= lines[i].rowMax / bandRows; ++band )
+			binned[binStart[band+1]++] = std::uint32_t(i);
+	}
+
+	parallel_for( 0, bandCount, 1, [&] (int aBand, int) {
+		int const rowBegin = aBand * bandRows;
+		int const rowEnd = std::min( height, rowBegin + bandRows );
+
+		for( auto k = binStart[aBand]; k < binStart[aBand+1]; ++k )
+		{
+			auto const index = binned[k];
+			RasterLine_ const& raster = lines[index];
+			auto const [first, last] = bresenham_steps_in_rows( raster.line, rowBegin, rowEnd );
+			draw_steps_( pixels, width, raster, std::max( first, raster.first ), std::min( last, raster.last ) );
+		}
+	} );
+}
@@ -0,0 +1,65 @@
+#ifndef DRAW_BATCH_HPP_3667CA11_4CE1_4AAA_839D_16EBE6AC2926
+#define DRAW_BATCH_HPP_3667CA11_4CE1_4AAA_839D_16EBE6AC2926
+
+#include <vector>
+
+#include <cstddef>
+
+#include "forward.hpp"
+#include "color.hpp"
+
+#include "../vmlib/vec2.hpp"
+
+/** LineBatch : many line segments, stored as structure-of-arrays (SoA)
+ *
+ * Segment i runs from (x0[i], y0[i]) to (x1[i], y1[i]). See Vec2fBatch.
+ */
+struct LineBatch
+{
+	std::vector<float> x0, y0, x1, y1;
+	std::vector<ColorU8_sRGB> color;
+
+	std::size_t size() const noexcept { return x0.size(); }
+	bool empty() const noexcept { return x0.empty(); }
+
+	void reserve( std::size_t aCount )
+	{
+		x0.reserve( aCount ); y0.reserve( aCount );
+		x1.reserve( aCount ); y1.reserve( aCount );
+		color.reserve( aCount );
+	}
+	void clear() noexcept
+	{
+		x0.clear(); y0.clear();
+		x1.clear(); y1.clear();
+		color.clear();
+	}
+
+	void push_back( Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+	{
+		x0.push_back( aBegin.x ); y0.push_back( aBegin.y );
+		x1.push_back( aEnd.x ); y1.push_back( aEnd.y );
+		color.push_back( aColor );
+	}
+};
+
+/* Draw many 1 px lines, using several threads
+ *
+ * The result is identical to calling draw_line_solid() for each segment, in
+ * order. Segments that cannot touch the surface are culled in one pass up
+ * front, with clip_lines() (see clip-batch.hpp). The surface is then cut into
+ * horizontal bands, which are handed to the current executor (see
+ * parallel.hpp). Each band draws the parts of the segments that fall into it,
+ * in their original order. Segments that cross band edges are split there;
+ * as the pieces continue the Bresenham line of the whole segment (see
+ * bresenham.hpp), they visit the same pixels. Bands thus write disjoint rows
+ * without locking.
+ *
+ * aThreadCount is the number of threads to split the work for; 0 uses the
+ * executor's concurrency. Small batches are split for fewer threads, and are
+ * drawn on the calling thread alone if splitting would not pay off. Without
+ * an executor, the bands are drawn one after another.
+ */
+void draw_lines_batch( Surface&, LineBatch const&, unsigned aThreadCount = 0 );
+
+#endif // DRAW_BATCH_HPP_3667CA11_4CE1_4AAA_839D_16EBE6AC2926
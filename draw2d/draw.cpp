@@ -4,279 +4,849 @@
 #include <algorithm>
 #include <cmath>
 
-bool clip_line( Rect2F const& aTargetArea, Vec2f& aBegin, Vec2f& aEnd )
+#include <array>
+#include <bit>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "../vmlib/simd.hpp"
+
+#include "color-lut.hpp"
+#include "bresenham.hpp"
+
+/* Compile-time configuration:
+ * Color interpolation in draw_triangle_interp(). FLOAT computes barycentric
+ * weights per pixel and converts the interpolated color with
+ * linear_to_srgb(). FIXED steps the colors in 16.16 fixed point along each
+ * span and converts them with a lookup table (see color-lut.hpp). The two
+ * differ by at most 1 LSB. FIXED falls back to FLOAT for triangles whose
+ * color gradients do not fit into 16.16.
+ */
+#define DRAW2D_CFG_INTERP_FLOAT 1
+#define DRAW2D_CFG_INTERP_FIXED 2
+
+#if !defined(DRAW2D_CFG_INTERP_MODE)
+#	define DRAW2D_CFG_INTERP_MODE DRAW2D_CFG_INTERP_FIXED
+#endif
+
+namespace
 {
-	float xmin = aTargetArea.xmin;
-	float xmax = aTargetArea.xmin + aTargetArea.width;
-	float ymin = aTargetArea.ymin;
-	float ymax = aTargetArea.ymin + aTargetArea.height;
-	
-	// Check if line segment endpoints are within the clipping region
-// Note: Use strict less-than comparison because pixel indices range from 0 to width-1/height-1
-	bool begin_inside = (aBegin.x >= xmin && aBegin.x < xmax && aBegin.y >= ymin && aBegin.y < ymax);
-	bool end_inside = (aEnd.x >= xmin && aEnd.x < xmax && aEnd.y >= ymin && aEnd.y < ymax);
-	
-	// Case 1: Both endpoints are within the clipping region
-	if (begin_inside && end_inside) {
-		return true;
+	// Triangle rasterization uses vertex positions with 8 bits of subpixel
+	// precision. Edge functions are products of two coordinate differences
+	// and are evaluated in 64 bits. Positions are limited to +-kMaxCoord_
+	// pixels, which keeps those products comfortably in range. Triangles that
+	// extend further are clipped first (see kGuardBand_ below).
+	constexpr int kSubpixelBits_ = 8;
+	constexpr std::int32_t kSubpixelScale_ = 1 << kSubpixelBits_;
+	constexpr float kMaxCoord_ = float(1 << 19);
+
+	struct FixedTriangle_
+	{
+		std::int32_t x[3], y[3]; // in 1/256 pixels
+		std::int64_t area; // twice the signed area, in 1/256^2 pixels; > 0
+		bool swapped; // true if vertices 1 and 2 were swapped
+	};
+
+	struct PixelBounds_
+	{
+		int x0, y0, x1, y1; // inclusive
+	};
+
+	std::int32_t to_fixed_( float aValue ) noexcept
+	{
+		return std::int32_t(std::lrint( aValue * float(kSubpixelScale_) ));
 	}
-	
-	// Handle vertical lines (same x-coordinate)
-	if (aBegin.x == aEnd.x) {
-		// If the vertical line is outside the clipping region, return false
-		if (aBegin.x < xmin || aBegin.x >= xmax) return false;
-		
-		// Calculate the visible portion of the line segment on the y-axis
-		float y_start = std::max(ymin, std::min(aBegin.y, aEnd.y));
-		float y_end = std::min(ymax, std::max(aBegin.y, aEnd.y));
-		
-		// If the line segment is completely outside the clipping region, return false
-		if (y_start >= y_end) return false;
-		
-		// Update the y-coordinates of the line segment to the visible portion
-		aBegin.y = y_start;
-		aEnd.y = y_end;
+
+	/* Snap vertices and orient the triangle such that the edge functions are
+	 * non-negative inside. Returns false for degenerate (zero area) triangles,
+	 * for triangles with non-finite vertices and for triangles with vertices
+	 * outside of the supported coordinate range.
+	 */
+	bool setup_triangle_( FixedTriangle_& aTri, Vec2f aP0, Vec2f aP1, Vec2f aP2 ) noexcept
+	{
+		for( Vec2f const& p : { aP0, aP1, aP2 } )
+		{
+			// Negated comparison to also reject NaNs.
+			if( !(std::abs( p.x ) <= kMaxCoord_ && std::abs( p.y ) <= kMaxCoord_) )
+				return false;
+		}
+
+		aTri.x[0] = to_fixed_( aP0.x ); aTri.y[0] = to_fixed_( aP0.y );
+		aTri.x[1] = to_fixed_( aP1.x ); aTri.y[1] = to_fixed_( aP1.y );
+		aTri.x[2] = to_fixed_( aP2.x ); aTri.y[2] = to_fixed_( aP2.y );
+
+		aTri.area = std::int64_t(aTri.x[1] - aTri.x[0]) * (aTri.y[2] - aTri.y[0])
+			- std::int64_t(aTri.y[1] - aTri.y[0]) * (aTri.x[2] - aTri.x[0])
+		;
+
+		if( 0 == aTri.area )
+			return false;
+
+		aTri.swapped = aTri.area < 0;
+		if( aTri.swapped )
+		{
+			std::swap( aTri.x[1], aTri.x[2] );
+			std::swap( aTri.y[1], aTri.y[2] );
+			aTri.area = -aTri.area;
+		}
+
 		return true;
 	}
-	
-	// Handle horizontal lines (same y-coordinate)
-	if (aBegin.y == aEnd.y) {
-		// If the horizontal line is outside the clipping region, return false
-		if (aBegin.y < ymin || aBegin.y >= ymax) return false;
-		
-		// Calculate the visible portion of the line segment on the x-axis
-		float x_start = std::max(xmin, std::min(aBegin.x, aEnd.x));
-		float x_end = std::min(xmax, std::max(aBegin.x, aEnd.x));
-		
-		// If the line segment is completely outside the clipping region, return false
-		if (x_start >= x_end) return false;
-		
-		// Update the x-coordinates of the line segment to the visible portion
-		aBegin.x = x_start;
-		aEnd.x = x_end;
-		return true;
+
+	/* Range of pixels whose centers may be covered by the triangle, clamped
+	 * to the surface. Empty if x0 > x1 or y0 > y1.
+	 */
+	PixelBounds_ pixel_bounds_( FixedTriangle_ const& aTri, Surface const& aSurface ) noexcept
+	{
+		auto const [minX, maxX] = std::minmax( { aTri.x[0], aTri.x[1], aTri.x[2] } );
+		auto const [minY, maxY] = std::minmax( { aTri.y[0], aTri.y[1], aTri.y[2] } );
+
+		// Pixel i has its center at i*256 + 128. The first pixel with its
+		// center at or right of minX is ceil((minX-128)/256), the last one
+		// at or left of maxX is floor((maxX-128)/256). Arithmetic right shifts
+		// round towards negative infinity.
+		constexpr std::int32_t half = kSubpixelScale_ / 2;
+		constexpr std::int32_t ceilBias = kSubpixelScale_ - 1;
+
+		PixelBounds_ ret;
+		ret.x0 = std::max( 0, (minX - half + ceilBias) >> kSubpixelBits_ );
+		ret.y0 = std::max( 0, (minY - half + ceilBias) >> kSubpixelBits_ );
+		ret.x1 = std::min( int(aSurface.get_width()) - 1, (maxX - half) >> kSubpixelBits_ );
+		ret.y1 = std::min( int(aSurface.get_height()) - 1, (maxY - half) >> kSubpixelBits_ );
+		return ret;
 	}
-	
-	// General line segment clipping - using Cohen-Sutherland algorithm
-	float dx = aEnd.x - aBegin.x;
-	float dy = aEnd.y - aBegin.y;
-	
-	// If the line segment is a point, return false directly
-	if (dx == 0 && dy == 0) {
-		return false;
+
+	/* Edge function of the edge from vertex aA to vertex aB, evaluated at the
+	 * center of pixel (aX,aY). Positive on the inside of the triangle.
+	 */
+	std::int64_t edge_at_( FixedTriangle_ const& aTri, int aA, int aB, int aX, int aY ) noexcept
+	{
+		std::int64_t const px = std::int64_t(aX) * kSubpixelScale_ + kSubpixelScale_/2;
+		std::int64_t const py = std::int64_t(aY) * kSubpixelScale_ + kSubpixelScale_/2;
+
+		std::int64_t const dx = aTri.x[aB] - aTri.x[aA];
+		std::int64_t const dy = aTri.y[aB] - aTri.y[aA];
+
+		return dx * (py - aTri.y[aA]) - dy * (px - aTri.x[aA]);
+	}
+
+	/* With the orientation established by setup_triangle_() (and y pointing
+	 * down), the interior lies to the right of each directed edge when
+	 * walking in screen space. A top edge is then exactly horizontal and
+	 * points right (dx > 0); a left edge points up (dy < 0).
+	 */
+	bool is_top_left_( FixedTriangle_ const& aTri, int aA, int aB ) noexcept
+	{
+		std::int32_t const dx = aTri.x[aB] - aTri.x[aA];
+		std::int32_t const dy = aTri.y[aB] - aTri.y[aA];
+		return (0 == dy && dx > 0) || dy < 0;
 	}
-	
-	// Calculate intersection parameters with the four boundaries
-	float t_enter = 0.0f;  // Parameter for entering the clipping region
-	float t_exit = 1.0f;   // Parameter for exiting the clipping region
-	
-	// Intersections with left and right boundaries
-	if (dx != 0) {
-		float t_left = (xmin - aBegin.x) / dx;
-		float t_right = (xmax - aBegin.x) / dx;
-		
-		if (dx > 0) {
-			t_enter = std::max(t_enter, t_left);
-			t_exit = std::min(t_exit, t_right);
-		} else {
-			t_enter = std::max(t_enter, t_right);
-			t_exit = std::min(t_exit, t_left);
+
+	/* Edge functions E0 (edge 1->2), E1 (edge 2->0) and E2 (edge 0->1),
+	 * evaluated at some pixel center, and how they change per pixel.
+	 *
+	 * E(x,y) = dx * (py - ay) - dy * (px - ax), with px and py in subpixels,
+	 * so a step of one pixel changes E by -dy*256 along x and by dx*256 along
+	 * y.
+	 *
+	 * Top-left rule: a pixel center that lies exactly on an edge belongs to
+	 * the triangle only if the edge is a top or a left edge. Folding this
+	 * into a bias turns the coverage test into a plain "E + bias >= 0".
+	 */
+	struct EdgeSetup_
+	{
+		std::int64_t e[3]; // at the center of pixel (origin.x, origin.y)
+		std::int64_t stepX[3], stepY[3];
+		std::int64_t bias[3];
+	};
+
+	EdgeSetup_ setup_edges_( FixedTriangle_ const& aTri, int aOriginX, int aOriginY ) noexcept
+	{
+		constexpr int va[3] = { 1, 2, 0 };
+		constexpr int vb[3] = { 2, 0, 1 };
+
+		EdgeSetup_ ret;
+		for( int i = 0; i < 3; ++i )
+		{
+			ret.e[i] = edge_at_( aTri, va[i], vb[i], aOriginX, aOriginY );
+			ret.stepX[i] = -std::int64_t(aTri.y[vb[i]] - aTri.y[va[i]]) * kSubpixelScale_;
+			ret.stepY[i] = std::int64_t(aTri.x[vb[i]] - aTri.x[va[i]]) * kSubpixelScale_;
+			ret.bias[i] = is_top_left_( aTri, va[i], vb[i] ) ? 0 : -1;
 		}
+
+		return ret;
 	}
-	
-	// Intersections with top and bottom boundaries
-	if (dy != 0) {
-		float t_bottom = (ymin - aBegin.y) / dy;
-		float t_top = (ymax - aBegin.y) / dy;
-		
-		if (dy > 0) {
-			t_enter = std::max(t_enter, t_bottom);
-			t_exit = std::min(t_exit, t_top);
-		} else {
-			t_enter = std::max(t_enter, t_top);
-			t_exit = std::min(t_exit, t_bottom);
+
+	/* Visit pixels in the rectangle [aX0,aX1] x [aY0,aY1] (inclusive). aE
+	 * holds the edge functions at (aX0,aY0). With tTestEdges, only pixels
+	 * that pass the coverage test are shaded; without, all of them are.
+	 *
+	 * Each row of the rectangle is a span for the shader; see raster_triangle_().
+	 */
+	template< bool tTestEdges, typename tShade > inline
+	void raster_rect_( EdgeSetup_ const& aEdges, std::int64_t const (&aE)[3], int aX0, int aY0, int aX1, int aY1, tShade const& aShade )
+	{
+		// Local copies: the shaders write pixels through byte pointers, which
+		// the compiler must otherwise assume to alias aEdges and aShade.
+		tShade const shader = aShade;
+
+		std::int64_t const bias0 = aEdges.bias[0], bias1 = aEdges.bias[1], bias2 = aEdges.bias[2];
+		std::int64_t const stepX0 = aEdges.stepX[0], stepX1 = aEdges.stepX[1], stepX2 = aEdges.stepX[2];
+
+		std::int64_t row0 = aE[0], row1 = aE[1], row2 = aE[2];
+		for( int y = aY0; y <= aY1; ++y )
+		{
+			auto span = shader.begin_span( aX0, y, row0, row1, row2 );
+
+			std::int64_t e0 = row0, e1 = row1, e2 = row2;
+			for( int x = aX0; x <= aX1; ++x )
+			{
+				if( !tTestEdges || ((e0 + bias0) | (e1 + bias1) | (e2 + bias2)) >= 0 )
+					shader.shade( span, x );
+
+				shader.step( span );
+
+				if constexpr( tTestEdges )
+				{
+					e0 += stepX0;
+					e1 += stepX1;
+					e2 += stepX2;
+				}
+			}
+
+			row0 += aEdges.stepY[0];
+			row1 += aEdges.stepY[1];
+			row2 += aEdges.stepY[2];
 		}
 	}
-	
-	// Check if there are valid intersections
-	if (t_enter <= t_exit && t_enter >= 0 && t_exit <= 1) {
-		// Calculate the clipped line segment endpoints
-		float new_begin_x = aBegin.x + t_enter * dx;
-		float new_begin_y = aBegin.y + t_enter * dy;
-		float new_end_x = aBegin.x + t_exit * dx;
-		float new_end_y = aBegin.y + t_exit * dy;
-		
-		// Update the line segment endpoints
-		aBegin.x = new_begin_x;
-		aBegin.y = new_begin_y;
-		aEnd.x = new_end_x;
-		aEnd.y = new_end_y;
-		
-		return true;
+
+	/* Two-level rasterization: the bounding box is split into blocks of
+	 * kBlockSize_ x kBlockSize_ pixels. Since the edge functions are linear,
+	 * their extremes over a block are at its corners. A block is
+	 *  - outside, if any single edge fails at all four corners (skipped),
+	 *  - inside, if all edges pass at all four corners (shaded without any
+	 *    further edge tests), or
+	 *  - partial, otherwise (tested pixel by pixel).
+	 *
+	 * Small triangles skip the block level, as there are few or no inside
+	 * blocks to gain from.
+	 *
+	 * Pixels are passed to the shader in spans (rows of a block or of the
+	 * bounding box). For each span, aShade.begin_span( x, y, e0, e1, e2 )
+	 * receives the span's first pixel and the edge functions there, and
+	 * returns the shader's per-span state. aShade.shade( span, x ) is then
+	 * called for each covered pixel, and aShade.step( span ) after each pixel
+	 * of the span, covered or not.
+	 */
+	constexpr int kBlockSize_ = 8;
+	constexpr int kMinBlockedExtent_ = 2*kBlockSize_;
+
+	template< typename tShade > inline
+	void raster_triangle_( PixelBounds_ const& aBounds, EdgeSetup_ const& aEdges, tShade&& aShade )
+	{
+		if( aBounds.x1 - aBounds.x0 < kMinBlockedExtent_ || aBounds.y1 - aBounds.y0 < kMinBlockedExtent_ )
+		{
+			raster_rect_<true>( aEdges, aEdges.e, aBounds.x0, aBounds.y0, aBounds.x1, aBounds.y1, aShade );
+			return;
+		}
+
+		// For each edge, the offsets from a block's first pixel (top left) to
+		// the corners with the smallest and largest value of that edge
+		// function. Only blocks of the full size are classified with these;
+		// the partial blocks at the right and bottom borders are always
+		// tested pixel by pixel.
+		constexpr int last = kBlockSize_-1;
+
+		std::int64_t minOffset[3], maxOffset[3];
+		for( int i = 0; i < 3; ++i )
+		{
+			std::int64_t const sx = aEdges.stepX[i] * last;
+			std::int64_t const sy = aEdges.stepY[i] * last;
+			minOffset[i] = std::min<std::int64_t>( sx, 0 ) + std::min<std::int64_t>( sy, 0 );
+			maxOffset[i] = std::max<std::int64_t>( sx, 0 ) + std::max<std::int64_t>( sy, 0 );
+		}
+
+		std::int64_t blockRow[3] = { aEdges.e[0], aEdges.e[1], aEdges.e[2] };
+		for( int by = aBounds.y0; by <= aBounds.y1; by += kBlockSize_ )
+		{
+			int const ey = std::min( by + last, aBounds.y1 );
+
+			std::int64_t block[3] = { blockRow[0], blockRow[1], blockRow[2] };
+			for( int bx = aBounds.x0; bx <= aBounds.x1; bx += kBlockSize_ )
+			{
+				int const ex = std::min( bx + last, aBounds.x1 );
+
+				if( ex - bx == last && ey - by == last )
+				{
+					bool outside = false, inside = true;
+					for( int i = 0; i < 3; ++i )
+					{
+						outside = outside || block[i] + maxOffset[i] + aEdges.bias[i] < 0;
+						inside = inside && block[i] + minOffset[i] + aEdges.bias[i] >= 0;
+					}
+
+					if( inside )
+						raster_rect_<false>( aEdges, block, bx, by, ex, ey, aShade );
+					else if( !outside )
+						raster_rect_<true>( aEdges, block, bx, by, ex, ey, aShade );
+				}
+				else
+				{
+					raster_rect_<true>( aEdges, block, bx, by, ex, ey, aShade );
+				}
+
+				for( int i = 0; i < 3; ++i )
+					block[i] += aEdges.stepX[i] * kBlockSize_;
+			}
+
+			for( int i = 0; i < 3; ++i )
+				blockRow[i] += aEdges.stepY[i] * kBlockSize_;
+		}
 	}
-	
-	// No valid intersections, line segment is completely outside the clipping region
-	return false;
-}
 
-void draw_clip_line_solid( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
-{
-	// Use Bresenham algorithm to draw single-pixel width continuous lines
-	auto const surfaceWidth  = static_cast<int>( aSurface.get_width() );
-	auto const surfaceHeight = static_cast<int>( aSurface.get_height() );
+	/* Solid fills write whole pixels (r, g, b and the padding byte) as 32-bit
+	 * words rather than going through set_pixel_srgb(). Surface only hands out
+	 * a const pointer to its data; the data itself is not const, so casting
+	 * the constness away is fine.
+	 */
+	std::uint8_t* pixel_row_( Surface& aSurface, int aY ) noexcept
+	{
+		auto* const base = const_cast<std::uint8_t*>( aSurface.get_surface_ptr() );
+		return base + std::size_t(aY) * aSurface.get_width() * 4;
+	}
+
+	std::uint32_t pack_pixel_( ColorU8_sRGB aColor ) noexcept
+	{
+		std::uint8_t const bytes[4] = { aColor.r, aColor.g, aColor.b, 0 };
 
-	auto clamp_to_surface_x = [surfaceWidth]( float value ) -> int
+		std::uint32_t ret;
+		std::memcpy( &ret, bytes, sizeof(ret) );
+		return ret;
+	}
+
+	// Fill pixels [aX0, aX1] (inclusive) of a row with aPixel.
+	void fill_span_( std::uint8_t* aRow, int aX0, int aX1, std::uint32_t aPixel ) noexcept
 	{
-		int v = static_cast<int>( std::lround( value ) );
-		if( v < 0 )
-			return 0;
-		if( v >= surfaceWidth )
-			return surfaceWidth - 1;
-		return v;
+		std::uint8_t* ptr = aRow + std::size_t(aX0) * 4;
+		std::uint8_t* const end = aRow + (std::size_t(aX1) + 1) * 4;
+
+#		if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+		__m256i const pixels8 = _mm256_set1_epi32( int(aPixel) );
+		for( ; end - ptr >= 32; ptr += 32 )
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(ptr), pixels8 );
+#		endif // ~ AVX2
+
+#		if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+		__m128i const pixels4 = _mm_set1_epi32( int(aPixel) );
+		for( ; end - ptr >= 16; ptr += 16 )
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(ptr), pixels4 );
+#		endif // ~ SSE2
+
+		for( ; ptr != end; ptr += 4 )
+			std::memcpy( ptr, &aPixel, sizeof(aPixel) );
+	}
+
+	// Integer division rounding towards negative/positive infinity; aB > 0.
+	std::int64_t floor_div_( std::int64_t aA, std::int64_t aB ) noexcept
+	{
+		std::int64_t const q = aA / aB;
+		return (aA % aB != 0 && aA < 0) ? q-1 : q;
+	}
+	std::int64_t ceil_div_( std::int64_t aA, std::int64_t aB ) noexcept
+	{
+		return -floor_div_( -aA, aB );
+	}
+
+	/* Solid triangles are drawn as one horizontal span per row. The span is
+	 * found by solving "E + bias >= 0" for x, separately for each edge, with
+	 * exact integer arithmetic. The covered pixels are thus exactly the same
+	 * as with the per-pixel test in raster_triangle_().
+	 */
+	void draw_triangle_solid_fixed_( Surface& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2, std::uint32_t aPixel )
+	{
+		FixedTriangle_ tri;
+		if( !setup_triangle_( tri, aP0, aP1, aP2 ) )
+			return;
+
+		PixelBounds_ const bounds = pixel_bounds_( tri, aSurface );
+		if( bounds.x0 > bounds.x1 || bounds.y0 > bounds.y1 )
+			return;
+
+		EdgeSetup_ const edges = setup_edges_( tri, bounds.x0, bounds.y0 );
+
+		std::int64_t row[3] = { edges.e[0], edges.e[1], edges.e[2] };
+		for( int y = bounds.y0; y <= bounds.y1; ++y )
+		{
+			// Span relative to bounds.x0
+			std::int64_t lo = 0, hi = bounds.x1 - bounds.x0;
+			for( int i = 0; i < 3; ++i )
+			{
+				// e + bias + k * stepX >= 0
+				std::int64_t const e = row[i] + edges.bias[i];
+				std::int64_t const step = edges.stepX[i];
+
+				if( step > 0 )
+					lo = std::max( lo, ceil_div_( -e, step ) );
+				else if( step < 0 )
+					hi = std::min( hi, floor_div_( e, -step ) );
+				else if( e < 0 )
+					hi = -1;
+			}
+
+			if( lo <= hi )
+				fill_span_( pixel_row_( aSurface, y ), bounds.x0 + int(lo), bounds.x0 + int(hi), aPixel );
+
+			for( int i = 0; i < 3; ++i )
+				row[i] += edges.stepY[i];
+		}
+	}
+	/* Shaders for draw_triangle_interp(), see raster_triangle_()
+	 *
+	 * InterpShaderFloat_ computes the barycentric weights E0/area, E1/area and
+	 * E2/area for each pixel, interpolates in float and converts with
+	 * linear_to_srgb().
+	 *
+	 * InterpShaderFixed_ uses that colors are affine functions of x and y.
+	 * The colors and their gradients are computed once per triangle; each
+	 * span evaluates the colors at its first pixel and then steps them by
+	 * dC/dx, all in 16.16 fixed point. Colors are scaled such that their
+	 * integer part indexes linear_to_srgb_lut().
+	 */
+	struct InterpShaderFloat_
+	{
+		Surface& surface;
+		ColorF c0, c1, c2;
+		float invArea;
+		std::int64_t stepX[3];
+
+		struct Span
+		{
+			int y;
+			std::int64_t e[3];
+		};
+
+		Span begin_span( int, int aY, std::int64_t aE0, std::int64_t aE1, std::int64_t aE2 ) const noexcept
+		{
+			return { aY, { aE0, aE1, aE2 } };
+		}
+
+		void shade( Span const& aSpan, int aX ) const
+		{
+			float const w0 = float(aSpan.e[0]) * invArea;
+			float const w1 = float(aSpan.e[1]) * invArea;
+			float const w2 = float(aSpan.e[2]) * invArea;
+
+			ColorF const col{
+				std::clamp( w0 * c0.r + w1 * c1.r + w2 * c2.r, 0.f, 1.f ),
+				std::clamp( w0 * c0.g + w1 * c1.g + w2 * c2.g, 0.f, 1.f ),
+				std::clamp( w0 * c0.b + w1 * c1.b + w2 * c2.b, 0.f, 1.f )
+			};
+
+			surface.set_pixel_srgb( aX, aSpan.y, linear_to_srgb( col ) );
+		}
+
+		void step( Span& aSpan ) const noexcept
+		{
+			for( int i = 0; i < 3; ++i )
+				aSpan.e[i] += stepX[i];
+		}
 	};
 
-	auto clamp_to_surface_y = [surfaceHeight]( float value ) -> int
+	constexpr int kColorFracBits_ = 16;
+	constexpr std::int32_t kColorMaxIndex_ = kLinearToSrgbLutSize-1;
+
+	// Largest color (in LUT index units) and per-pixel step that the fixed
+	// point shader accepts. Their sum must fit into 31 bits.
+	constexpr double kColorFixedLimit_ = double(1 << (29-kColorFracBits_));
+
+	struct InterpShaderFixed_
 	{
-		int v = static_cast<int>( std::lround( value ) );
-		if( v < 0 )
-			return 0;
-		if( v >= surfaceHeight )
-			return surfaceHeight - 1;
-		return v;
+		std::uint8_t* pixels;
+		std::size_t stride; // bytes per row
+		std::uint8_t const* lut;
+
+		// Colors at the center of pixel (x0,y0), and their per-pixel change
+		// along x and y. All in LUT index units, 16.16 fixed point.
+		int x0, y0;
+		std::int32_t c0[3];
+		std::int32_t dcdx[3], dcdy[3];
+
+		struct Span
+		{
+			std::uint8_t* row;
+			std::int32_t r, g, b;
+		};
+
+		Span begin_span( int aX, int aY, std::int64_t, std::int64_t, std::int64_t ) const noexcept
+		{
+			auto const at = [&] (int aChannel) {
+				return std::int32_t(c0[aChannel] + std::int64_t(dcdx[aChannel]) * (aX - x0) + std::int64_t(dcdy[aChannel]) * (aY - y0));
+			};
+
+			return { pixels + std::size_t(aY) * stride, at( 0 ), at( 1 ), at( 2 ) };
+		}
+
+		void shade( Span const& aSpan, int aX ) const noexcept
+		{
+			// Assemble the pixel in a register. (Writing the bytes to memory
+			// one by one and then reading them as a word would stall on store
+			// forwarding.) Byte order in memory is r, g, b, padding.
+			static_assert( std::endian::native == std::endian::little );
+
+			std::uint32_t const pixel = std::uint32_t(encode_( aSpan.r ))
+				| std::uint32_t(encode_( aSpan.g )) << 8
+				| std::uint32_t(encode_( aSpan.b )) << 16
+			;
+
+			std::memcpy( aSpan.row + std::size_t(aX) * 4, &pixel, sizeof(pixel) );
+		}
+
+		void step( Span& aSpan ) const noexcept
+		{
+			aSpan.r += dcdx[0];
+			aSpan.g += dcdx[1];
+			aSpan.b += dcdx[2];
+		}
+
+		std::uint8_t encode_( std::int32_t aValue ) const noexcept
+		{
+			constexpr std::int32_t round = 1 << (kColorFracBits_-1);
+			return lut[std::clamp( (aValue + round) >> kColorFracBits_, 0, kColorMaxIndex_ )];
+		}
+
+		/* Set up the shader for the given triangle. Returns false if the
+		 * colors, extrapolated to the corners of the bounding box, or their
+		 * gradients do not fit into 16.16 fixed point (this only happens for
+		 * extremely thin triangles).
+		 */
+		bool setup( Surface& aSurface, FixedTriangle_ const& aTri, PixelBounds_ const& aBounds, EdgeSetup_ const& aEdges, ColorF const (&aCols)[3] ) noexcept
+		{
+			pixels = pixel_row_( aSurface, 0 );
+			stride = std::size_t(aSurface.get_width()) * 4;
+			lut = linear_to_srgb_lut();
+
+			x0 = aBounds.x0;
+			y0 = aBounds.y0;
+
+			// Color = sum_v color_v * E_v / area. The E_v are affine in x and
+			// y, and so are the colors.
+			double const norm = double(kColorMaxIndex_) * double(1 << kColorFracBits_) / double(aTri.area);
+			double const w = aBounds.x1 - aBounds.x0, h = aBounds.y1 - aBounds.y0;
+			double const limit = kColorFixedLimit_ * double(1 << kColorFracBits_);
+
+			for( int i = 0; i < 3; ++i )
+			{
+				double c = 0.0, dx = 0.0, dy = 0.0;
+				for( int v = 0; v < 3; ++v )
+				{
+					float const col = 0 == i ? aCols[v].r : 1 == i ? aCols[v].g : aCols[v].b;
+					double const scale = double(col) * norm;
+					c += scale * double(aEdges.e[v]);
+					dx += scale * double(aEdges.stepX[v]);
+					dy += scale * double(aEdges.stepY[v]);
+				}
+
+				if( !(std::abs( dx ) < limit && std::abs( dy ) < limit) )
+					return false;
+
+				for( double const corner : { c, c + w*dx, c + h*dy, c + w*dx + h*dy } )
+				{
+					if( !(std::abs( corner ) < limit) )
+						return false;
+				}
+
+				c0[i] = std::int32_t(std::lrint( c ));
+				dcdx[i] = std::int32_t(std::lrint( dx ));
+				dcdy[i] = std::int32_t(std::lrint( dy ));
+			}
+
+			return true;
+		}
 	};
 
-	int x0 = clamp_to_surface_x( aBegin.x );
-	int y0 = clamp_to_surface_y( aBegin.y );
-	int x1 = clamp_to_surface_x( aEnd.x );
-	int y1 = clamp_to_surface_y( aEnd.y );
-	
-	// Calculate coordinate differences
-	int dx = abs(x1 - x0);
-	int dy = abs(y1 - y0);
-	bool steep = false;
-	
-	if( dy > dx ){
-		std::swap( x0, y0 );
-		std::swap( x1, y1 );
-		std::swap( dx, dy );
-		steep = true;
+	void draw_triangle_interp_fixed_( Surface& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2, ColorF aC0, ColorF aC1, ColorF aC2 )
+	{
+		// Triangle setup in fixed point. Vertices are snapped to a 1/256 pixel
+		// grid; after that, all coverage decisions are exact integer tests.
+		// This, together with the top-left rule (see raster_triangle_()),
+		// ensures that two triangles that share an edge never both cover a
+		// pixel on that edge (and that there are no gaps between them).
+		FixedTriangle_ tri;
+		if( !setup_triangle_( tri, aP0, aP1, aP2 ) )
+			return;
+
+		// setup_triangle_() may have swapped two vertices to fix the winding.
+		if( tri.swapped )
+			std::swap( aC1, aC2 );
+
+		PixelBounds_ const bounds = pixel_bounds_( tri, aSurface );
+		if( bounds.x0 > bounds.x1 || bounds.y0 > bounds.y1 )
+			return;
+
+		EdgeSetup_ const edges = setup_edges_( tri, bounds.x0, bounds.y0 );
+
+#		if DRAW2D_CFG_INTERP_MODE == DRAW2D_CFG_INTERP_FIXED
+		InterpShaderFixed_ fixed;
+		if( fixed.setup( aSurface, tri, bounds, edges, { aC0, aC1, aC2 } ) )
+		{
+			raster_triangle_( bounds, edges, fixed );
+			return;
+		}
+#		endif // ~ INTERP_FIXED
+
+		raster_triangle_( bounds, edges, InterpShaderFloat_{
+			aSurface, aC0, aC1, aC2, 1.f / float(tri.area),
+			{ edges.stepX[0], edges.stepX[1], edges.stepX[2] }
+		} );
 	}
 
-	if( x0 > x1 ){
-		std::swap( x0, x1 );
-		std::swap( y0, y1 );
+
+	/* Guard band clipping
+	 *
+	 * Triangles whose vertices all lie within kGuardBand_ pixels of the
+	 * clip area are rasterized directly; only the bounding box is clamped.
+	 * This is the vast majority of triangles. The guard band is well within
+	 * the range supported by the fixed-point setup (kMaxCoord_), so the edge
+	 * functions remain exact.
+	 *
+	 * Triangles that extend beyond the guard band are clipped against the
+	 * clip area with Sutherland-Hodgman. The clip rectangle is enlarged by
+	 * kClipMargin_ pixels, such that the new edges introduced by clipping lie
+	 * outside of the surface and never decide coverage themselves. The
+	 * intersections are computed in double precision, since the original
+	 * vertices may be arbitrarily far away.
+	 */
+	constexpr float kGuardBand_ = 4096.f;
+	constexpr double kClipMargin_ = 1.0;
+
+	static_assert( kGuardBand_ * 4 < kMaxCoord_ );
+
+	bool in_guard_band_( Rect2F const& aClip, Vec2f aP0, Vec2f aP1, Vec2f aP2 ) noexcept
+	{
+		float const xmin = aClip.xmin - kGuardBand_;
+		float const ymin = aClip.ymin - kGuardBand_;
+		float const xmax = aClip.xmin + aClip.width + kGuardBand_;
+		float const ymax = aClip.ymin + aClip.height + kGuardBand_;
+
+		// Written such that NaNs fail the test.
+		bool inside = true;
+		for( Vec2f const& p : { aP0, aP1, aP2 } )
+			inside = inside && p.x >= xmin && p.x <= xmax && p.y >= ymin && p.y <= ymax;
+
+		return inside;
 	}
-	
-	// 
-	int p = 2 * dy - dx;
-	const int stepY = (y0 < y1) ? 1 : -1;
 
-	
-	//
-	while (!steep && x0 <= x1) {
-		// draw pixels
-		aSurface.set_pixel_srgb(x0, y0, aColor);
-		if(p >= 0){
-			y0 += stepY;
-			p -= 2 * dx;
+	// A triangle clipped by four planes has at most 3+4 vertices.
+	constexpr int kMaxClipVertices_ = 7;
+
+	struct ClipPolygon_
+	{
+		int count;
+		Vec2f pos[kMaxClipVertices_];
+		ColorF col[kMaxClipVertices_];
+	};
+
+	/* Clip triangle to aClip (plus kClipMargin_). Returns false if nothing
+	 * remains. The result is a convex polygon with the original winding.
+	 */
+	bool clip_triangle_( Rect2F const& aClip, std::array<Vec2f,3> const& aPos, std::array<ColorF,3> const& aCol, ClipPolygon_& aOut ) noexcept
+	{
+		struct Vertex_
+		{
+			double x, y;
+			ColorF col;
+		};
+
+		// Two buffers; each pass reads from one and writes the other.
+		Vertex_ bufA[kMaxClipVertices_+1], bufB[kMaxClipVertices_+1];
+		Vertex_* in = bufA;
+		Vertex_* out = bufB;
+
+		int count = 3;
+		for( int i = 0; i < 3; ++i )
+			in[i] = Vertex_{ aPos[i].x, aPos[i].y, aCol[i] };
+
+		// Inside of each plane: x*nx + y*ny <= d
+		double const xmin = double(aClip.xmin) - kClipMargin_;
+		double const ymin = double(aClip.ymin) - kClipMargin_;
+		double const xmax = double(aClip.xmin) + aClip.width + kClipMargin_;
+		double const ymax = double(aClip.ymin) + aClip.height + kClipMargin_;
+
+		struct Plane_ { double nx, ny, d; };
+		Plane_ const planes[4] = {
+			{ -1.0,  0.0, -xmin },
+			{  1.0,  0.0,  xmax },
+			{  0.0, -1.0, -ymin },
+			{  0.0,  1.0,  ymax }
+		};
+
+		for( auto const& plane : planes )
+		{
+			int outCount = 0;
+			for( int i = 0; i < count; ++i )
+			{
+				Vertex_ const& a = in[i];
+				Vertex_ const& b = in[(i+1) % count];
+
+				double const da = plane.d - (a.x * plane.nx + a.y * plane.ny);
+				double const db = plane.d - (b.x * plane.nx + b.y * plane.ny);
+
+				if( da >= 0.0 )
+					out[outCount++] = a;
+
+				if( (da >= 0.0) != (db >= 0.0) )
+				{
+					double const t = da / (da - db);
+					float const ft = float(t);
+
+					out[outCount++] = Vertex_{
+						a.x + t * (b.x - a.x),
+						a.y + t * (b.y - a.y),
+						ColorF{
+							a.col.r + ft * (b.col.r - a.col.r),
+							a.col.g + ft * (b.col.g - a.col.g),
+							a.col.b + ft * (b.col.b - a.col.b)
+						}
+					};
+				}
+			}
+
+			if( outCount < 3 )
+				return false;
+
+			count = outCount;
+			std::swap( in, out );
 		}
-		x0 += 1;
-		p += 2 * dy;
-	}
-	while(steep && x0 <= x1){
-		aSurface.set_pixel_srgb(y0, x0, aColor);
-		if(p >= 0){
-			y0 += stepY;
-			p -= 2 * dx;
+
+		assert( count <= kMaxClipVertices_ );
+
+		aOut.count = count;
+		for( int i = 0; i < count; ++i )
+		{
+			aOut.pos[i] = Vec2f{ float(in[i].x), float(in[i].y) };
+			aOut.col[i] = in[i].col;
 		}
-		x0 += 1;
-		p += 2 * dy;
+
+		return true;
 	}
 }
 
+bool clip_line( Rect2F const& aTargetArea, Vec2f& aBegin, Vec2f& aEnd )
+{
+	// Liang-Barsky, after trivial accept/reject tests with outcodes. The
+	// area includes its minimum but not its maximum edges: pixel indices
+	// range from 0 to width-1/height-1.
+	//
+	// clip_lines() (clip-batch.hpp) performs the same operations, in the
+	// same order, eight segments at a time. Keep the two in sync.
+	float const xmin = aTargetArea.xmin;
+	float const xmax = aTargetArea.xmin + aTargetArea.width;
+	float const ymin = aTargetArea.ymin;
+	float const ymax = aTargetArea.ymin + aTargetArea.height;
+
+	// Written as !(inside), so that NaNs count as outside.
+	auto const outcode = [&] (Vec2f aPoint) {
+		return unsigned(!(aPoint.x >= xmin)) << 0
+			| unsigned(!(aPoint.x < xmax)) << 1
+			| unsigned(!(aPoint.y >= ymin)) << 2
+			| unsigned(!(aPoint.y < ymax)) << 3
+		;
+	};
+
+	unsigned const code0 = outcode( aBegin );
+	unsigned const code1 = outcode( aEnd );
+
+	if( 0 == (code0 | code1) )
+		return true; // both endpoints inside
+	if( 0 != (code0 & code1) )
+		return false; // both endpoints outside of the same edge
+
+	float const dx = aEnd.x - aBegin.x;
+	float const dy = aEnd.y - aBegin.y;
+
+	// Segment parameters at which the line enters and leaves the area. A
+	// zero dx (dy) means that the line lies between the x (y) edges; the
+	// outcodes have rejected it otherwise.
+	float enter = 0.f, leave = 1.f;
+	if( 0.f != dx )
+	{
+		float const t0 = (xmin - aBegin.x) / dx;
+		float const t1 = (xmax - aBegin.x) / dx;
+		enter = std::max( enter, std::min( t0, t1 ) );
+		leave = std::min( leave, std::max( t0, t1 ) );
+	}
+	if( 0.f != dy )
+	{
+		float const t0 = (ymin - aBegin.y) / dy;
+		float const t1 = (ymax - aBegin.y) / dy;
+		enter = std::max( enter, std::min( t0, t1 ) );
+		leave = std::min( leave, std::max( t0, t1 ) );
+	}
+
+	if( !(enter <= leave) )
+		return false;
+
+	// Endpoints that were inside are kept exactly.
+	Vec2f const begin = aBegin;
+	if( enter > 0.f )
+		aBegin = Vec2f{ begin.x + enter * dx, begin.y + enter * dy };
+	if( leave < 1.f )
+		aEnd = Vec2f{ begin.x + leave * dx, begin.y + leave * dy };
+
+	return true;
+}
+
+void draw_clip_line_solid( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+{
+	// Clipping is exact and, for lines that are already inside, cheap. The
+	// endpoints are therefore not trusted to be inside the surface.
+	draw_line_solid( aSurface, aSurface.clip_area(), aBegin, aEnd, aColor );
+}
+
 
 void draw_line_solid( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
 {
-	if( clip_line( aSurface.clip_area(), aBegin, aEnd ) )
-		draw_clip_line_solid( aSurface, aBegin, aEnd, aColor );
+	draw_line_solid( aSurface, aSurface.clip_area(), aBegin, aEnd, aColor );
 }
 void draw_line_solid( Surface& aSurface, Rect2F const& aClipArea, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
 {
-	if( clip_line( aClipArea, aBegin, aEnd ) )
-		draw_clip_line_solid( aSurface, aBegin, aEnd, aColor );
-}
+	// Bresenham between the pixels nearest to the (unclipped) endpoints,
+	// started and stopped at the steps where it enters and leaves the clip
+	// area. See bresenham.hpp.
+	BresenhamSpan span;
+	if( !bresenham_clip( aClipArea, int(aSurface.get_width()), int(aSurface.get_height()), aBegin, aEnd, span ) )
+		return;
 
+	bresenham_run( span.line, span.first, span.last, [&] (int aX, int aY) {
+		aSurface.set_pixel_srgb( aX, aY, aColor );
+	} );
+}
 
 void draw_triangle_interp( Surface& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2, ColorF aC0, ColorF aC1, ColorF aC2 )
 {
-	// Calculate the bounding box of the triangle
-	float min_x = std::min({aP0.x, aP1.x, aP2.x});
-	float max_x = std::max({aP0.x, aP1.x, aP2.x});
-	float min_y = std::min({aP0.y, aP1.y, aP2.y});
-	float max_y = std::max({aP0.y, aP1.y, aP2.y});
-	
-	// Intersect the bounding box with the clipping region
-	Rect2F clip_area = aSurface.clip_area();
-	float clip_xmax = clip_area.xmin + clip_area.width;
-	float clip_ymax = clip_area.ymin + clip_area.height;
-	min_x = std::max(min_x, clip_area.xmin);
-	max_x = std::min(max_x, clip_xmax);
-	min_y = std::max(min_y, clip_area.ymin);
-	max_y = std::min(max_y, clip_ymax);
-	
-	// Convert to integer pixel coordinates
-	// Use floor to ensure all potentially covered pixels are included
-	int start_x = static_cast<int>(std::floor(min_x));
-	int end_x = static_cast<int>(std::floor(max_x));
-	int start_y = static_cast<int>(std::floor(min_y));
-	int end_y = static_cast<int>(std::floor(max_y));
-	
-	// Ensure coordinates are within surface bounds (0 <= x < width, 0 <= y < height)
-	start_x = std::max(0, start_x);
-	end_x = std::min(static_cast<int>(aSurface.get_width() - 1), end_x);
-	start_y = std::max(0, start_y);
-	end_y = std::min(static_cast<int>(aSurface.get_height() - 1), end_y);
-	
-	// Calculate triangle area (for barycentric coordinates)
-	float area = (aP1.y - aP2.y) * (aP0.x - aP2.x) + (aP2.x - aP1.x) * (aP0.y - aP2.y);
-	
-	// If area is 0, triangle is degenerate, don't draw
-	if (std::abs(area) < 1e-6f) {
+	Rect2F const clip = aSurface.clip_area();
+
+	// Common case: the triangle is within the guard band, and the rasterizer
+	// can deal with it directly (the bounding box is clamped to the surface).
+	if( in_guard_band_( clip, aP0, aP1, aP2 ) )
+	{
+		draw_triangle_interp_fixed_( aSurface, aP0, aP1, aP2, aC0, aC1, aC2 );
 		return;
 	}
-	
-	float inv_area = 1.0f / area;
-	
-	// Iterate through each pixel in the bounding box
-	for (int y = start_y; y <= end_y; ++y) {
-		for (int x = start_x; x <= end_x; ++x) {
-			// Current pixel center point
-			Vec2f pixel_center = Vec2f{static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f};
-			
-			// Calculate barycentric coordinates
-			float w0 = ((aP1.y - aP2.y) * (pixel_center.x - aP2.x) + (aP2.x - aP1.x) * (pixel_center.y - aP2.y)) * inv_area;
-			float w1 = ((aP2.y - aP0.y) * (pixel_center.x - aP0.x) + (aP0.x - aP2.x) * (pixel_center.y - aP0.y)) * inv_area;
-			float w2 = 1.0f - w0 - w1;
-			
-			// Check if pixel is inside the triangle
-			if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f) {
-				// Inside the triangle, perform color interpolation
-				ColorF interpolated_color{
-					w0 * aC0.r + w1 * aC1.r + w2 * aC2.r,
-					w0 * aC0.g + w1 * aC1.g + w2 * aC2.g,
-					w0 * aC0.b + w1 * aC1.b + w2 * aC2.b
-				};
-				
-				// Ensure color values are within valid range
-				interpolated_color.r = std::max(0.0f, std::min(1.0f, interpolated_color.r));
-				interpolated_color.g = std::max(0.0f, std::min(1.0f, interpolated_color.g));
-				interpolated_color.b = std::max(0.0f, std::min(1.0f, interpolated_color.b));
-				
-				// Convert to sRGB and draw the pixel
-				ColorU8_sRGB final_color = linear_to_srgb(interpolated_color);
-				aSurface.set_pixel_srgb(x, y, final_color);
-			}
-		}
+
+	// Otherwise, clip to (slightly more than) the surface first.
+	ClipPolygon_ poly;
+	if( !clip_triangle_( clip, { aP0, aP1, aP2 }, { aC0, aC1, aC2 }, poly ) )
+		return;
+
+	for( int i = 2; i < poly.count; ++i )
+	{
+		draw_triangle_interp_fixed_( aSurface,
+			poly.pos[0], poly.pos[i-1], poly.pos[i],
+			poly.col[0], poly.col[i-1], poly.col[i]
+		);
 	}
 }
 
@@ -298,40 +868,58 @@ void draw_triangle_wireframe( Surface& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2
 
 void draw_triangle_solid( Surface& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2, ColorU8_sRGB aColor )
 {
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
+	// Same structure as draw_triangle_interp(): guard band test, followed by
+	// clipping of the few triangles that extend beyond it.
+	Rect2F const clip = aSurface.clip_area();
+	std::uint32_t const pixel = pack_pixel_( aColor );
 
-	//TODO: remove the following when you start your implementation
-	(void)aSurface; // Avoid warnings about unused arguments until the function
-	(void)aP0;   // is properly implemented.
-	(void)aP1;
-	(void)aP2;
-	(void)aColor;
+	if( in_guard_band_( clip, aP0, aP1, aP2 ) )
+	{
+		draw_triangle_solid_fixed_( aSurface, aP0, aP1, aP2, pixel );
+		return;
+	}
+
+	ClipPolygon_ poly;
+	if( !clip_triangle_( clip, { aP0, aP1, aP2 }, {}, poly ) )
+		return;
+
+	for( int i = 2; i < poly.count; ++i )
+		draw_triangle_solid_fixed_( aSurface, poly.pos[0], poly.pos[i-1], poly.pos[i], pixel );
 }
 
 void draw_rectangle_solid( Surface& aSurface, Vec2f aMinCorner, Vec2f aMaxCorner, ColorU8_sRGB aColor )
 {
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
+	// A pixel is covered if its center lies inside [min, max). Clamp the
+	// resulting pixel range to the surface.
+	auto const surfaceWidth  = static_cast<int>( aSurface.get_width() );
+	auto const surfaceHeight = static_cast<int>( aSurface.get_height() );
 
-	//TODO: remove the following when you start your implementation
-	(void)aSurface; // Avoid warnings about unused arguments until the function
-	(void)aMinCorner;   // is properly implemented.
-	(void)aMaxCorner;
-	(void)aColor;
+	float const minX = std::min( aMinCorner.x, aMaxCorner.x );
+	float const maxX = std::max( aMinCorner.x, aMaxCorner.x );
+	float const minY = std::min( aMinCorner.y, aMaxCorner.y );
+	float const maxY = std::max( aMinCorner.y, aMaxCorner.y );
+
+	int const start_x = std::max( 0, static_cast<int>( std::ceil( minX - 0.5f ) ) );
+	int const end_x = std::min( surfaceWidth, static_cast<int>( std::ceil( maxX - 0.5f ) ) );
+	int const start_y = std::max( 0, static_cast<int>( std::ceil( minY - 0.5f ) ) );
+	int const end_y = std::min( surfaceHeight, static_cast<int>( std::ceil( maxY - 0.5f ) ) );
+
+	for( int y = start_y; y < end_y; ++y )
+	{
+		for( int x = start_x; x < end_x; ++x )
+			aSurface.set_pixel_srgb( x, y, aColor );
+	}
 }
 
 void draw_rectangle_outline( Surface& aSurface, Vec2f aMinCorner, Vec2f aMaxCorner, ColorU8_sRGB aColor )
 {
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
+	// Four lines through the corners. Each line is clipped individually by
+	// draw_line_solid().
+	Vec2f const c01{ aMaxCorner.x, aMinCorner.y };
+	Vec2f const c10{ aMinCorner.x, aMaxCorner.y };
 
-	//TODO: remove the following when you start your implementation
-	(void)aSurface; // Avoid warnings about unused arguments
-	(void)aMinCorner;
-	(void)aMaxCorner;
-	(void)aColor;
+	draw_line_solid( aSurface, aMinCorner, c01, aColor );
+	draw_line_solid( aSurface, c01, aMaxCorner, aColor );
+	draw_line_solid( aSurface, aMaxCorner, c10, aColor );
+	draw_line_solid( aSurface, c10, aMinCorner, aColor );
 }
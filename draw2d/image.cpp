@@ -3,6 +3,7 @@
 #include <memory>
 #include <algorithm>
 
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <cassert>
@@ -11,6 +12,8 @@
 
 #include "surface.hpp"
 
+#include "../vmlib/simd.hpp"
+
 #include "../support/error.hpp"
 
 namespace
@@ -80,37 +83,45 @@ void blit_masked( Surface& aSurface, ImageRGBA const& aImage, Vec2f aPosition )
 	// Calculate the corresponding source image region
 	int sourceStartX = visibleStartX - intStartX;
 	int sourceStartY = visibleStartY - intStartY;
-	int sourceEndX = sourceStartX + (visibleEndX - visibleStartX);
-	int sourceEndY = sourceStartY + (visibleEndY - visibleStartY);
-	
-	// Iterate only through the visible region
-	for (int y = sourceStartY; y < sourceEndY; ++y)
+
+	// Copy row by row. Pixels with alpha < 128 are discarded; the others
+	// replace the r, g and b bytes of the surface's pixels, as with
+	// set_pixel_srgb(). Surface only hands out a const pointer to its data;
+	// the data itself is not const (see also pixel_row_() in draw.cpp).
+	auto* const surfacePixels = const_cast<std::uint8_t*>( aSurface.get_surface_ptr() );
+	auto const count = std::size_t(visibleEndX - visibleStartX);
+
+	for (int y = 0; y < visibleEndY - visibleStartY; ++y)
 	{
-		int surfaceY = visibleStartY + (y - sourceStartY);
-		
-		for (int x = sourceStartX; x < sourceEndX; ++x)
+		std::uint8_t const* src = aImage.get_image_ptr()
+			+ std::size_t(aImage.get_linear_index( ImageRGBA::Index(sourceStartX), ImageRGBA::Index(sourceStartY + y) )) * 4;
+		std::uint8_t* dst = surfacePixels
+			+ std::size_t(aSurface.get_linear_index( Surface::Index(visibleStartX), Surface::Index(visibleStartY + y) )) * 4;
+
+		std::size_t x = 0;
+
+#		if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+		// The alpha byte is the top byte of each 32-bit pixel, so its sign
+		// bit is set exactly if alpha >= 128.
+		__m256i const rgb = _mm256_set1_epi32( 0x00ffffff );
+		for( ; x + 8 <= count; x += 8, src += 32, dst += 32 )
 		{
-			int surfaceX = visibleStartX + (x - sourceStartX);
-			
-			// Get the source pixel color
-			ColorU8_sRGB_Alpha sourcePixel = aImage.get_pixel(
-				static_cast<ImageRGBA::Index>(x), 
-				static_cast<ImageRGBA::Index>(y)
-			);
-			
-			// Skip pixels with alpha < 128 (discard transparent pixels)
-			if (sourcePixel.a < 128)
+			__m256i const s = _mm256_loadu_si256( reinterpret_cast<__m256i const*>(src) );
+			__m256i const d = _mm256_loadu_si256( reinterpret_cast<__m256i const*>(dst) );
+
+			__m256i const keep = _mm256_and_si256( _mm256_srai_epi32( s, 31 ), rgb );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(dst), _mm256_blendv_epi8( d, s, keep ) );
+		}
+#		endif // ~ AVX2
+
+		for( ; x < count; ++x, src += 4, dst += 4 )
+		{
+			if( src[3] < 128 )
 				continue;
-			
-			// Convert to ColorU8_sRGB (without alpha) for the surface
-			ColorU8_sRGB targetColor = { sourcePixel.r, sourcePixel.g, sourcePixel.b };
-			
-			// Set the pixel on the surface
-			aSurface.set_pixel_srgb(
-				static_cast<Surface::Index>(surfaceX), 
-				static_cast<Surface::Index>(surfaceY), 
-				targetColor
-			);
+
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
 		}
 	}
 }
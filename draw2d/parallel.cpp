@@ -0,0 +1,20 @@
+#include "parallel.hpp"
+
+namespace
+{
+	Executor* gExecutor_ = nullptr;
+}
+
+void set_executor( Executor* aExecutor ) noexcept
+{
+	gExecutor_ = aExecutor;
+}
+Executor* executor() noexcept
+{
+	return gExecutor_;
+}
+
+unsigned executor_concurrency() noexcept
+{
+	return gExecutor_ ? gExecutor_->concurrency() : 1u;
+}
@@ -0,0 +1,48 @@
+#ifndef PARALLEL_HPP_30E7CE65_1EF6_4D39_BE48_A7AC6946133F
+#define PARALLEL_HPP_30E7CE65_1EF6_4D39_BE48_A7AC6946133F
+
+#include <cstddef>
+
+/* Parallel execution
+ *
+ * draw2d does not start threads of its own. Functions that can split their
+ * work (currently draw_lines_batch()) hand the pieces to the executor set
+ * with set_executor(). The application installs a persistent thread pool
+ * (see ThreadPool in support/thread_pool.hpp) once at startup. Without an
+ * executor, the pieces run one after another on the calling thread.
+ *
+ * Like the line style (see draw-aa.hpp), the executor is a global setting.
+ */
+class Executor
+{
+	public:
+		virtual ~Executor() = default;
+
+		// Number of threads that run tasks, including the calling thread.
+		virtual unsigned concurrency() const noexcept = 0;
+
+		/* Call aTask( aContext, i ) for each i in [0, aCount), possibly
+		 * concurrently and in any order. Returns once all calls have
+		 * returned. If calls throw, one of the exceptions is rethrown.
+		 */
+		virtual void run( std::size_t aCount, void (*aTask)( void*, std::size_t ), void* aContext ) = 0;
+};
+
+void set_executor( Executor* ) noexcept;
+Executor* executor() noexcept;
+
+// Number of threads that the current executor runs tasks on; 1 if none.
+unsigned executor_concurrency() noexcept;
+
+/* Call aBody( begin, end ) for consecutive ranges that cover [aBegin, aEnd),
+ * each at most aGrain long, using the current executor.
+ */
+template< typename tBody > inline
+void parallel_for( int aBegin, int aEnd, int aGrain, tBody&& aBody );
+
+// As above, with an explicit executor. aExecutor may be null.
+template< typename tBody > inline
+void parallel_for( Executor* aExecutor, int aBegin, int aEnd, int aGrain, tBody&& aBody );
+
+#include "parallel.inl"
+#endif // PARALLEL_HPP_30E7CE65_1EF6_4D39_BE48_A7AC6946133F
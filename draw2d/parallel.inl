@@ -0,0 +1,37 @@
+#include <algorithm>
+
+#include <cassert>
+
+template< typename tBody > inline
+void parallel_for( int aBegin, int aEnd, int aGrain, tBody&& aBody )
+{
+	parallel_for( executor(), aBegin, aEnd, aGrain, static_cast<tBody&&>(aBody) );
+}
+
+template< typename tBody > inline
+void parallel_for( Executor* aExecutor, int aBegin, int aEnd, int aGrain, tBody&& aBody )
+{
+	assert( aGrain > 0 );
+	if( aBegin >= aEnd )
+		return;
+
+	auto const chunks = std::size_t((aEnd - aBegin + aGrain - 1) / aGrain);
+	if( !aExecutor || 1 == chunks )
+	{
+		for( int begin = aBegin; begin < aEnd; begin += aGrain )
+			aBody( begin, std::min( aEnd, begin + aGrain ) );
+		return;
+	}
+
+	struct Context_
+	{
+		tBody& body;
+		int begin, end, grain;
+	} context{ aBody, aBegin, aEnd, aGrain };
+
+	aExecutor->run( chunks, [] (void* aContext, std::size_t aChunk) {
+		auto& ctx = *static_cast<Context_*>(aContext);
+		int const begin = ctx.begin + int(aChunk) * ctx.grain;
+		ctx.body( begin, std::min( ctx.end, begin + ctx.grain ) );
+	}, &context );
+}
@@ -1,14 +1,105 @@
 #include "shape.hpp"
 
+#include <memory>
 #include <utility>
+#include <iterator>
+#include <algorithm>
 
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 
 #include "draw.hpp"
 #include "color.hpp"
+#include "draw-aa.hpp"
+#include "stroke.hpp"
 #include "surface.hpp"
 
+#include "../vmlib/vec2_batch.hpp"
+
+namespace
+{
+	// Vertices transformed by transform_points(). Small shapes (asteroids
+	// have 19 vertices) are kept on the stack; larger ones use the heap.
+	class TransformedVertices_
+	{
+		public:
+			TransformedVertices_( std::size_t aCount, Vec2f const* aVerts, Mat22f const& aRotation, Vec2f const& aTranslation )
+				: mCount( aCount )
+			{
+				if( mCount > kLocalCount )
+				{
+					mHeap = std::make_unique<Vec2f[]>( mCount );
+					mVerts = mHeap.get();
+				}
+
+				transform_points( mCount, aVerts, aRotation, aTranslation, mVerts );
+			}
+
+			Vec2f const& operator[] (std::size_t aIndex) const noexcept
+			{
+				return mVerts[aIndex];
+			}
+
+			// Conservative test whether the shape lies entirely outside of
+			// the surface, in which case nothing would be drawn.
+			bool outside( Surface const& aSurface ) const noexcept
+			{
+				auto const box = bounding_box( mCount, mVerts );
+				return box.max.x < -1.f || box.max.y < -1.f
+					|| box.min.x > float(aSurface.get_width()) + 1.f
+					|| box.min.y > float(aSurface.get_height()) + 1.f
+				;
+			}
+
+		private:
+			static constexpr std::size_t kLocalCount = 64;
+
+			std::size_t mCount;
+
+			Vec2f mLocal[kLocalCount];
+			std::unique_ptr<Vec2f[]> mHeap;
+			Vec2f* mVerts = mLocal;
+	};
+
+	/* Outlines of the most recently stroked line strips
+	 *
+	 * Entries are looked up by the strip's address and replaced least
+	 * recently used first. The address only picks the entry: StrokeMesh
+	 * compares the vertices and transform by value, so a reused address, or
+	 * a strip that moved, at worst causes a rebuild.
+	 */
+	struct StrokeCacheEntry_
+	{
+		LineStrip const* owner = nullptr;
+		std::uint64_t lastUse = 0;
+		StrokeMesh mesh;
+	};
+
+	constexpr std::size_t kStrokeCacheSize_ = 8;
+
+	StrokeMesh& cached_stroke_( LineStrip const* aOwner )
+	{
+		thread_local StrokeCacheEntry_ cache[kStrokeCacheSize_];
+		thread_local std::uint64_t useCount = 0;
+
+		auto* entry = std::find_if( std::begin( cache ), std::end( cache ), [&] (StrokeCacheEntry_ const& aEntry) {
+			return aOwner == aEntry.owner;
+		} );
+
+		if( std::end( cache ) == entry )
+		{
+			entry = std::min_element( std::begin( cache ), std::end( cache ), [] (StrokeCacheEntry_ const& aA, StrokeCacheEntry_ const& aB) {
+				return aA.lastUse < aB.lastUse;
+			} );
+			entry->owner = aOwner;
+		}
+
+		entry->lastUse = ++useCount;
+		return entry->mesh;
+	}
+}
+
 LineStrip::LineStrip( std::size_t aCount, Vec2f const* aVerts )
 	: mCount( aCount )
 	, mVertices( nullptr )
@@ -39,13 +130,27 @@ void LineStrip::draw( Surface& aSurface, ColorF const& aColor, Mat22f const& aRo
 {
 	ColorU8_sRGB const color = linear_to_srgb( aColor );
 
-	Vec2f previous = aRotation * mVertices[0] + aTranslation;
+	if( StrokeStyle const& stroke = line_strip_stroke(); stroke.width > 1.f )
+	{
+		StrokeMesh& mesh = cached_stroke_( this );
+		mesh.update( mCount, mVertices, aRotation, aTranslation, stroke );
+		mesh.draw( aSurface, color );
+		return;
+	}
 
-	for( std::size_t i = 1; i < mCount; ++i )
+	TransformedVertices_ const verts( mCount, mVertices, aRotation, aTranslation );
+	if( verts.outside( aSurface ) )
+		return;
+
+	if( ELineStyle::antialiased == line_strip_style() )
 	{
-		Vec2f const current = aRotation * mVertices[i] + aTranslation;
-		draw_line_solid( aSurface, previous, current, color );
-		previous = current;
+		for( std::size_t i = 1; i < mCount; ++i )
+			draw_line_aa( aSurface, verts[i-1], verts[i], color );
+	}
+	else
+	{
+		for( std::size_t i = 1; i < mCount; ++i )
+			draw_line_solid( aSurface, verts[i-1], verts[i], color );
 	}
 }
 
@@ -105,21 +210,15 @@ TriangleFan& TriangleFan::operator= (TriangleFan&& aOther)  noexcept
 
 void TriangleFan::draw( Surface& aSurface, Mat22f const& aRotation, Vec2f const& aTranslation ) const
 {
-	Vec2f const center = aRotation * mVertices[0] + aTranslation;
+	TransformedVertices_ const verts( mCount, mVertices, aRotation, aTranslation );
+	if( verts.outside( aSurface ) )
+		return;
+
+	Vec2f const center = verts[0];
 	ColorF const cencol = mColors[0];
 
-	Vec2f previous = aRotation * mVertices[1] + aTranslation;
-	ColorF pcol = mColors[1];
 	for( std::size_t i = 2; i < mCount; ++i )
-	{
-		Vec2f const current = aRotation * mVertices[i] + aTranslation;
-		ColorF const curcol = mColors[i];
-		draw_triangle_interp( aSurface, center, previous, current, cencol, pcol, curcol );
-		previous = current;
-		pcol = curcol;
-	}
+		draw_triangle_interp( aSurface, center, verts[i-1], verts[i], cencol, mColors[i-1], mColors[i] );
 
-	Vec2f const first = aRotation * mVertices[1] + aTranslation;
-	ColorF const fcol = mColors[1];
-	draw_triangle_interp( aSurface, center, previous, first, cencol, pcol, fcol );
+	draw_triangle_interp( aSurface, center, verts[mCount-1], verts[1], cencol, mColors[mCount-1], mColors[1] );
 }
@@ -61,6 +61,7 @@ class LineStrip final
 		void draw( Surface&, ColorF const&, Mat22f const&, Vec2f const& ) const;
 
 		std::size_t vertex_count() const noexcept { return mCount; }
+		Vec2f const* vertices() const noexcept { return mVertices; }
 
 	private:
 		std::size_t mCount;
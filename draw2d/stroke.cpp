@@ -0,0 +1,257 @@
+#include "stroke.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <cmath>
+
+#include "draw.hpp"
+#include "surface.hpp"
+
+namespace
+{
+	StrokeStyle gLineStripStroke_;
+
+	// Consecutive points closer than this (in pixels) are merged.
+	constexpr float kMinSegmentLength_ = 1e-4f;
+
+	// Turns sharper than this (|n0 + n1|^2, with n0/n1 the unit normals of
+	// the two segments) are treated as a reversal of direction.
+	constexpr float kMinNormalSum2_ = 1e-6f;
+
+	constexpr
+	Vec2f perp_( Vec2f aVec ) noexcept
+	{
+		return { -aVec.y, aVec.x };
+	}
+
+	constexpr
+	float cross_( Vec2f aLeft, Vec2f aRight ) noexcept
+	{
+		return aLeft.x * aRight.y - aLeft.y * aRight.x;
+	}
+
+	class MeshBuilder_
+	{
+		public:
+			MeshBuilder_( std::vector<Vec2f>& aVertices, std::vector<std::uint32_t>& aIndices ) noexcept
+				: mVertices( aVertices )
+				, mIndices( aIndices )
+			{}
+
+			std::uint32_t vertex( Vec2f aPos )
+			{
+				mVertices.emplace_back( aPos );
+				return std::uint32_t(mVertices.size()-1);
+			}
+
+			void triangle( std::uint32_t aA, std::uint32_t aB, std::uint32_t aC )
+			{
+				mIndices.insert( mIndices.end(), { aA, aB, aC } );
+			}
+
+			// Quad with the corners (left,right) at the start and at the end.
+			// Both triangles use the same diagonal.
+			void quad( std::uint32_t aL0, std::uint32_t aR0, std::uint32_t aL1, std::uint32_t aR1 )
+			{
+				triangle( aL0, aR0, aR1 );
+				triangle( aL0, aR1, aL1 );
+			}
+
+		private:
+			std::vector<Vec2f>& mVertices;
+			std::vector<std::uint32_t>& mIndices;
+	};
+
+	/* Build the outline of the polyline aPoints. Consecutive points must be
+	 * distinct (see kMinSegmentLength_).
+	 *
+	 * "Left" is the side of the segment's normal perp_(direction). Each
+	 * segment is a quad from the (left,right) corners at its start to those
+	 * at its end. At a miter join, both segments use the same two corners:
+	 * the points where the offset lines meet. At a bevel join, they share
+	 * only the inner corner; the two outer corners and the inner corner form
+	 * the bevel triangle.
+	 */
+	void build_outline_( std::vector<Vec2f> const& aPoints, StrokeStyle const& aStyle, std::vector<Vec2f>& aVertices, std::vector<std::uint32_t>& aIndices )
+	{
+		std::size_t const count = aPoints.size();
+		if( count < 2 )
+			return;
+
+		float const halfWidth = 0.5f * aStyle.width;
+		float const miterLimit2 = aStyle.miterLimit * aStyle.miterLimit;
+
+		MeshBuilder_ mesh( aVertices, aIndices );
+
+		auto const segment = [&] (std::size_t aI, float& aLength) {
+			Vec2f const delta = aPoints[aI+1] - aPoints[aI];
+			aLength = length( delta );
+			return delta / aLength;
+		};
+
+		float len0;
+		Vec2f dir0 = segment( 0, len0 );
+
+		std::uint32_t left = mesh.vertex( aPoints[0] + halfWidth * perp_( dir0 ) );
+		std::uint32_t right = mesh.vertex( aPoints[0] - halfWidth * perp_( dir0 ) );
+
+		for( std::size_t j = 1; j+1 < count; ++j )
+		{
+			float len1;
+			Vec2f const dir1 = segment( j, len1 );
+
+			Vec2f const p = aPoints[j];
+			Vec2f const n0 = perp_( dir0 ), n1 = perp_( dir1 );
+
+			// The left offset lines of the two segments meet at p + m, the
+			// right ones at p - m. With s = n0 + n1, m = s * halfWidth /
+			// (1 + n0.n1) = s * 2*halfWidth / |s|^2. The miter length
+			// relative to the half width is |m| / halfWidth = 2 / |s|.
+			Vec2f const sum = n0 + n1;
+			float const sum2 = dot( sum, sum );
+			bool const reversal = sum2 < kMinNormalSum2_;
+
+			Vec2f const m = reversal ? Vec2f{ 0.f, 0.f } : sum * (2.f * halfWidth / sum2);
+
+			// Turning towards the left makes the left side the inside. The
+			// inner corner is only usable if it lies within both segments.
+			bool const leftInside = cross_( dir0, dir1 ) > 0.f;
+			bool const innerValid = !reversal && std::abs( dot( m, dir0 ) ) <= std::min( len0, len1 );
+
+			if( EJoin::miter == aStyle.join && !reversal && 4.f <= miterLimit2 * sum2 )
+			{
+				Vec2f l = p + m, r = p - m;
+				if( !innerValid )
+					(leftInside ? l : r) = p;
+
+				std::uint32_t const l1 = mesh.vertex( l );
+				std::uint32_t const r1 = mesh.vertex( r );
+				mesh.quad( left, right, l1, r1 );
+
+				left = l1;
+				right = r1;
+			}
+			else if( leftInside )
+			{
+				std::uint32_t const inner = mesh.vertex( innerValid ? p + m : p );
+				std::uint32_t const outer0 = mesh.vertex( p - halfWidth * n0 );
+				std::uint32_t const outer1 = mesh.vertex( p - halfWidth * n1 );
+
+				mesh.quad( left, right, inner, outer0 );
+				mesh.triangle( inner, outer0, outer1 );
+
+				left = inner;
+				right = outer1;
+			}
+			else
+			{
+				std::uint32_t const inner = mesh.vertex( innerValid ? p - m : p );
+				std::uint32_t const outer0 = mesh.vertex( p + halfWidth * n0 );
+				std::uint32_t const outer1 = mesh.vertex( p + halfWidth * n1 );
+
+				mesh.quad( left, right, outer0, inner );
+				mesh.triangle( outer0, inner, outer1 );
+
+				left = outer1;
+				right = inner;
+			}
+
+			dir0 = dir1;
+			len0 = len1;
+		}
+
+		Vec2f const last = aPoints[count-1];
+		std::uint32_t const l1 = mesh.vertex( last + halfWidth * perp_( dir0 ) );
+		std::uint32_t const r1 = mesh.vertex( last - halfWidth * perp_( dir0 ) );
+		mesh.quad( left, right, l1, r1 );
+	}
+}
+
+bool StrokeMesh::update( std::size_t aCount, Vec2f const* aPoints, Mat22f const& aRotation, Vec2f const& aTranslation, StrokeStyle const& aStyle )
+{
+	if( mValid && matches_( aCount, aPoints, aRotation, aTranslation, aStyle ) )
+		return false;
+
+	mKeyPoints.assign( aPoints, aPoints + aCount );
+	mKeyRotation = aRotation;
+	mKeyTranslation = aTranslation;
+	mKeyStyle = aStyle;
+
+	// Transform, and drop points that coincide with their predecessor.
+	mPoints.resize( aCount );
+	transform_points( aCount, aPoints, aRotation, aTranslation, mPoints.data() );
+
+	auto const end = std::unique( mPoints.begin(), mPoints.end(), [] (Vec2f aA, Vec2f aB) {
+		return length( aB - aA ) < kMinSegmentLength_;
+	} );
+	mPoints.erase( end, mPoints.end() );
+
+	mVertices.clear();
+	mIndices.clear();
+	build_outline_( mPoints, aStyle, mVertices, mIndices );
+
+	mBounds = bounding_box( mVertices.size(), mVertices.data() );
+	mValid = true;
+	return true;
+}
+
+void StrokeMesh::draw( Surface& aSurface, ColorU8_sRGB aColor ) const
+{
+	if( mBounds.max.x < 0.f || mBounds.max.y < 0.f
+		|| mBounds.min.x > float(aSurface.get_width())
+		|| mBounds.min.y > float(aSurface.get_height())
+	)
+	{
+		return;
+	}
+
+	for( std::size_t i = 0; i+2 < mIndices.size(); i += 3 )
+	{
+		draw_triangle_solid( aSurface,
+			mVertices[mIndices[i+0]], mVertices[mIndices[i+1]], mVertices[mIndices[i+2]],
+			aColor
+		);
+	}
+}
+
+bool StrokeMesh::matches_( std::size_t aCount, Vec2f const* aPoints, Mat22f const& aRotation, Vec2f const& aTranslation, StrokeStyle const& aStyle ) const noexcept
+{
+	if( aCount != mKeyPoints.size() )
+		return false;
+
+	if( aRotation._00 != mKeyRotation._00 || aRotation._01 != mKeyRotation._01
+		|| aRotation._10 != mKeyRotation._10 || aRotation._11 != mKeyRotation._11
+	)
+	{
+		return false;
+	}
+
+	if( aTranslation.x != mKeyTranslation.x || aTranslation.y != mKeyTranslation.y )
+		return false;
+
+	if( aStyle.width != mKeyStyle.width || aStyle.join != mKeyStyle.join || aStyle.miterLimit != mKeyStyle.miterLimit )
+		return false;
+
+	return std::equal( aPoints, aPoints + aCount, mKeyPoints.begin(), [] (Vec2f aA, Vec2f aB) {
+		return aA.x == aB.x && aA.y == aB.y;
+	} );
+}
+
+
+void draw_stroke( Surface& aSurface, std::size_t aCount, Vec2f const* aPoints, StrokeStyle const& aStyle, ColorU8_sRGB aColor )
+{
+	thread_local StrokeMesh mesh;
+	mesh.update( aCount, aPoints, Mat22f{ 1.f, 0.f, 0.f, 1.f }, Vec2f{ 0.f, 0.f }, aStyle );
+	mesh.draw( aSurface, aColor );
+}
+
+
+void set_line_strip_stroke( StrokeStyle const& aStyle ) noexcept
+{
+	gLineStripStroke_ = aStyle;
+}
+StrokeStyle const& line_strip_stroke() noexcept
+{
+	return gLineStripStroke_;
+}
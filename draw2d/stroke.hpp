@@ -0,0 +1,105 @@
+#ifndef STROKE_HPP_22E4C3DE_8D61_40C6_B3DD_DD967618C956
+#define STROKE_HPP_22E4C3DE_8D61_40C6_B3DD_DD967618C956
+
+#include <span>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "forward.hpp"
+#include "color.hpp"
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/mat22.hpp"
+#include "../vmlib/vec2_batch.hpp"
+
+/* Thick lines
+ *
+ * A polyline is stroked by offsetting each segment by half the width to
+ * either side. Consecutive segments are joined with either a miter (the
+ * offset lines are extended until they meet) or a bevel (the gap on the
+ * outside of the turn is closed with a single triangle). Miters that would be
+ * longer than miterLimit times the half width fall back to a bevel. Ends are
+ * cut off flat (butt caps).
+ *
+ * The outline is built as a triangle mesh in which neighbouring triangles
+ * share their vertices exactly. Drawn with draw_triangle_solid(), the mesh is
+ * therefore watertight, and every pixel of it, including those in the joins,
+ * is filled exactly once. (Exception: at turns that are so sharp that the
+ * inner offset lines meet beyond the end of one of the segments, the inner
+ * corner is pinned to the joint. The two segments then overlap slightly on
+ * the inside of the turn.)
+ */
+enum class EJoin
+{
+	miter,
+	bevel
+};
+
+struct StrokeStyle
+{
+	float width = 1.f;
+	EJoin join = EJoin::miter;
+	float miterLimit = 4.f;
+};
+
+/** StrokeMesh : cached outline of a stroked polyline
+ *
+ * update() rebuilds the outline only if the polyline, its transform or the
+ * style differ from those of the previous update() (the inputs are compared
+ * by value). Drawing an unchanged stroke thus costs just the rasterization.
+ */
+class StrokeMesh
+{
+	public:
+		/* Points are transformed as with LineStrip::draw(), i.e.,
+		 * aRotation * point + aTranslation, before stroking. The width is
+		 * thus in pixels. Returns true if the outline was rebuilt.
+		 */
+		bool update( std::size_t aCount, Vec2f const* aPoints, Mat22f const& aRotation, Vec2f const& aTranslation, StrokeStyle const& );
+
+		void draw( Surface&, ColorU8_sRGB ) const;
+
+		std::span<Vec2f const> vertices() const noexcept { return mVertices; }
+		std::span<std::uint32_t const> indices() const noexcept { return mIndices; } // three per triangle
+
+	private:
+		bool matches_( std::size_t, Vec2f const*, Mat22f const&, Vec2f const&, StrokeStyle const& ) const noexcept;
+
+	private:
+		bool mValid = false;
+		std::vector<Vec2f> mKeyPoints;
+		Mat22f mKeyRotation{};
+		Vec2f mKeyTranslation{};
+		StrokeStyle mKeyStyle{};
+
+		std::vector<Vec2f> mPoints; // transformed; kept to reuse the storage
+
+		std::vector<Vec2f> mVertices;
+		std::vector<std::uint32_t> mIndices;
+		Box2f mBounds{}; // of mVertices
+};
+
+/* Stroke a polyline. aPoints are in pixels. The outline is built in storage
+ * that is reused between calls (per thread), so this does not allocate once
+ * earlier outlines were as large.
+ */
+void draw_stroke(
+	Surface&,
+	std::size_t aCount, Vec2f const* aPoints,
+	StrokeStyle const&,
+	ColorU8_sRGB
+);
+
+/* Stroke used by LineStrip::draw()
+ *
+ * Like the line style (see draw-aa.hpp), this is a global setting. Widths of
+ * one pixel or less draw 1 px lines with the current line style; wider ones
+ * draw a stroke. LineStrip::draw() keeps the outlines of the most recently
+ * drawn strips in a small cache, keyed by the strip.
+ */
+void set_line_strip_stroke( StrokeStyle const& ) noexcept;
+StrokeStyle const& line_strip_stroke() noexcept;
+
+#endif // STROKE_HPP_22E4C3DE_8D61_40C6_B3DD_DD967618C956
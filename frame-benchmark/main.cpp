@@ -0,0 +1,249 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <cmath>
+
+#include "../draw2d/shape.hpp"
+#include "../draw2d/surface-ex.hpp"
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/mat22.hpp"
+#include "../vmlib/vec2_batch.hpp"
+
+#include "../main/defaults.hpp"
+#include "../main/spaceship.hpp"
+#include "../main/background.hpp"
+#include "../main/asteroid_field.hpp"
+#include "../main/collision_grid.hpp"
+
+#include "../support/benchmark_main.hpp"
+#include "../support/frame_arena.hpp"
+#include "../support/thread_pool.hpp"
+#include "../support/perf_counters_benchmark.hpp"
+
+namespace
+{
+	// Fixed seed, such that each run sees the same scene.
+	constexpr RNG::result_type kSeed = 3811;
+
+	// Simulated frame: 60 Hz with the player drifting diagonally. This is
+	// enough to exercise the particle wrap-around and asteroid respawns.
+	constexpr float kFrameDt = 1.f / 60.f;
+	constexpr Vec2f kPlayerVelocity{ 150.f, 80.f };
+	constexpr float kPlayerAngularVelocity = 0.5f;
+
+	using Clock_ = std::chrono::steady_clock;
+
+	double elapsed_us_( Clock_::time_point aBegin, Clock_::time_point aEnd )
+	{
+		return std::chrono::duration<double, std::micro>( aEnd - aBegin ).count();
+	}
+
+	// Full frame: update + draw of the complete scene, as in main/main.cpp
+	// (minus the upload to OpenGL). Arguments: width, height, asteroid
+	// density in asteroids per million square pixels, and whether asteroids
+	// are drawn with impostors (see AsteroidField::set_impostors()).
+	void frame_benchmark_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const density = float(aState.range(2)) * 1e-6f;
+
+		RNG rng( kSeed );
+
+		SurfaceEx surface( width, height );
+		surface.clear();
+
+		Background background( rng, width, height );
+		AsteroidField asteroids( rng, width, height, density );
+		asteroids.set_impostors( 0 != aState.range(3) );
+
+		auto const spaceship = make_spaceship_shape();
+
+		Vec2f position{ 0.f, 0.f };
+		float angle = 0.f;
+
+		double updateUs = 0.0, clearUs = 0.0, backgroundUs = 0.0;
+		double asteroidsUs = 0.0, spaceshipUs = 0.0;
+
+		PerfCounters perf;
+		perf.start();
+
+		for( auto _ : aState )
+		{
+			frame_arena().reset();
+
+			auto const t0 = Clock_::now();
+
+			// Update
+			Vec2f const movement = kPlayerVelocity * kFrameDt;
+			position += movement;
+			angle += kPlayerAngularVelocity * kFrameDt;
+
+			background.update( position, movement );
+			asteroids.update( kFrameDt, movement );
+
+			auto const t1 = Clock_::now();
+
+			// Draw
+			surface.clear();
+			auto const t2 = Clock_::now();
+
+			background.draw( surface );
+			auto const t3 = Clock_::now();
+
+			asteroids.draw( surface );
+			auto const t4 = Clock_::now();
+
+			auto const rot = make_rotation_2d( angle );
+			auto const offs = Vec2f{ width*0.5f, height*0.5f };
+			spaceship.draw( surface, { 0.2f, 0.4f, 0.7f }, rot, offs );
+
+			benchmark::ClobberMemory();
+			auto const t5 = Clock_::now();
+
+			updateUs += elapsed_us_( t0, t1 );
+			clearUs += elapsed_us_( t1, t2 );
+			backgroundUs += elapsed_us_( t2, t3 );
+			asteroidsUs += elapsed_us_( t3, t4 );
+			spaceshipUs += elapsed_us_( t4, t5 );
+		}
+
+		perf.stop();
+
+		using Counter_ = benchmark::Counter;
+		aState.counters["fps"] = Counter_( double(aState.iterations()), Counter_::kIsRate );
+		aState.counters["update_us"] = Counter_( updateUs, Counter_::kAvgIterations );
+		aState.counters["clear_us"] = Counter_( clearUs, Counter_::kAvgIterations );
+		aState.counters["background_us"] = Counter_( backgroundUs, Counter_::kAvgIterations );
+		aState.counters["asteroids_us"] = Counter_( asteroidsUs, Counter_::kAvgIterations );
+		aState.counters["spaceship_us"] = Counter_( spaceshipUs, Counter_::kAvgIterations );
+		aState.counters["arena_peak_kib"] = double(frame_arena().peak()) / 1024.0;
+
+		// Whether the impostors were still on at the end (the asteroids turn
+		// them off if they do not pay off).
+		aState.counters["impostors_on"] = asteroids.impostors() ? 1.0 : 0.0;
+
+		aState.SetBytesProcessed( std::int64_t(width)*height*4 * aState.iterations() );
+
+		// Per pixel of the framebuffer (not per pixel written).
+		report_perf_counters( aState, perf, double(width)*height );
+	}
+
+	// Collision queries: aState.range(0) asteroid-sized bodies (radii 20 to
+	// 45 pixels) at 50 asteroids per million square pixels, moving as in the
+	// asteroid field. Each iteration updates the grid, queries the bodies
+	// that overlap the spaceship, and finds all overlapping pairs with
+	// for_each_pair_parallel(); only these are timed. range(1) is the pool's
+	// thread count (0 = all cores).
+	void collisions_benchmark_( benchmark::State& aState )
+	{
+		auto const count = std::size_t(aState.range(0));
+		float const extent = std::sqrt( float(count) / 50e-6f );
+
+		RNG rng( kSeed );
+		std::uniform_real_distribution<float> position( 0.f, extent );
+		std::uniform_real_distribution<float> radius( 20.f, 45.f );
+		std::normal_distribution<float> velocity( 0.f, 100.f );
+
+		Vec2fBatch positions, velocities;
+		positions.resize( count );
+		velocities.resize( count );
+
+		std::vector<float> radii( count );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			positions.set( i, Vec2f{ position( rng ), position( rng ) } );
+			velocities.set( i, Vec2f{ velocity( rng ), velocity( rng ) } );
+			radii[i] = radius( rng );
+		}
+
+		CollisionGrid grid;
+		grid.update( positions, radii );
+
+		ThreadPool pool( unsigned(aState.range(1)) );
+		set_executor( &pool );
+
+		Vec2f const ship{ extent*0.5f, extent*0.5f };
+		constexpr float kShipRadius = 40.f;
+
+		double updateUs = 0.0, queryUs = 0.0, pairsUs = 0.0;
+		std::size_t hits = 0;
+		std::atomic<std::size_t> pairs{ 0 };
+
+		for( auto _ : aState )
+		{
+			// Bodies that leave the area re-enter on the opposite side, so
+			// that the density stays the same.
+			Vec2f const movement = kPlayerVelocity * kFrameDt;
+			add_scaled( positions, velocities, kFrameDt, -movement );
+
+			for( std::size_t i = 0; i < count; ++i )
+			{
+				positions.x[i] -= extent * std::floor( positions.x[i] / extent );
+				positions.y[i] -= extent * std::floor( positions.y[i] / extent );
+			}
+
+			auto const t0 = Clock_::now();
+
+			grid.translate( -movement );
+			grid.update( positions, radii );
+			auto const t1 = Clock_::now();
+
+			grid.for_each_overlap( ship, kShipRadius, [&] (std::uint32_t) { ++hits; } );
+			auto const t2 = Clock_::now();
+
+			grid.for_each_pair_parallel( [&] (std::uint32_t const*, std::uint32_t const*, std::size_t aCount) {
+				pairs.fetch_add( aCount, std::memory_order_relaxed );
+			} );
+			auto const t3 = Clock_::now();
+
+			benchmark::DoNotOptimize( hits );
+
+			updateUs += elapsed_us_( t0, t1 );
+			queryUs += elapsed_us_( t1, t2 );
+			pairsUs += elapsed_us_( t2, t3 );
+		}
+
+		using Counter_ = benchmark::Counter;
+		aState.counters["update_us"] = Counter_( updateUs, Counter_::kAvgIterations );
+		aState.counters["query_us"] = Counter_( queryUs, Counter_::kAvgIterations );
+		aState.counters["pairs_us"] = Counter_( pairsUs, Counter_::kAvgIterations );
+		aState.counters["pairs"] = Counter_( double(pairs.load()), Counter_::kAvgIterations );
+	}
+}
+
+BENCHMARK( frame_benchmark_ )
+	->ArgsProduct( {
+		{ 1280 }, { 720 },
+		{ 10, 50, 200 }, // default density is 10 asteroids/Mpx
+		{ 0, 1 }
+	} )
+	->ArgsProduct( {
+		{ 1920 }, { 1080 },
+		{ 10, 50, 200 },
+		{ 0 }
+	} )
+	->ArgsProduct( {
+		{ 3840 }, { 2160 },
+		{ 10, 50, 200 },
+		{ 0, 1 }
+	} )
+	->ArgNames( { "w", "h", "density", "impostors" } )
+	->UseRealTime()
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( collisions_benchmark_ )
+	->ArgsProduct( {
+		{ 1000, 10000, 50000 },
+		{ 1, 0 }
+	} )
+	->ArgNames( { "bodies", "threads" } )
+	->UseRealTime()
+	->Unit( benchmark::kMicrosecond );
+
+COMP3811_BENCHMARK_MAIN();
@@ -1,10 +1,19 @@
 #include <benchmark/benchmark.h>
+#include <random>
 #include <cmath>
 
 #include "../draw2d/draw.hpp"
 #include "../draw2d/draw-ex.hpp"
+#include "../draw2d/draw-aa.hpp"
+#include "../draw2d/draw-batch.hpp"
+#include "../draw2d/clip-batch.hpp"
+#include "../draw2d/parallel.hpp"
 #include "../draw2d/surface-ex.hpp"
 
+#include "../support/benchmark_main.hpp"
+#include "../support/perf_counters_benchmark.hpp"
+#include "../support/thread_pool.hpp"
+
 namespace
 {
 	// Benchmark DDA algorithm (floating-point)
@@ -23,14 +32,21 @@ namespace
 		Vec2f begin{ 10.f, 10.f };
 		Vec2f end{ 10.f + lineLength, 10.f + lineLength };
 
+		PerfCounters perf;
+		perf.start();
+
 		for( auto _ : aState )
 		{
 			draw_ex_line_solid( surface, begin, end, color );
 			benchmark::ClobberMemory(); 
 		}
 
+		perf.stop();
+
 		// Set bytes processed: approximately lineLength pixels * 4 bytes per pixel
 		aState.SetBytesProcessed( lineLength * 4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(lineLength) );
 	}
 
 	// Benchmark Bresenham algorithm (integer-only)
@@ -48,13 +64,166 @@ namespace
 		Vec2f begin{ 10.f, 10.f };
 		Vec2f end{ 10.f + lineLength, 10.f + lineLength };
 
+		PerfCounters perf;
+		perf.start();
+
 		for( auto _ : aState )
 		{
 			draw_ex_line_bresenham( surface, begin, end, color );
 			benchmark::ClobberMemory(); 
 		}
 
+		perf.stop();
+
+		aState.SetBytesProcessed( lineLength * 4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(lineLength) );
+	}
+
+	// Benchmark anti-aliased lines (Xiaolin Wu). Each step blends two
+	// pixels; compare with benchmark_bresenham_.
+	void benchmark_aa_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const lineLength = std::uint32_t(aState.range(2));
+
+		SurfaceEx surface( width, height );
+		surface.clear();
+
+		ColorU8_sRGB color{ 255, 255, 255 };
+
+		// Slightly off the diagonal, so that coverage varies along the line.
+		Vec2f begin{ 10.f, 10.f };
+		Vec2f end{ 10.f + lineLength, 10.f + lineLength * 0.9f };
+
+		PerfCounters perf;
+		perf.start();
+
+		for( auto _ : aState )
+		{
+			draw_line_aa( surface, begin, end, color );
+			benchmark::ClobberMemory(); 
+		}
+
+		perf.stop();
+
 		aState.SetBytesProcessed( lineLength * 4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(lineLength) );
+	}
+
+	// Many short segments in random directions, as in debug overlays and
+	// trajectory traces. A few percent extend past the surface's edges.
+	LineBatch make_trace_batch_( std::uint32_t aWidth, std::uint32_t aHeight, std::size_t aCount, float aMaxOffset = 30.f )
+	{
+		std::minstd_rand rng( 3811 );
+		std::uniform_real_distribution<float> xs( -20.f, aWidth + 20.f ), ys( -20.f, aHeight + 20.f );
+		std::uniform_real_distribution<float> offset( -aMaxOffset, aMaxOffset );
+
+		LineBatch batch;
+		batch.reserve( aCount );
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			Vec2f const begin{ xs( rng ), ys( rng ) };
+			batch.push_back( begin, begin + Vec2f{ offset( rng ), offset( rng ) }, { 255, 255, 255 } );
+		}
+
+		return batch;
+	}
+
+	// Baseline for benchmark_lines_batch_: draw_line_solid() per segment.
+	void benchmark_lines_sequential_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const count = std::size_t(aState.range(2));
+
+		SurfaceEx surface( width, height );
+		surface.clear();
+
+		auto const batch = make_trace_batch_( width, height, count );
+
+		for( auto _ : aState )
+		{
+			for( std::size_t i = 0; i < count; ++i )
+				draw_line_solid( surface, { batch.x0[i], batch.y0[i] }, { batch.x1[i], batch.y1[i] }, batch.color[i] );
+
+			benchmark::ClobberMemory(); 
+		}
+
+		aState.SetItemsProcessed( count * aState.iterations() );
+	}
+
+	// draw_lines_batch(); range(3) is the pool's thread count (0 = all cores).
+	void benchmark_lines_batch_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const count = std::size_t(aState.range(2));
+		auto const threads = unsigned(aState.range(3));
+
+		SurfaceEx surface( width, height );
+		surface.clear();
+
+		auto const batch = make_trace_batch_( width, height, count );
+
+		// Threads are started once, as in the application.
+		ThreadPool pool( threads );
+		set_executor( &pool );
+
+		for( auto _ : aState )
+		{
+			draw_lines_batch( surface, batch );
+			benchmark::ClobberMemory(); 
+		}
+
+		aState.SetItemsProcessed( count * aState.iterations() );
+	}
+
+	// Clipping only: clip_line() per segment vs clip_lines(). Segments are
+	// longer than in traces, so that more of them cross the surface edges.
+	void benchmark_clip_line_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const count = std::size_t(aState.range(2));
+
+		Rect2F const area{ 0.f, 0.f, float(width), float(height) };
+		auto const batch = make_trace_batch_( width, height, count, 200.f );
+
+		for( auto _ : aState )
+		{
+			std::size_t visible = 0;
+			for( std::size_t i = 0; i < count; ++i )
+			{
+				Vec2f begin{ batch.x0[i], batch.y0[i] }, end{ batch.x1[i], batch.y1[i] };
+				if( clip_line( area, begin, end ) )
+					++visible;
+			}
+
+			benchmark::DoNotOptimize( visible );
+		}
+
+		aState.SetItemsProcessed( count * aState.iterations() );
+	}
+	void benchmark_clip_lines_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const count = std::size_t(aState.range(2));
+
+		Rect2F const area{ 0.f, 0.f, float(width), float(height) };
+		auto const batch = make_trace_batch_( width, height, count, 200.f );
+
+		ClippedLines clipped;
+		for( auto _ : aState )
+		{
+			clip_lines( area, batch, clipped );
+			benchmark::DoNotOptimize( clipped.x0.data() );
+		}
+
+		aState.SetItemsProcessed( count * aState.iterations() );
 	}
 
 	// Benchmark diagonal baseline (optimal case)
@@ -72,13 +241,20 @@ namespace
 		Vec2f begin{ 10.f, 10.f };
 		float steps = static_cast<float>(lineLength);
 
+		PerfCounters perf;
+		perf.start();
+
 		for( auto _ : aState )
 		{
 			draw_ex_diagonal( surface, begin, steps, color );
 			benchmark::ClobberMemory(); 
 		}
 
+		perf.stop();
+
 		aState.SetBytesProcessed( lineLength * 4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(lineLength) );
 	}
 
 	// Benchmark horizontal lines
@@ -96,13 +272,20 @@ namespace
 		Vec2f begin{ 10.f, 100.f };
 		Vec2f end{ 10.f + lineLength, 100.f };
 
+		PerfCounters perf;
+		perf.start();
+
 		for( auto _ : aState )
 		{
 			draw_ex_line_solid( surface, begin, end, color );
 			benchmark::ClobberMemory(); 
 		}
 
+		perf.stop();
+
 		aState.SetBytesProcessed( lineLength * 4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(lineLength) );
 	}
 
 	void benchmark_bresenham_horizontal_( benchmark::State& aState )
@@ -119,34 +302,48 @@ namespace
 		Vec2f begin{ 10.f, 100.f };
 		Vec2f end{ 10.f + lineLength, 100.f };
 
+		PerfCounters perf;
+		perf.start();
+
 		for( auto _ : aState )
 		{
 			draw_ex_line_bresenham( surface, begin, end, color );
 			benchmark::ClobberMemory(); 
 		}
 
+		perf.stop();
+
 		aState.SetBytesProcessed( lineLength * 4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(lineLength) );
 	}
 }
 
 // Benchmark diagonal lines of varying lengths
 BENCHMARK( benchmark_dda_ )
 	->ArgsProduct({
-		{1920, 1080},      // Surface size
+		{1920}, {1080},    // Surface size
 		{100, 500, 1000, 2000, 5000}  // Line lengths
 	})
 	->Unit( benchmark::kNanosecond );
 
 BENCHMARK( benchmark_bresenham_ )
 	->ArgsProduct({
-		{1920, 1080},
+		{1920}, {1080},
+		{100, 500, 1000, 2000, 5000}
+	})
+	->Unit( benchmark::kNanosecond );
+
+BENCHMARK( benchmark_aa_ )
+	->ArgsProduct({
+		{1920}, {1080},
 		{100, 500, 1000, 2000, 5000}
 	})
 	->Unit( benchmark::kNanosecond );
 
 BENCHMARK( benchmark_diagonal_ )
 	->ArgsProduct({
-		{1920, 1080},
+		{1920}, {1080},
 		{100, 500, 1000, 2000, 5000}
 	})
 	->Unit( benchmark::kNanosecond );
@@ -154,16 +351,48 @@ BENCHMARK( benchmark_diagonal_ )
 // Benchmark horizontal lines (special case)
 BENCHMARK( benchmark_dda_horizontal_ )
 	->ArgsProduct({
-		{1920, 1080},
+		{1920}, {1080},
 		{100, 500, 1000, 2000, 5000}
 	})
 	->Unit( benchmark::kNanosecond );
 
 BENCHMARK( benchmark_bresenham_horizontal_ )
 	->ArgsProduct({
-		{1920, 1080},
+		{1920}, {1080},
 		{100, 500, 1000, 2000, 5000}
 	})
 	->Unit( benchmark::kNanosecond );
 
-BENCHMARK_MAIN();
+// Clipping batches of segments
+BENCHMARK( benchmark_clip_line_ )
+	->ArgsProduct({
+		{1920}, {1080},
+		{10000, 50000}
+	})
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_clip_lines_ )
+	->ArgsProduct({
+		{1920}, {1080},
+		{10000, 50000}
+	})
+	->Unit( benchmark::kMicrosecond );
+
+// Batches of segments
+BENCHMARK( benchmark_lines_sequential_ )
+	->ArgsProduct({
+		{1920}, {1080},
+		{10000, 50000}    // Segments
+	})
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_lines_batch_ )
+	->ArgsProduct({
+		{1920}, {1080},
+		{10000, 50000},
+		{1, 0}            // Threads
+	})
+	->Unit( benchmark::kMicrosecond )
+	->UseRealTime();
+
+COMP3811_BENCHMARK_MAIN();
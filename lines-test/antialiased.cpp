@@ -0,0 +1,113 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cstdint>
+
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+#include "../draw2d/draw-aa.hpp"
+#include "../draw2d/color.hpp"
+
+namespace
+{
+	float linear_at_( Surface const& aSurface, std::uint32_t aX, std::uint32_t aY )
+	{
+		auto const* ptr = aSurface.get_surface_ptr();
+		return linear_from_srgb( ptr[4*aSurface.get_linear_index( aX, aY )] );
+	}
+}
+
+TEST_CASE( "Anti-aliased lines", "[aa]" )
+{
+	Surface surface( 128, 128 );
+	surface.clear();
+
+	SECTION( "axis aligned through pixel centers" )
+	{
+		// Lines through pixel centers cover exactly one pixel per step, and
+		// thus the same pixels as draw_line_solid().
+		Surface solid( 128, 128 );
+		solid.clear();
+
+		draw_line_aa( surface, { 10.f, 47.f }, { 110.f, 47.f }, { 255, 255, 255 } );
+		draw_line_aa( surface, { 64.f, 20.f }, { 64.f, 100.f }, { 255, 255, 255 } );
+
+		draw_line_solid( solid, { 10.f, 47.f }, { 110.f, 47.f }, { 255, 255, 255 } );
+		draw_line_solid( solid, { 64.f, 20.f }, { 64.f, 100.f }, { 255, 255, 255 } );
+
+		// Endpoints are partially covered; skip them.
+		int mismatches = 0;
+		for( std::uint32_t y = 21; y < 100; ++y )
+		{
+			for( std::uint32_t x = 11; x < 110; ++x )
+			{
+				auto const i = 4*surface.get_linear_index( x, y );
+				if( surface.get_surface_ptr()[i] != solid.get_surface_ptr()[i] )
+					++mismatches;
+			}
+		}
+
+		REQUIRE( 0 == mismatches );
+	}
+
+	SECTION( "coverage sums to one" )
+	{
+		// The (linear) coverage of each column of an x-major line, and each
+		// row of a y-major line, sums to one away from the endpoints.
+		draw_line_aa( surface, { 5.3f, 10.2f }, { 120.7f, 51.9f }, { 255, 255, 255 } );
+
+		for( std::uint32_t x = 8; x < 118; ++x )
+		{
+			float sum = 0.f;
+			for( std::uint32_t y = 0; y < 64; ++y )
+				sum += linear_at_( surface, x, y );
+
+			REQUIRE_THAT( sum, Catch::Matchers::WithinAbs( 1.f, 0.02f ) );
+		}
+
+		surface.clear();
+		draw_line_aa( surface, { 90.4f, 3.6f }, { 70.1f, 124.2f }, { 255, 255, 255 } );
+
+		for( std::uint32_t y = 6; y < 122; ++y )
+		{
+			float sum = 0.f;
+			for( std::uint32_t x = 64; x < 96; ++x )
+				sum += linear_at_( surface, x, y );
+
+			REQUIRE_THAT( sum, Catch::Matchers::WithinAbs( 1.f, 0.02f ) );
+		}
+	}
+
+	SECTION( "blending with the background" )
+	{
+		// Full coverage replaces the background; no coverage leaves it alone.
+		surface.fill( { 200, 100, 50 } );
+		draw_line_aa( surface, { 10.f, 64.f }, { 110.f, 64.f }, { 0, 255, 0 } );
+
+		auto const* ptr = surface.get_surface_ptr();
+		auto const on = 4*surface.get_linear_index( 50, 64 );
+		auto const off = 4*surface.get_linear_index( 50, 65 );
+
+		REQUIRE( 0 == ptr[on+0] );
+		REQUIRE( 255 == ptr[on+1] );
+		REQUIRE( 0 == ptr[on+2] );
+
+		REQUIRE( 200 == ptr[off+0] );
+		REQUIRE( 100 == ptr[off+1] );
+		REQUIRE( 50 == ptr[off+2] );
+	}
+
+	SECTION( "partially outside" )
+	{
+		// Lines that run along and across the surface border must not
+		// write outside of the surface (set_pixel_srgb() would assert, but
+		// draw_line_aa() writes directly), and must still draw the visible
+		// part.
+		draw_line_aa( surface, { -50.f, -0.4f }, { 200.f, -0.4f }, { 255, 255, 255 } );
+		draw_line_aa( surface, { 127.3f, -30.f }, { 127.3f, 300.f }, { 255, 255, 255 } );
+		draw_line_aa( surface, { -1e6f, -1e6f }, { 1e6f, 1e6f }, { 255, 255, 255 } );
+
+		REQUIRE( linear_at_( surface, 64, 0 ) > 0.5f );
+		REQUIRE( linear_at_( surface, 127, 64 ) > 0.5f );
+		REQUIRE( linear_at_( surface, 64, 64 ) > 0.5f );
+	}
+}
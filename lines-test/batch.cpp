@@ -0,0 +1,108 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <algorithm>
+#include <vector>
+
+#include <cstring>
+
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+#include "../draw2d/draw-batch.hpp"
+#include "../draw2d/bresenham.hpp"
+#include "../draw2d/parallel.hpp"
+
+#include "../support/thread_pool.hpp"
+
+TEST_CASE( "Bresenham lines split by rows", "[batch]" )
+{
+	// Drawing a line in pieces, row band by row band, must visit exactly the
+	// pixels of the whole line, each once.
+	std::minstd_rand rng( 3811 );
+	std::uniform_int_distribution<int> coord( 0, 199 );
+	std::uniform_int_distribution<int> rows( 1, 23 );
+
+	int mismatches = 0;
+	for( int i = 0; i < 2000; ++i )
+	{
+		BresenhamLine const line = bresenham_setup( coord( rng ), coord( rng ), coord( rng ), coord( rng ) );
+
+		std::vector<std::pair<int,int>> whole, pieces;
+		bresenham_run( line, 0, line.dMajor+1, [&] (int aX, int aY) { whole.emplace_back( aX, aY ); } );
+
+		for( int rowBegin = 0; rowBegin < 200; )
+		{
+			int const rowEnd = rowBegin + rows( rng );
+			auto const [first, last] = bresenham_steps_in_rows( line, rowBegin, rowEnd );
+			bresenham_run( line, first, last, [&] (int aX, int aY) {
+				if( aY < rowBegin || aY >= rowEnd )
+					++mismatches;
+				pieces.emplace_back( aX, aY );
+			} );
+			rowBegin = rowEnd;
+		}
+
+		std::ranges::sort( whole );
+		std::ranges::sort( pieces );
+		if( whole != pieces )
+			++mismatches;
+	}
+
+	REQUIRE( 0 == mismatches );
+}
+
+TEST_CASE( "Batched lines", "[batch]" )
+{
+	// draw_lines_batch() must produce the same image as drawing each segment
+	// with draw_line_solid(), in order, regardless of the number of threads.
+	Surface reference( 320, 240 ), batched( 320, 240 );
+
+	std::minstd_rand rng( 1234 );
+	std::uniform_real_distribution<float> xs( -80.f, 400.f ), ys( -60.f, 300.f );
+	std::uniform_int_distribution<int> channel( 1, 255 );
+
+	LineBatch batch;
+	for( int i = 0; i < 12000; ++i )
+	{
+		Vec2f const begin{ xs( rng ), ys( rng ) };
+
+		// Mostly short segments, as in traces; some long ones that cross
+		// many bands.
+		Vec2f end{ xs( rng ), ys( rng ) };
+		if( i % 8 )
+			end = begin + (end - begin) * 0.05f;
+
+		batch.push_back( begin, end, {
+			std::uint8_t(channel( rng )), std::uint8_t(channel( rng )), std::uint8_t(channel( rng ))
+		} );
+	}
+
+	reference.clear();
+	for( std::size_t i = 0; i < batch.size(); ++i )
+		draw_line_solid( reference, { batch.x0[i], batch.y0[i] }, { batch.x1[i], batch.y1[i] }, batch.color[i] );
+
+	auto const threads = GENERATE( 1u, 3u, 8u );
+	CAPTURE( threads );
+
+	auto const bytes = std::size_t(320) * 240 * 4;
+
+	SECTION( "without executor" )
+	{
+		batched.clear();
+		draw_lines_batch( batched, batch, threads );
+
+		REQUIRE( 0 == std::memcmp( reference.get_surface_ptr(), batched.get_surface_ptr(), bytes ) );
+	}
+	SECTION( "with executor" )
+	{
+		ThreadPool pool( threads );
+		set_executor( &pool );
+
+		batched.clear();
+		draw_lines_batch( batched, batch );
+
+		set_executor( nullptr );
+
+		REQUIRE( 0 == std::memcmp( reference.get_surface_ptr(), batched.get_surface_ptr(), bytes ) );
+	}
+}
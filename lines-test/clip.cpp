@@ -1,11 +1,17 @@
 #include <catch2/catch_amalgamated.hpp>
 
+#include <random>
 #include <algorithm>
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
 #include "helpers.hpp"
 
 #include "../draw2d/surface.hpp"
 #include "../draw2d/draw.hpp"
+#include "../draw2d/clip-batch.hpp"
 
 
 TEST_CASE( "Partially offscreen", "[clip]" )
@@ -28,3 +34,128 @@ TEST_CASE( "Partially offscreen", "[clip]" )
 		REQUIRE( 1 == pixels );
 	}
 }
+
+TEST_CASE( "Batched clipping", "[clip][batch]" )
+{
+	// clip_lines() must agree with clip_line() for each segment, and keep
+	// the visible segments in order. The mix of segments ensures that the
+	// vectorized clipper sees groups that are entirely inside, entirely
+	// outside and mixed, as well as axis aligned and degenerate segments.
+	Rect2F const area{ 0.f, 0.f, 640.f, 480.f };
+
+	std::minstd_rand rng( 3811 );
+	std::uniform_real_distribution<float> inX( 0.f, 639.f ), inY( 0.f, 479.f );
+	std::uniform_real_distribution<float> anyX( -700.f, 1400.f ), anyY( -500.f, 1000.f );
+	std::uniform_int_distribution<int> kind( 0, 5 );
+
+	LineBatch batch;
+	for( int group = 0; group < 400; ++group )
+	{
+		int const groupKind = kind( rng );
+		for( int i = 0; i < 8; ++i )
+		{
+			Vec2f begin, end;
+			switch( groupKind )
+			{
+				case 0: // inside
+					begin = { inX( rng ), inY( rng ) };
+					end = { inX( rng ), inY( rng ) };
+					break;
+				case 1: // left of the area
+					begin = { -inX( rng ) - 1.f, anyY( rng ) };
+					end = { -inX( rng ) - 1.f, anyY( rng ) };
+					break;
+				case 2: // axis aligned, possibly on the edges
+					begin = { std::floor( anyX( rng ) ), std::floor( anyY( rng ) ) };
+					end = (i % 2) ? Vec2f{ begin.x, anyY( rng ) } : Vec2f{ anyX( rng ), begin.y };
+					if( i % 3 == 0 ) begin.x = 640.f;
+					break;
+				case 3: // degenerate
+					begin = end = { anyX( rng ), anyY( rng ) };
+					break;
+				default:
+					begin = { anyX( rng ), anyY( rng ) };
+					end = { anyX( rng ), anyY( rng ) };
+					break;
+			}
+
+			batch.push_back( begin, end, { 255, 255, 255 } );
+		}
+	}
+
+	// Extra segments exercise the scalar remainder.
+	for( int i = 0; i < 5; ++i )
+		batch.push_back( { anyX( rng ), anyY( rng ) }, { anyX( rng ), anyY( rng ) }, { 255, 255, 255 } );
+
+	ClippedLines clipped;
+	clip_lines( area, batch, clipped );
+
+	std::size_t expected = 0;
+	int mismatches = 0;
+	for( std::size_t i = 0; i < batch.size(); ++i )
+	{
+		Vec2f begin{ batch.x0[i], batch.y0[i] }, end{ batch.x1[i], batch.y1[i] };
+		if( !clip_line( area, begin, end ) )
+			continue;
+
+		if( expected >= clipped.size() )
+		{
+			++mismatches;
+			break;
+		}
+
+		if( clipped.index[expected] != i
+			|| clipped.x0[expected] != begin.x || clipped.y0[expected] != begin.y
+			|| clipped.x1[expected] != end.x || clipped.y1[expected] != end.y
+		)
+		{
+			++mismatches;
+		}
+
+		++expected;
+	}
+
+	REQUIRE( 0 == mismatches );
+	REQUIRE( expected == clipped.size() );
+}
+
+TEST_CASE( "Clipping preserves the line", "[clip]" )
+{
+	// A clipped line must visit exactly the pixels of the unclipped line that
+	// are on the surface. The unclipped line is drawn onto a larger surface,
+	// shifted by 100 pixels; the 100x100 window in its middle must match.
+	// Endpoints are multiples of 1/64, so that the shift is exact. Some begin
+	// far outside of both surfaces.
+	Surface small( 100, 100 ), large( 300, 300 );
+
+	std::minstd_rand rng( 4417 );
+	std::uniform_int_distribution<int> coord( -100*64, 200*64 - 1 );
+	std::uniform_int_distribution<int> far( -5000*64, 5000*64 );
+
+	int mismatches = 0;
+	for( int i = 0; i < 2000; ++i )
+	{
+		auto& dist = (i % 8 == 0) ? far : coord;
+		Vec2f const begin{ dist( rng ) / 64.f, dist( rng ) / 64.f };
+		Vec2f const end{ coord( rng ) / 64.f, coord( rng ) / 64.f };
+		Vec2f const shift{ 100.f, 100.f };
+
+		small.clear();
+		large.clear();
+		draw_line_solid( small, begin, end, { 255, 255, 255 } );
+		draw_line_solid( large, begin + shift, end + shift, { 255, 255, 255 } );
+
+		for( std::uint32_t y = 0; y < 100; ++y )
+		{
+			auto const* rowSmall = small.get_surface_ptr() + y*small.get_width()*4;
+			auto const* rowLarge = large.get_surface_ptr() + ((y+100)*large.get_width() + 100)*4;
+			if( 0 != std::memcmp( rowSmall, rowLarge, 100*4 ) )
+			{
+				++mismatches;
+				break;
+			}
+		}
+	}
+
+	REQUIRE( 0 == mismatches );
+}
@@ -1,8 +1,10 @@
 #include <catch2/catch_amalgamated.hpp>
 
+#include <random>
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 
 #include "helpers.hpp"
 #include "../draw2d/draw.hpp"
@@ -186,6 +188,37 @@ TEST_CASE("Scenario3: Line from p0 to p1 should be identical to line from p1 to
 			REQUIRE(ptr1[2] == ptr2[2]); // Blue channel
 		}
 	}
+
+	// Exact comparison for many random lines, including ones that leave the
+	// surface or lie entirely outside of it, and ones with endpoints exactly
+	// halfway between pixels.
+	std::minstd_rand rng(1729);
+	std::uniform_real_distribution<float> coord(-150.f, 250.f);
+	std::uniform_int_distribution<int> half(-300, 500);
+
+	auto const bytes = std::size_t(surface1.get_height()) * stride;
+	int mismatches = 0;
+	for (int i = 0; i < 2000; ++i) {
+		Vec2f p0, p1;
+		if (i % 4 == 0) {
+			p0 = { half(rng) * 0.5f, half(rng) * 0.5f };
+			p1 = { half(rng) * 0.5f, half(rng) * 0.5f };
+		}
+		else {
+			p0 = { coord(rng), coord(rng) };
+			p1 = { coord(rng), coord(rng) };
+		}
+
+		surface1.clear();
+		surface2.clear();
+		draw_line_solid(surface1, p0, p1, color);
+		draw_line_solid(surface2, p1, p0, color);
+
+		if (0 != std::memcmp(surface1.get_surface_ptr(), surface2.get_surface_ptr(), bytes))
+			++mismatches;
+	}
+
+	REQUIRE(0 == mismatches);
 }
 
 TEST_CASE("Scenario4: Continuous lines should have no gaps between segments")
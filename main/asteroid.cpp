@@ -2,6 +2,7 @@
 
 #include <random>
 #include <vector>
+#include <memory_resource>
 #include <numbers>
 #include <algorithm>
 
@@ -10,10 +11,18 @@
 
 #include "../draw2d/shape.hpp"
 
+#include "../support/frame_arena.hpp"
+
 #include "../vmlib/vec2.hpp"
 #include "../vmlib/mat22.hpp"
 
 TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float aRadiusMean, float aRadiusStddev, float aSquishStddev, float aDisplaceStddev, ColorF const& aBaseColor, float aColorBaseStddev, float aColorVar )
+{
+	float boundingRadius;
+	return make_asteroid( aRNG, boundingRadius, aNumPoints, aRadiusMean, aRadiusStddev, aSquishStddev, aDisplaceStddev, aBaseColor, aColorBaseStddev, aColorVar );
+}
+
+TriangleFan make_asteroid( std::minstd_rand& aRNG, float& aBoundingRadius, std::size_t aNumPoints, float aRadiusMean, float aRadiusStddev, float aSquishStddev, float aDisplaceStddev, ColorF const& aBaseColor, float aColorBaseStddev, float aColorVar )
 {
 	// Sample general parameters
 	float const radius = std::normal_distribution<float>{aRadiusMean, aRadiusStddev}(aRNG);
@@ -29,7 +38,10 @@ TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float
 	// Generate initial circle
 	float const astep = 2.f*std::numbers::pi_v<float> / aNumPoints;
 
-	std::vector<Vec2f> verts;
+	// The temporaries only live until the TriangleFan has copied them.
+	FrameArena::Scope scratch( frame_arena() );
+
+	std::pmr::vector<Vec2f> verts( &frame_arena() );
 	verts.reserve( aNumPoints+1 );
 	verts.resize( aNumPoints );
 
@@ -55,13 +67,17 @@ TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float
 	// Squish
 	// We only need to squish along one axis to make the shape less round. The
 	// asteroids are rotated randomly later.
+	aBoundingRadius = 0.f;
 	for( auto& vert : verts )
+	{
 		vert.x *= squish;
+		aBoundingRadius = std::max( aBoundingRadius, length( vert ) );
+	}
 
 	// Generate colors
 	std::uniform_real_distribution<float> cdist( -aColorVar, aColorVar );
 
-	std::vector<ColorF> colors;
+	std::pmr::vector<ColorF> colors( &frame_arena() );
 	colors.reserve( aNumPoints + 1 );
 	for( std::size_t i = 0; i < aNumPoints; ++i )
 	{
@@ -80,6 +96,5 @@ TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float
 	colors.emplace( colors.begin(), baseColor );
 
 	// Return shape
-	// We could be a bit more clever here and avoid the double allocations...
 	return TriangleFan( verts.size(), verts.data(), colors.data() );
 }
@@ -32,6 +32,18 @@ TriangleFan make_asteroid(
 	float aColorBaseStddev = 0.2f,
 	float aColorVariation = 0.05f
 );
+TriangleFan make_asteroid(
+	RNG&,
+	float& aBoundingRadius,
+	std::size_t aNumPoints = 18,
+	float aRadiusMean = 30.f, 
+	float aRadiusStddev = 5.f,
+	float aSquishStddev = 0.20f,
+	float aDisplaceStddev = 2.5f,
+	ColorF const& aBaseColor = { 0.3f, 0.3f, 0.3f },
+	float aColorBaseStddev = 0.2f,
+	float aColorVariation = 0.05f
+);
 #else
 // This creates a lower resolution asteroid with only 7+1 points.
 TriangleFan make_asteroid(
@@ -45,9 +57,26 @@ TriangleFan make_asteroid(
 	float aColorBaseStddev = 0.2f,
 	float aColorVariation = 0.05f
 );
+TriangleFan make_asteroid(
+	RNG&,
+	float& aBoundingRadius,
+	std::size_t aNumPoints = 7,
+	float aRadiusMean = 30.f, 
+	float aRadiusStddev = 5.f,
+	float aSquishStddev = 0.15f,
+	float aDisplaceStddef = 9.f,
+	ColorF const& aBaseColor = { 0.3f, 0.3f, 0.3f },
+	float aColorBaseStddev = 0.2f,
+	float aColorVariation = 0.05f
+);
 #endif
 
 // Note that the same function is used to generate either type of asteroid;
 // only the default parameter values change.
+//
+// The overloads with aBoundingRadius additionally return the distance of the
+// farthest vertex from the asteroid's center (the origin of the triangle
+// fan), i.e., the radius of a circle around the center that contains the
+// asteroid in any rotation. AsteroidField uses this for culling.
 
 #endif // ASTEROID_HPP_477C5E99_10A3_4AEB_8FE5_99A52EDF26EC
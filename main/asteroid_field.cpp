@@ -1,17 +1,51 @@
 #include "asteroid_field.hpp"
 
 #include <random>
+#include <vector>
+#include <memory_resource>
+#include <utility>
 #include <numbers>
 #include <algorithm>
 
+#include <cmath>
 #include <cassert>
 
+#include "../draw2d/image.hpp"
 #include "../draw2d/shape.hpp"
+#include "../draw2d/surface.hpp"
+
+#include "../support/profile.hpp"
+#include "../support/alloc_track.hpp"
+#include "../support/frame_arena.hpp"
 
 #include "asteroid.hpp"
 
+namespace
+{
+	// Number of update()s between renormalizations of the accumulated rotations
+	constexpr std::size_t kRenormalizeInterval = 64;
+
+	// Shapes kept aside for respawning asteroids (see update())
+	constexpr std::size_t kSpareShapes = 32;
+
+	// Side length of the grid cells, in pixels. Asteroids are about 60
+	// pixels across; a cell holds a few at the default densities.
+	constexpr float kCellSize = 128.f;
+
+	// Largest difference between an asteroid's rotation and that of the
+	// impostor drawn in its place, measured as the distance (in pixels) that
+	// this moves the asteroid's farthest vertex.
+	constexpr float kImpostorMaxError = 1.f;
+
+	// Smallest fraction of impostor lookups that must find a sprite. Each
+	// miss costs the lookup, and often a rasterization by the cache's
+	// background thread, in addition to drawing the asteroid.
+	constexpr float kImpostorMinHitRate = 0.5f;
+}
+
 AsteroidField::AsteroidField( RNG& aRNG, std::uint32_t aWidth, std::uint32_t aHeight, float aDensity, float aInitialSpeedStddev, float aMaximumSpeed, float aInitialRotStddev, float aPadding )
-	: mInitialSpeed( aInitialSpeedStddev )
+	: mCollisions( kCellSize )
+	, mInitialSpeed( aInitialSpeedStddev )
 	, mMaximumSpeed( aMaximumSpeed )
 	, mInitialRot( aInitialRotStddev )
 	, mPadding( aPadding )
@@ -30,8 +64,15 @@ AsteroidField::AsteroidField( RNG& aRNG, std::uint32_t aWidth, std::uint32_t aHe
 	float const numAsteroidsf = mActualExtent.x*mActualExtent.y * mDensity;
 	std::size_t const numAsteroids = std::size_t(numAsteroidsf+0.5f);
 	
-	mAsteroids.resize( numAsteroids );
-	mShapes.reserve( numAsteroids ); // reserve! not resize!
+	mPositions.resize( numAsteroids );
+	mVelocities.resize( numAsteroids );
+	mRotations.resize( numAsteroids );
+	mAngularVelocities.resize( numAsteroids );
+	mRotationSteps.resize( numAsteroids );
+	mRadii.resize( numAsteroids );
+	mShapeIds.resize( numAsteroids );
+	mShapes.reserve( numAsteroids + kSpareShapes ); // reserve! not resize!
+	mShapeRadii.reserve( numAsteroids + kSpareShapes );
 
 	using Uniform_ = std::uniform_real_distribution<float>;
 	using Normal_ = std::normal_distribution<float>;
@@ -46,20 +87,39 @@ AsteroidField::AsteroidField( RNG& aRNG, std::uint32_t aWidth, std::uint32_t aHe
 
 	for( std::size_t i = 0; i < numAsteroids; ++i )
 	{
-		auto& astr = mAsteroids[i];
-		astr.pos = Vec2f{ xpos( mRNG ), ypos( mRNG ) };
-		astr.vel = Vec2f{ vvel( mRNG ), vvel( mRNG ) };
+		mPositions.set( i, Vec2f{ xpos( mRNG ), ypos( mRNG ) } );
+
+		Vec2f vel{ vvel( mRNG ), vvel( mRNG ) };
 
-		astr.rot = make_rotation_2d( angle( mRNG ) );
-		astr.radpersec = rots( mRNG );
+		mRotations.set( i, make_rotation_2d( angle( mRNG ) ) );
+		mAngularVelocities[i] = rots( mRNG );
 
 		// Don't break the speed limits. The space police will get you!
-		astr.vel.x = std::clamp( astr.vel.x, -mMaximumSpeed, +mMaximumSpeed );
-		astr.vel.y = std::clamp( astr.vel.y, -mMaximumSpeed, +mMaximumSpeed );
+		vel.x = std::clamp( vel.x, -mMaximumSpeed, +mMaximumSpeed );
+		vel.y = std::clamp( vel.y, -mMaximumSpeed, +mMaximumSpeed );
+		mVelocities.set( i, vel );
 
 		// Create shape
-		mShapes.emplace_back( make_asteroid( mRNG ) );
+		mShapes.emplace_back( make_asteroid( mRNG, mRadii[i] ) );
+		mShapeRadii.emplace_back( mRadii[i] );
+		mShapeIds[i] = std::uint32_t(i);
+		mMaxRadius = std::max( mMaxRadius, mRadii[i] );
 	}
+
+	mSpareIds.reserve( kSpareShapes );
+	for( std::size_t i = 0; i < kSpareShapes; ++i )
+	{
+		float radius;
+		mSpareIds.emplace_back( std::uint32_t(mShapes.size()) );
+		mShapes.emplace_back( make_asteroid( mRNG, radius ) );
+		mShapeRadii.emplace_back( radius );
+		mMaxRadius = std::max( mMaxRadius, radius );
+	}
+
+	resize_grid_();
+	bin_();
+
+	mCollisions.update( mPositions, mRadii );
 }
 
 AsteroidField::~AsteroidField() = default;
@@ -67,8 +127,25 @@ AsteroidField::~AsteroidField() = default;
 
 void AsteroidField::update( float aElapsed, Vec2f const& aTransl )
 {
-	auto const numAsteroids = mAsteroids.size();
-	assert( numAsteroids == mShapes.size() );
+	NO_ALLOCATION_SCOPE( "AsteroidField::update" );
+
+	auto const numAsteroids = mPositions.size();
+	assert( numAsteroids == mShapeIds.size() );
+
+	// Move and rotate all asteroids. Asteroids that leave the simulation area
+	// are replaced below; overwriting their new state is harmless.
+	add_scaled( mPositions, mVelocities, aElapsed, -aTransl );
+
+	make_rotation_2d( numAsteroids, mAngularVelocities.data(), mRotationSteps, aElapsed );
+	premultiply_each( mRotations, mRotationSteps );
+
+	// Accumulated rotations drift from orthonormal over time (shearing and
+	// scaling the asteroids); rebuild them every now and then.
+	if( ++mFramesSinceRenormalize >= kRenormalizeInterval )
+	{
+		renormalize_rotations( mRotations );
+		mFramesSinceRenormalize = 0;
+	}
 
 	using Uniform_ = std::uniform_real_distribution<float>;
 	using Normal_ = std::normal_distribution<float>;
@@ -81,10 +158,11 @@ void AsteroidField::update( float aElapsed, Vec2f const& aTransl )
 	Normal_ vvel{ 0.f, mInitialSpeed };
 	Normal_ rots{ 0.f, mInitialRot };
 
+	std::uniform_int_distribution<std::size_t> spare( 0, mSpareIds.size()-1 );
+
 	for( std::size_t i = 0; i < numAsteroids; ++i )
 	{
-		auto& astr = mAsteroids[i];
-		astr.pos += astr.vel * aElapsed - aTransl;
+		auto pos = mPositions.get( i );
 
 		// If the asteroid is outside of the simulation area, replace it
 		// with a fresh one.
@@ -95,66 +173,120 @@ void AsteroidField::update( float aElapsed, Vec2f const& aTransl )
 		// movement vectors. The random vectors are picked uniformly, meaning
 		// that the asteroid has a fair chance to move off-screen without ever
 		// becoming visible.
-		if( astr.pos.x < mBoundsMin.x || astr.pos.x > mBoundsMax.x || astr.pos.y < mBoundsMin.y || astr.pos.y > mBoundsMax.x )
+		if( pos.x < mBoundsMin.x || pos.x > mBoundsMax.x || pos.y < mBoundsMin.y || pos.y > mBoundsMax.x )
 		{
-			if( astr.pos.x < mBoundsMin.x )
+			if( pos.x < mBoundsMin.x )
 			{
-				astr.pos.x = mBoundsMax.x - mPadding/2.f;
-				astr.pos.y = ypos( mRNG );
+				pos.x = mBoundsMax.x - mPadding/2.f;
+				pos.y = ypos( mRNG );
 			}
-			else if( astr.pos.x > mBoundsMax.x )
+			else if( pos.x > mBoundsMax.x )
 			{
-				astr.pos.x = mBoundsMin.x + mPadding/2.f;
-				astr.pos.y = ypos( mRNG );
+				pos.x = mBoundsMin.x + mPadding/2.f;
+				pos.y = ypos( mRNG );
 			}
-			else if( astr.pos.y < mBoundsMin.y )
+			else if( pos.y < mBoundsMin.y )
 			{
-				astr.pos.x = xpos( mRNG );
-				astr.pos.y = mBoundsMax.y - mPadding/2.f;
+				pos.x = xpos( mRNG );
+				pos.y = mBoundsMax.y - mPadding/2.f;
 			}
-			else if( astr.pos.y > mBoundsMax.y )
+			else if( pos.y > mBoundsMax.y )
 			{
-				astr.pos.x = xpos( mRNG );
-				astr.pos.y = mBoundsMin.y + mPadding/2.f;
+				pos.x = xpos( mRNG );
+				pos.y = mBoundsMin.y + mPadding/2.f;
 			}
 
-			astr.vel = Vec2f{ vvel( mRNG ), vvel( mRNG ) };
+			mPositions.set( i, pos );
 
-			astr.rot = make_rotation_2d( angle( mRNG ) );
-			astr.radpersec = rots( mRNG );
+			Vec2f vel{ vvel( mRNG ), vvel( mRNG ) };
 
-			// Don't break the speed limits. The space police will get you!
-			astr.vel.x = std::clamp( astr.vel.x, -mMaximumSpeed, +mMaximumSpeed );
-			astr.vel.y = std::clamp( astr.vel.y, -mMaximumSpeed, +mMaximumSpeed );
+			mRotations.set( i, make_rotation_2d( angle( mRNG ) ) );
+			mAngularVelocities[i] = rots( mRNG );
 
-			// Create shape
-			mShapes[i] = make_asteroid( mRNG );
+			// Don't break the speed limits. The space police will get you!
+			vel.x = std::clamp( vel.x, -mMaximumSpeed, +mMaximumSpeed );
+			vel.y = std::clamp( vel.y, -mMaximumSpeed, +mMaximumSpeed );
+			mVelocities.set( i, vel );
+
+			// Swap in a random spare shape; the old one becomes a spare.
+			// Unlike making a new shape, this does not allocate. The
+			// outlines thus come from a fixed set (one per asteroid, plus
+			// the spares) until resize() makes new ones.
+			auto const j = spare( mRNG );
+			std::swap( mShapeIds[i], mSpareIds[j] );
+			mRadii[i] = mShapeRadii[mShapeIds[i]];
 		}
+	}
+
+	bin_();
+
+	// The screen moved by aTransl, i.e., the world by -aTransl relative to
+	// the screen positions.
+	mCollisions.translate( -aTransl );
+	mCollisions.update( mPositions, mRadii );
+
+	// Turn the impostors off if they do not pay off. This is done here
+	// rather than in draw(), which only looks up sprites: destroying the
+	// cache waits for its background thread.
+	if( mImpostors )
+	{
+		auto const stats = mImpostors->stats();
+		if( 0 != stats.lookups && float(stats.hits) < kImpostorMinHitRate * float(stats.lookups) )
+			mImpostors.reset();
 		else
-		{
-			astr.rot = make_rotation_2d( astr.radpersec * aElapsed ) * astr.rot;
-		}
+			mImpostors->next_frame();
 	}
 }
 
 void AsteroidField::draw( Surface& aSurface ) const
 {
-	auto const numAsteroids = mAsteroids.size();
-	assert( numAsteroids == mShapes.size() );
+	PROFILE_SCOPE( "asteroids.draw" );
 
-	for( std::size_t i = 0; i < numAsteroids; ++i )
+	auto const numAsteroids = mPositions.size();
+	assert( numAsteroids == mShapeIds.size() );
+	assert( numAsteroids == mBinnedIndices.size() );
+
+	if( 0 == numAsteroids )
+		return;
+
+	Box2f const viewport{
+		{ 0.f, 0.f },
+		{ float(aSurface.get_width()), float(aSurface.get_height()) }
+	};
+
+	FrameArena::Scope scratch( frame_arena() );
+	std::pmr::vector<std::uint32_t> visible( numAsteroids, &frame_arena() );
+
+	auto const count = find_visible( viewport, visible.data() );
+
+	for( std::size_t j = 0; j < count; ++j )
 	{
-		auto const& astr = mAsteroids[i];
-		auto const& shape = mShapes[i];
+		auto const i = visible[j];
+		auto const shape = mShapeIds[i];
+		auto const rotation = mRotations.get( i );
+		auto const position = mPositions.get( i );
 
-		// Performance: culling asteroids here would remove some work; right
-		// now each triangle will be culled individually.
+		if( mImpostors )
+		{
+			// Nearest of the cache's angles, in steps of 2pi/K.
+			auto const angles = mImpostors->angle_count();
+			float const stepsPerRadian = float(angles) / (2.f*std::numbers::pi_v<float>);
 
-		shape.draw(
-			aSurface,
-			astr.rot,
-			astr.pos
-		);
+			float const steps = std::atan2( rotation._10, rotation._00 ) * stepsPerRadian;
+			float const nearest = std::round( steps );
+
+			if( std::abs( steps - nearest ) / stepsPerRadian * mRadii[i] <= kImpostorMaxError )
+			{
+				auto const angle = std::uint32_t(std::int32_t(nearest) + std::int32_t(angles)) % angles;
+				if( auto const* sprite = mImpostors->find( shape, angle ) )
+				{
+					blit_masked( aSurface, *sprite, position + Vec2f{ 0.5f, 0.5f } );
+					continue;
+				}
+			}
+		}
+
+		mShapes[shape].draw( aSurface, rotation, position );
 	}
 }
 
@@ -162,6 +294,10 @@ void AsteroidField::resize( std::uint32_t aWidth, std::uint32_t aHeight )
 {
 	// WARNING: This is a bit of a hack...
 
+	// The shapes change below.
+	if( mImpostors )
+		mImpostors->clear();
+
 	auto const oldMax = mBoundsMax;
 
 	// New area and asteroid count
@@ -175,34 +311,55 @@ void AsteroidField::resize( std::uint32_t aWidth, std::uint32_t aHeight )
 	float const numAsteroidsf = mActualExtent.x*mActualExtent.y * mDensity;
 	std::size_t const numAsteroids = std::size_t(numAsteroidsf+0.5f);
 
-	// Remove asteroids now outside
+	// Remove asteroids now outside. Remaining asteroids are compacted towards
+	// the front, keeping their order.
 	std::size_t activeAsteroids = 0;
-
-	auto jt = mShapes.begin();
-	for( auto it = mAsteroids.begin(); it != mAsteroids.end(); )
+	for( std::size_t i = 0; i < mPositions.size(); ++i )
 	{
-		auto const& aster = *it;
+		auto const pos = mPositions.get( i );
+		if( pos.x > mBoundsMax.x || pos.y > mBoundsMax.y )
+			continue;
 
-		if( aster.pos.x > mBoundsMax.x || aster.pos.y > mBoundsMax.y )
-		{
-			it = mAsteroids.erase( it );
-			jt = mShapes.erase( jt );
-		}
-		else
+		if( activeAsteroids != i )
 		{
-			++it;
-			++jt;
-			++activeAsteroids;
+			mPositions.set( activeAsteroids, pos );
+			mVelocities.set( activeAsteroids, mVelocities.get( i ) );
+			mRotations.set( activeAsteroids, mRotations.get( i ) );
+			mAngularVelocities[activeAsteroids] = mAngularVelocities[i];
+			mRadii[activeAsteroids] = mRadii[i];
+			mShapeIds[activeAsteroids] = mShapeIds[i];
 		}
+
+		++activeAsteroids;
 	}
 
-	mAsteroids.resize( numAsteroids );
+	mPositions.resize( numAsteroids );
+	mVelocities.resize( numAsteroids );
+	mRotations.resize( numAsteroids );
+	mAngularVelocities.resize( numAsteroids );
+	mRotationSteps.resize( numAsteroids );
+	mRadii.resize( numAsteroids );
 	activeAsteroids = std::min( activeAsteroids, numAsteroids );
 
-	mShapes.erase( mShapes.begin()+activeAsteroids, mShapes.end() );
-	mShapes.reserve( numAsteroids );
+	// Keep the shapes of the remaining asteroids and the spares; drop the
+	// others. New asteroids append their shapes below.
+	std::vector<TriangleFan> shapes;
+	std::vector<float> shapeRadii;
+	shapes.reserve( numAsteroids + mSpareIds.size() );
+	shapeRadii.reserve( numAsteroids + mSpareIds.size() );
+
+	auto const keep = [&] (std::uint32_t& aId) {
+		shapes.emplace_back( std::move(mShapes[aId]) );
+		shapeRadii.emplace_back( mShapeRadii[aId] );
+		aId = std::uint32_t(shapes.size()-1);
+	};
+
+	for( std::size_t i = 0; i < activeAsteroids; ++i )
+		keep( mShapeIds[i] );
+	for( auto& id : mSpareIds )
+		keep( id );
 
-	assert( mShapes.size() == activeAsteroids );
+	mShapeIds.resize( numAsteroids );
 
 	// Generate new asteroids.
 	using Normal_ = std::normal_distribution<float>;
@@ -244,24 +401,180 @@ void AsteroidField::resize( std::uint32_t aWidth, std::uint32_t aHeight )
 				pos.y = yay( mRNG );
 			}
 
-			auto& astr = mAsteroids[i];
+			mPositions.set( i, pos );
 
-			astr.pos = pos;
-			astr.vel = Vec2f{ vvel( mRNG ), vvel( mRNG ) };
+			Vec2f vel{ vvel( mRNG ), vvel( mRNG ) };
 
-			astr.rot = make_rotation_2d( angle( mRNG ) );
-			astr.radpersec = rots( mRNG );
+			mRotations.set( i, make_rotation_2d( angle( mRNG ) ) );
+			mAngularVelocities[i] = rots( mRNG );
 
 			// Don't break the speed limits. The space police will get you!
-			astr.vel.x = std::clamp( astr.vel.x, -mMaximumSpeed, +mMaximumSpeed );
-			astr.vel.y = std::clamp( astr.vel.y, -mMaximumSpeed, +mMaximumSpeed );
+			vel.x = std::clamp( vel.x, -mMaximumSpeed, +mMaximumSpeed );
+			vel.y = std::clamp( vel.y, -mMaximumSpeed, +mMaximumSpeed );
+			mVelocities.set( i, vel );
 
 			// Create shape
-			assert( i == mShapes.size() );
-			mShapes.emplace_back( make_asteroid( mRNG ) );
+			mShapeIds[i] = std::uint32_t(shapes.size());
+			shapes.emplace_back( make_asteroid( mRNG, mRadii[i] ) );
+			shapeRadii.emplace_back( mRadii[i] );
+			mMaxRadius = std::max( mMaxRadius, mRadii[i] );
 		}
 	}
 
-	assert( mAsteroids.size() == mShapes.size() );
+	mShapes = std::move(shapes);
+	mShapeRadii = std::move(shapeRadii);
+
+	assert( mPositions.size() == mShapeIds.size() );
+	assert( mShapes.size() == numAsteroids + mSpareIds.size() );
+
+	if( mImpostors )
+		mImpostors->assign( mShapes.size(), mShapes.data(), mShapeRadii.data() );
+
+	resize_grid_();
+	bin_();
+
+	mCollisions.update( mPositions, mRadii );
+}
+
+std::size_t AsteroidField::find_visible( Box2f const& aBox, std::uint32_t* aIndices ) const
+{
+	assert( mPositions.size() == mBinnedIndices.size() );
+
+	if( mPositions.empty() )
+		return 0;
+
+	// Cells whose asteroids may overlap the box. Asteroids are binned by
+	// their centers, so this is the box grown by the largest radius.
+	auto const cx0 = cell_x_( aBox.min.x - mMaxRadius );
+	auto const cx1 = cell_x_( aBox.max.x + mMaxRadius );
+	auto const cy0 = cell_y_( aBox.min.y - mMaxRadius );
+	auto const cy1 = cell_y_( aBox.max.y + mMaxRadius );
+
+	// The cells [cx0, cx1] of a row are consecutive in the binned arrays, so
+	// each row is culled with a single call.
+	std::size_t count = 0;
+	for( auto cy = cy0; cy <= cy1; ++cy )
+	{
+		auto const begin = mCellStart[cy*mGridWidth + cx0];
+		auto const end = mCellStart[cy*mGridWidth + cx1 + 1];
+
+		auto const found = circles_in_box( end - begin,
+			mBinnedPositions.x.data() + begin,
+			mBinnedPositions.y.data() + begin,
+			mBinnedRadii.data() + begin,
+			aBox,
+			aIndices + count
+		);
+
+		for( std::size_t i = count; i < count+found; ++i )
+			aIndices[i] = mBinnedIndices[begin + aIndices[i]];
+
+		count += found;
+	}
+
+	// Index order, as if all asteroids were tested; overlapping asteroids
+	// then don't change their stacking order when crossing cells.
+	std::sort( aIndices, aIndices+count );
+
+	return count;
+}
+
+std::size_t AsteroidField::size() const noexcept
+{
+	return mPositions.size();
+}
+Vec2fBatch const& AsteroidField::positions() const noexcept
+{
+	return mPositions;
+}
+std::vector<float> const& AsteroidField::radii() const noexcept
+{
+	return mRadii;
+}
+
+CollisionGrid const& AsteroidField::collisions() const noexcept
+{
+	return mCollisions;
+}
+
+void AsteroidField::set_impostors( bool aEnabled )
+{
+	if( !aEnabled )
+	{
+		mImpostors.reset();
+		return;
+	}
+
+	if( !mImpostors )
+	{
+		mImpostors = std::make_unique<ImpostorCache>();
+		mImpostors->assign( mShapes.size(), mShapes.data(), mShapeRadii.data() );
+	}
+}
+bool AsteroidField::impostors() const noexcept
+{
+	return nullptr != mImpostors;
+}
+
+void AsteroidField::resize_grid_()
+{
+	mGridWidth = std::max( 1u, std::uint32_t(std::ceil( mActualExtent.x / kCellSize )) );
+	mGridHeight = std::max( 1u, std::uint32_t(std::ceil( mActualExtent.y / kCellSize )) );
+
+	auto const numAsteroids = mPositions.size();
+	mCellStart.resize( std::size_t(mGridWidth)*mGridHeight + 1 );
+	mCells.resize( numAsteroids );
+
+	mBinnedIndices.resize( numAsteroids );
+	mBinnedPositions.resize( numAsteroids );
+	mBinnedRadii.resize( numAsteroids );
+}
+
+void AsteroidField::bin_()
+{
+	// Counting sort by cell. The asteroids of each cell stay in index order.
+	auto const numAsteroids = mPositions.size();
+	assert( numAsteroids == mCells.size() );
+	assert( numAsteroids == mBinnedIndices.size() );
+
+	std::fill( mCellStart.begin(), mCellStart.end(), 0u );
+
+	for( std::size_t i = 0; i < numAsteroids; ++i )
+	{
+		auto const cell = cell_y_( mPositions.y[i] )*mGridWidth + cell_x_( mPositions.x[i] );
+		mCells[i] = cell;
+		++mCellStart[cell+1];
+	}
+
+	for( std::size_t c = 1; c < mCellStart.size(); ++c )
+		mCellStart[c] += mCellStart[c-1];
+
+	// Scatter, using mCellStart[c] as the insertion point of cell c. This
+	// advances each entry to the start of the following cell; shift them
+	// back afterwards.
+	for( std::size_t i = 0; i < numAsteroids; ++i )
+	{
+		auto const j = mCellStart[mCells[i]]++;
+		mBinnedIndices[j] = std::uint32_t(i);
+		mBinnedPositions.x[j] = mPositions.x[i];
+		mBinnedPositions.y[j] = mPositions.y[i];
+		mBinnedRadii[j] = mRadii[i];
+	}
+
+	for( std::size_t c = mCellStart.size()-1; c > 0; --c )
+		mCellStart[c] = mCellStart[c-1];
+	mCellStart[0] = 0;
+}
+
+std::uint32_t AsteroidField::cell_x_( float aX ) const noexcept
+{
+	// Positions outside of the simulation area go into the border cells.
+	auto const cell = std::clamp( (aX - mBoundsMin.x) / kCellSize, 0.f, float(mGridWidth-1) );
+	return std::uint32_t(cell);
+}
+std::uint32_t AsteroidField::cell_y_( float aY ) const noexcept
+{
+	auto const cell = std::clamp( (aY - mBoundsMin.y) / kCellSize, 0.f, float(mGridHeight-1) );
+	return std::uint32_t(cell);
 }
 
@@ -1,6 +1,7 @@
 #ifndef ASTEROID_FIELD_HPP_7D5A0B40_4466_4CAC_B7CC_85E8DC927E08
 #define ASTEROID_FIELD_HPP_7D5A0B40_4466_4CAC_B7CC_85E8DC927E08
 
+#include <memory>
 #include <vector>
 
 #include <cstdlib>
@@ -9,8 +10,12 @@
 
 #include "../vmlib/vec2.hpp"
 #include "../vmlib/mat22.hpp"
+#include "../vmlib/vec2_batch.hpp"
+#include "../vmlib/mat22_batch.hpp"
 
 #include "defaults.hpp"
+#include "collision_grid.hpp"
+#include "impostor_cache.hpp"
 
 /** Asteroid field
  *
@@ -23,8 +28,25 @@
  * a asteroid exits the screen, the player turns around immediately, the same
  * asteroid still exists).
  *
- * With the current implementation, the asteroid field is a purely visual
- * effect.
+ * The asteroids are also bodies in a CollisionGrid (bounding circles, see
+ * below), which update() keeps up to date. collisions() exposes it for
+ * queries, e.g., for asteroids that overlap the spaceship, or for pairs of
+ * overlapping asteroids. Body indices are asteroid indices; they are stable
+ * between calls to update() (a respawned asteroid reuses its index).
+ *
+ * Only asteroids that may be visible are drawn. The asteroids are binned into
+ * a uniform grid over the simulation area by their centers. draw() visits the
+ * cells near the viewport and tests the asteroids in them with their bounding
+ * circles (radii from make_asteroid()) against the viewport.
+ *
+ * With impostors enabled (set_impostors()), draw() blits pre-rasterized
+ * sprites of the asteroids at quantized rotations (see ImpostorCache) in
+ * place of rasterizing them, where the rotation differs from the sprite's by
+ * at most about a pixel at the asteroid's outline. Asteroids whose sprite is
+ * not built yet are rasterized as usual. If fewer than half of the lookups
+ * find a sprite (measured over ImpostorCache::kStatsFrames frames), the
+ * sprites cost more than they save, and update() turns impostors off.
+ * Impostors are disabled by default.
  */
 class AsteroidField
 {
@@ -52,22 +74,79 @@ class AsteroidField
 
 		void resize( std::uint32_t aWidth, std::uint32_t aHeight );
 
+		// Indices of the asteroids whose bounding circles overlap aBox, in
+		// increasing order, found with the grid as in draw(). aIndices must
+		// have room for size() entries. Returns the number of indices.
+		std::size_t find_visible( Box2f const& aBox, std::uint32_t* aIndices ) const;
+
+		std::size_t size() const noexcept;
+		Vec2fBatch const& positions() const noexcept;
+		std::vector<float> const& radii() const noexcept; // bounding circles
+
+		CollisionGrid const& collisions() const noexcept;
+
+		// Starts/stops the impostor cache's background thread. impostors()
+		// is false once update() has turned the cache off.
+		void set_impostors( bool aEnabled );
+		bool impostors() const noexcept;
+
 	private:
-		struct Asteroid_
-		{
-			Vec2f pos;
-			Vec2f vel;
-			
-			Mat22f rot;
-			float radpersec;
-		};
+		void resize_grid_();
+		void bin_();
+
+		std::uint32_t cell_x_( float ) const noexcept;
+		std::uint32_t cell_y_( float ) const noexcept;
 
 	private:
 		Vec2f mBoundsMin, mBoundsMax;
 		Vec2f mExactExtent, mActualExtent;
-		
-		std::vector<Asteroid_> mAsteroids;
+
+		// Per-asteroid state, stored as SoA such that update() can use the
+		// vmlib batch kernels. All arrays have the same size as mShapeIds.
+		Vec2fBatch mPositions;
+		Vec2fBatch mVelocities;
+		Mat22fBatch mRotations;
+		std::vector<float> mAngularVelocities; // radians per second
+
+		Mat22fBatch mRotationSteps; // scratch, used in update()
+		std::size_t mFramesSinceRenormalize = 0;
+
+		// All shapes, those of the asteroids and the spares (for respawns),
+		// with their bounding radii (see make_asteroid()). Asteroids refer
+		// to their shapes by index; a respawn swaps indices with a spare.
+		// The shapes themselves only change in resize(), as the impostor
+		// cache draws them on its own thread.
 		std::vector<TriangleFan> mShapes;
+		std::vector<float> mShapeRadii;
+		std::vector<std::uint32_t> mShapeIds; // per asteroid
+		std::vector<std::uint32_t> mSpareIds;
+
+		// Per asteroid, the radius of its shape. mMaxRadius is the largest
+		// radius of all shapes.
+		std::vector<float> mRadii;
+		float mMaxRadius = 0.f;
+
+		// Uniform grid, rebuilt by bin_() after the asteroids move. Cells
+		// are stored row-major. The asteroids of cell c are the elements
+		// [mCellStart[c], mCellStart[c+1]) of the binned arrays, which hold
+		// the asteroids' indices, centers and radii sorted by cell.
+		std::uint32_t mGridWidth = 0, mGridHeight = 0;
+		std::vector<std::uint32_t> mCellStart;
+		std::vector<std::uint32_t> mCells; // scratch: cell of each asteroid
+
+		std::vector<std::uint32_t> mBinnedIndices;
+		Vec2fBatch mBinnedPositions;
+		std::vector<float> mBinnedRadii;
+
+		// Broad phase for collision queries. Its positions follow the
+		// asteroids' (screen) positions; the movement of the screen is
+		// passed to CollisionGrid::translate(), so that only asteroids that
+		// move relative to the world are relinked.
+		CollisionGrid mCollisions;
+
+		// Declared after mShapes, so that it stops drawing them before they
+		// are destroyed.
+		std::unique_ptr<ImpostorCache> mImpostors;
 
 		float mInitialSpeed, mMaximumSpeed;
 		float mInitialRot;
@@ -1,6 +1,69 @@
 #include "background.hpp"
 
+#include <memory_resource>
+#include <algorithm>
+
+#include <cstring>
+
 #include "../draw2d/image.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/parallel.hpp"
+
+#include "../support/profile.hpp"
+#include "../support/alloc_track.hpp"
+#include "../support/frame_arena.hpp"
+
+namespace
+{
+	// Particles are only bucketed by row, and the rows split across threads,
+	// if each thread gets at least this many particles. Below that, writing
+	// the particles directly in their own order is faster: the writes don't
+	// depend on each other, so their cache misses overlap well.
+	constexpr std::size_t kMinParticlesPerThread_ = 8192;
+	constexpr int kBandsPerThread_ = 4;
+
+	// A particle's pixel in a row: column and packed color.
+	struct RowPixel_
+	{
+		std::uint32_t x;
+		std::uint32_t color;
+	};
+
+	// Surface only hands out a const pointer to its data; the data itself is
+	// not const (see also pixel_row_() in draw2d/draw.cpp).
+	std::uint8_t* pixels_( Surface& aSurface ) noexcept
+	{
+		return const_cast<std::uint8_t*>( aSurface.get_surface_ptr() );
+	}
+
+	// Write the particles of a field in their own order, as whole 32-bit
+	// pixels.
+	void write_particles_( Surface& aSurface, ParticleField const& aField ) noexcept
+	{
+		auto* const pixels = pixels_( aSurface );
+		auto const width = aSurface.get_width();
+		auto const color = aField.packed_color();
+
+		aField.for_each_pixel( width, aSurface.get_height(), [&] (std::uint32_t aX, std::uint32_t aY) {
+			std::memcpy( pixels + (std::size_t(aY)*width + aX) * 4, &color, sizeof(color) );
+		} );
+	}
+
+	// Write the bucketed pixels of rows [aRowBegin, aRowEnd) of a group (see
+	// Background::draw()).
+	void write_rows_( Surface& aSurface, std::uint32_t const* aRowStart, RowPixel_ const* aRowPixels, int aRowBegin, int aRowEnd ) noexcept
+	{
+		auto* const pixels = pixels_( aSurface );
+		std::size_t const stride = std::size_t(aSurface.get_width()) * 4;
+
+		for( int y = aRowBegin; y < aRowEnd; ++y )
+		{
+			std::uint8_t* const row = pixels + std::size_t(y) * stride;
+			for( auto i = aRowStart[y]; i < aRowStart[y+1]; ++i )
+				std::memcpy( row + std::size_t(aRowPixels[i].x) * 4, &aRowPixels[i].color, sizeof(std::uint32_t) );
+		}
+	}
+}
 
 Background::Background( RNG& aRNG, std::uint32_t aImageWidth, std::uint32_t aImageHeight )
 	: mFarField{
@@ -30,15 +93,113 @@ void Background::update( Vec2f aPosition, Vec2f aMovementDelta )
 
 void Background::draw( Surface& aSurface )
 {
-	// Draw far field first
+	NO_ALLOCATION_SCOPE( "Background::draw" );
+
+	auto const height = aSurface.get_height();
+
+	std::size_t particles = mNearField.size();
 	for( auto const& pf : mFarField )
-		pf.draw( aSurface );
+		particles += pf.size();
+
+	auto const useful = std::max( std::size_t(1), particles / kMinParticlesPerThread_ );
+	auto const threads = int(std::min( std::size_t(executor_concurrency()), useful ));
+
+	// Particles are written as whole (packed 32-bit) pixels. With several
+	// threads, the particles of all layers are first bucketed by row
+	// (counting sort), and bands of rows are written by different threads.
+	// There are two groups of rows: the far layers', drawn first, and the
+	// near layer's, drawn after the earth. Bucket g*height + y holds row y of
+	// group g. Within a bucket, particles keep their order (by layer, then by
+	// index), so a pixel that several particles hit ends up with the same
+	// color as when drawing the layers one after another.
+	FrameArena::Scope scratch( frame_arena() );
+
+	std::pmr::vector<std::uint32_t> rowStart( &frame_arena() );
+	std::pmr::vector<RowPixel_> rowPixels( &frame_arena() );
+
+	if( threads > 1 )
+	{
+		PROFILE_SCOPE( "bg.sort" );
+
+		rowStart.assign( 2*std::size_t(height) + 1, 0u );
+		rowPixels.resize( particles );
+
+		auto const bucket = [&] (std::size_t aGroup, ParticleField const& aField, auto&& aBody) {
+			aField.for_each_pixel( aSurface.get_width(), height, [&] (std::uint32_t aX, std::uint32_t aY) {
+				aBody( aGroup*height + aY, aX );
+			} );
+		};
+
+		// Count, using rowStart[b+1] for bucket b.
+		auto const count = [&] (std::size_t aBucket, std::uint32_t) {
+			++rowStart[aBucket+1];
+		};
+
+		for( auto const& pf : mFarField )
+			bucket( 0, pf, count );
+		bucket( 1, mNearField, count );
+
+		for( std::size_t b = 1; b < rowStart.size(); ++b )
+			rowStart[b] += rowStart[b-1];
+
+		// Scatter, advancing rowStart[b] to the start of the next bucket.
+		// Shift the entries back afterwards.
+		auto const scatter = [&] (ParticleField const& aField) {
+			return [&rowStart, &rowPixels, color = aField.packed_color()] (std::size_t aBucket, std::uint32_t aX) {
+				rowPixels[rowStart[aBucket]++] = RowPixel_{ aX, color };
+			};
+		};
+
+		for( auto const& pf : mFarField )
+			bucket( 0, pf, scatter( pf ) );
+		bucket( 1, mNearField, scatter( mNearField ) );
+
+		for( std::size_t b = rowStart.size()-1; b > 0; --b )
+			rowStart[b] = rowStart[b-1];
+		rowStart[0] = 0;
+	}
+
+	auto const draw_group = [&] (std::size_t aGroup) {
+		if( threads <= 1 )
+		{
+			if( 0 == aGroup )
+			{
+				for( auto const& pf : mFarField )
+					write_particles_( aSurface, pf );
+			}
+			else
+			{
+				write_particles_( aSurface, mNearField );
+			}
+			return;
+		}
+
+		auto const bands = threads * kBandsPerThread_;
+		auto const bandRows = std::max( 1, (int(height) + bands - 1) / bands );
+		auto const* const start = rowStart.data() + aGroup*height;
+
+		parallel_for( 0, int(height), bandRows, [&] (int aBegin, int aEnd) {
+			write_rows_( aSurface, start, rowPixels.data(), aBegin, aEnd );
+		} );
+	};
+
+	// Draw far field first
+	{
+		PROFILE_SCOPE( "bg.far" );
+		draw_group( 0 );
+	}
 
 	// Draw earth sprite
-	blit_masked( aSurface, *mEarthSprite, kEarthCoord - mCurrentPosition );
+	{
+		PROFILE_SCOPE( "bg.earth" );
+		blit_masked( aSurface, *mEarthSprite, kEarthCoord - mCurrentPosition );
+	}
 
 	// Draw near field = dirt layer
-	mNearField.draw( aSurface );
+	{
+		PROFILE_SCOPE( "bg.near" );
+		draw_group( 1 );
+	}
 }
 
 void Background::resize( std::uint32_t aImageWidth, std::uint32_t aImageHeight )
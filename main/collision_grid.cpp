@@ -0,0 +1,631 @@
+#include "collision_grid.hpp"
+
+#include <bit>
+#include <array>
+#include <utility>
+#include <limits>
+#include <algorithm>
+
+#include <cmath>
+#include <cassert>
+
+#include "../draw2d/parallel.hpp"
+
+#include "../vmlib/simd.hpp"
+
+namespace
+{
+	// Smallest table: 2^kMinTableBits_ buckets along each axis.
+	constexpr std::uint32_t kMinTableBits_ = 3;
+
+	// Average number of bodies per bucket (at most). An empty bucket only
+	// costs an entry in the table of bucket starts, while buckets with more
+	// bodies hold more cells that are far apart.
+	constexpr double kBodiesPerBucket_ = 1.0;
+
+	// Queries test ranges of bodies in chunks of this many (see
+	// test_range_()).
+	constexpr std::uint32_t kChunk_ = 64;
+
+	Box2f circle_box_( float aX, float aY, float aRadius ) noexcept
+	{
+		return Box2f{ { aX - aRadius, aY - aRadius }, { aX + aRadius, aY + aRadius } };
+	}
+
+	// for_each_pair_parallel(): smallest number of bodies per task
+	constexpr std::uint32_t kParallelGrain_ = 1024;
+
+	// Overlapping pairs, as positions in the sorted order. Whether a test
+	// finds a pair is hard to predict; collecting the pairs without branches
+	// and reporting them in batches avoids the mispredictions.
+	constexpr std::uint32_t kPairBatch_ = 256;
+
+	struct PairBuffer_
+	{
+		using Callback = void (*)( void*, std::uint32_t const*, std::uint32_t const*, std::size_t );
+
+		PairBuffer_( Callback aCallback, void* aContext, std::uint32_t const* aOrder ) noexcept
+			: callback( aCallback )
+			, context( aContext )
+			, order( aOrder )
+		{}
+
+		Callback callback;
+		void* context;
+		std::uint32_t const* order;
+
+		std::uint32_t count = 0;
+		std::uint32_t k[kPairBatch_+8], l[kPairBatch_+8];
+
+		// Reports the pairs as body indices.
+		void flush()
+		{
+			if( 0 == count )
+				return;
+
+			for( std::uint32_t i = 0; i < count; ++i )
+			{
+				k[i] = order[k[i]];
+				l[i] = order[l[i]];
+			}
+
+			callback( context, k, l, count );
+			count = 0;
+		}
+	};
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	// Per 8-bit mask: the indices of its set bits, three bits each, lowest
+	// first. Used to move the selected lanes to the front.
+	constexpr auto kCompressLanes_ = [] {
+		std::array<std::uint32_t, 256> ret{};
+		for( std::uint32_t mask = 0; mask < 256; ++mask )
+		{
+			std::uint32_t n = 0;
+			for( std::uint32_t lane = 0; lane < 8; ++lane )
+			{
+				if( mask & (1u << lane) )
+					ret[mask] |= lane << (3*n++);
+			}
+		}
+		return ret;
+	}();
+#	endif // ~ AVX2
+
+	// Sorts aKeys by their bits [aShift, aShift+aBits), keeping the order of
+	// equal keys. The keys are few (the bodies that moved), and a comparison
+	// sort of them mostly mispredicts.
+	void radix_sort_( std::vector<std::uint64_t>& aKeys, std::vector<std::uint64_t>& aScratch, unsigned aShift, unsigned aBits )
+	{
+		aScratch.resize( aKeys.size() );
+		for( auto shift = aShift; shift < aShift + aBits; shift += 8 )
+		{
+			std::uint32_t offsets[256] = {};
+			for( auto const key : aKeys )
+				++offsets[(key >> shift) & 0xff];
+
+			std::uint32_t start = 0;
+			for( auto& offset : offsets )
+				start += std::exchange( offset, start );
+
+			for( auto const key : aKeys )
+				aScratch[offsets[(key >> shift) & 0xff]++] = key;
+
+			std::swap( aKeys, aScratch );
+		}
+	}
+
+	// Appends the pairs (aK, l) for the bodies l in [aBegin, aEnd) that
+	// overlap body aK. (Called several times per body; it must be inlined.)
+	inline
+	void test_pairs_( float const* aX, float const* aY, float const* aRadius, std::uint32_t aK, std::uint32_t aBegin, std::uint32_t aEnd, PairBuffer_& aPairs )
+	{
+		std::uint32_t l = aBegin;
+
+#		if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+		// Ranges are mostly shorter than eight bodies, and often empty.
+		// Testing eight bodies unconditionally is cheaper than a mispredicted
+		// branch. (The arrays are padded, so the loads stay inside them.)
+		__m256i const lanes = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+		__m256i const shifts = _mm256_setr_epi32( 0, 3, 6, 9, 12, 15, 18, 21 );
+		__m256 const px = _mm256_set1_ps( aX[aK] ), py = _mm256_set1_ps( aY[aK] ), pr = _mm256_set1_ps( aRadius[aK] );
+		do
+		{
+			__m256 const valid = _mm256_castsi256_ps( _mm256_cmpgt_epi32( _mm256_set1_epi32( int(aEnd - l) ), lanes ) );
+			__m256 const dx = _mm256_sub_ps( _mm256_loadu_ps( aX+l ), px );
+			__m256 const dy = _mm256_sub_ps( _mm256_loadu_ps( aY+l ), py );
+			__m256 const rr = _mm256_add_ps( _mm256_loadu_ps( aRadius+l ), pr );
+			__m256 const d2 = vmlib_detail::madd8_( dx, dx, _mm256_mul_ps( dy, dy ) );
+			__m256 const hit = _mm256_and_ps( valid, _mm256_cmp_ps( d2, _mm256_mul_ps( rr, rr ), _CMP_LE_OQ ) );
+
+			auto const mask = unsigned(_mm256_movemask_ps( hit ));
+			__m256i const select = _mm256_and_si256(
+				_mm256_srlv_epi32( _mm256_set1_epi32( int(kCompressLanes_[mask]) ), shifts ),
+				_mm256_set1_epi32( 7 )
+			);
+
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(aPairs.k + aPairs.count), _mm256_set1_epi32( int(aK) ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(aPairs.l + aPairs.count), _mm256_permutevar8x32_epi32(
+				_mm256_add_epi32( _mm256_set1_epi32( int(l) ), lanes ),
+				select
+			) );
+
+			aPairs.count += std::uint32_t(std::popcount( mask ));
+			if( aPairs.count > kPairBatch_ ) [[unlikely]]
+				aPairs.flush();
+
+			l += 8;
+		} while( l < aEnd );
+#		endif // ~ AVX2
+
+		float const x = aX[aK], y = aY[aK], r = aRadius[aK];
+		for( ; l < aEnd; ++l )
+		{
+			float const dx = aX[l] - x, dy = aY[l] - y, rr = aRadius[l] + r;
+			if( dx*dx + dy*dy <= rr*rr )
+			{
+				aPairs.k[aPairs.count] = aK;
+				aPairs.l[aPairs.count] = l;
+				if( ++aPairs.count > kPairBatch_ )
+					aPairs.flush();
+			}
+		}
+	}
+}
+
+CollisionGrid::CollisionGrid( float aCellSize )
+	: mCellSize( aCellSize )
+	, mInvCellSize( 1.f / aCellSize )
+{
+	assert( aCellSize > 0.f );
+}
+
+void CollisionGrid::update( std::size_t aCount, float const* aX, float const* aY, float const* aRadius )
+{
+	assert( aCount < kNone );
+
+	if( aCount != mBuckets.size() || mBucketStart.empty() )
+		rebuild_( aCount );
+
+	// Compute the buckets of all bodies, and collect the bodies whose bucket
+	// changed. (mMoved has room for all bodies.)
+	mMoved.clear();
+	mMovedFrom.clear();
+
+	auto const moved = [this] (std::uint32_t aBody, std::uint32_t aBucket) {
+		auto const from = mBuckets[aBody];
+		if( kNone != from )
+			--mBucketCount[from];
+
+		++mBucketCount[aBucket];
+		mBuckets[aBody] = aBucket;
+		mMoved.emplace_back( aBody );
+		mMovedFrom.emplace_back( from );
+	};
+
+	float maxRadius = 0.f;
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		__m256 const inv = _mm256_set1_ps( mInvCellSize );
+		__m256 const offx = _mm256_set1_ps( mOffset.x ), offy = _mm256_set1_ps( mOffset.y );
+		__m256i const mask = _mm256_set1_epi32( int(mTableMask) );
+		__m128i const bits = _mm_cvtsi32_si128( int(mTableBits) );
+
+		__m256 maxr = _mm256_setzero_ps();
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			__m256 const x = _mm256_add_ps( _mm256_loadu_ps( aX+i ), offx );
+			__m256 const y = _mm256_add_ps( _mm256_loadu_ps( aY+i ), offy );
+
+			__m256i const cx = _mm256_cvttps_epi32( _mm256_floor_ps( _mm256_mul_ps( x, inv ) ) );
+			__m256i const cy = _mm256_cvttps_epi32( _mm256_floor_ps( _mm256_mul_ps( y, inv ) ) );
+
+			__m256i const bucket = _mm256_or_si256(
+				_mm256_and_si256( cx, mask ),
+				_mm256_sll_epi32( _mm256_and_si256( cy, mask ), bits )
+			);
+
+			maxr = _mm256_max_ps( maxr, _mm256_loadu_ps( aRadius+i ) );
+
+			__m256i const old = _mm256_loadu_si256( reinterpret_cast<__m256i const*>(mBuckets.data()+i) );
+			unsigned const same = unsigned(_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( bucket, old ) ) ));
+			if( 0xffu == same )
+				continue;
+
+			alignas(32) std::uint32_t buckets[8];
+			_mm256_store_si256( reinterpret_cast<__m256i*>(buckets), bucket );
+
+			for( unsigned changed = ~same & 0xffu; changed; changed &= changed-1 )
+			{
+				auto const lane = unsigned(std::countr_zero( changed ));
+				moved( std::uint32_t(i + lane), buckets[lane] );
+			}
+		}
+
+		__m128 m = _mm_max_ps( _mm256_castps256_ps128( maxr ), _mm256_extractf128_ps( maxr, 1 ) );
+		m = _mm_max_ps( m, _mm_movehl_ps( m, m ) );
+		m = _mm_max_ss( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE(1,1,1,1) ) );
+		maxRadius = _mm_cvtss_f32( m );
+	}
+#	endif // ~ AVX2
+
+	for( ; i < aCount; ++i )
+	{
+		maxRadius = std::max( maxRadius, aRadius[i] );
+
+		auto const bucket = bucket_( cell_( aX[i] + mOffset.x ), cell_( aY[i] + mOffset.y ) );
+		if( bucket != mBuckets[i] )
+			moved( std::uint32_t(i), bucket );
+	}
+
+	mMaxRadius = maxRadius;
+
+	if( !mMoved.empty() )
+		reorder_();
+
+	// Copy the bodies into the sorted arrays. Gathering from the input in
+	// the sorted order is faster than scattering into the sorted arrays.
+	std::size_t k = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		__m256 const offx = _mm256_set1_ps( mOffset.x ), offy = _mm256_set1_ps( mOffset.y );
+
+		for( ; k + 8 <= aCount; k += 8 )
+		{
+			__m256i const indices = _mm256_loadu_si256( reinterpret_cast<__m256i const*>(mOrder.data()+k) );
+
+			_mm256_storeu_ps( mX.data()+k, _mm256_add_ps( _mm256_i32gather_ps( aX, indices, 4 ), offx ) );
+			_mm256_storeu_ps( mY.data()+k, _mm256_add_ps( _mm256_i32gather_ps( aY, indices, 4 ), offy ) );
+			_mm256_storeu_ps( mRadius.data()+k, _mm256_i32gather_ps( aRadius, indices, 4 ) );
+		}
+	}
+#	endif // ~ AVX2
+
+	for( ; k < aCount; ++k )
+	{
+		auto const body = mOrder[k];
+		mX[k] = aX[body] + mOffset.x;
+		mY[k] = aY[body] + mOffset.y;
+		mRadius[k] = aRadius[body];
+	}
+}
+
+void CollisionGrid::update( Vec2fBatch const& aCenters, std::vector<float> const& aRadii )
+{
+	assert( aCenters.size() == aRadii.size() );
+	update( aCenters.size(), aCenters.x.data(), aCenters.y.data(), aRadii.data() );
+}
+
+void CollisionGrid::translate( Vec2f aOffset ) noexcept
+{
+	// The bodies keep their "world" positions, and thus their buckets.
+	mOffset -= aOffset;
+
+	// Buckets repeat every (table size) cells. Once the offset grows past
+	// that, remove whole periods from it, and from the stored positions.
+	float const period = mCellSize * float(1u << mTableBits);
+
+	Vec2f shift{ 0.f, 0.f };
+	if( std::abs( mOffset.x ) >= period )
+		shift.x = mOffset.x - std::fmod( mOffset.x, period );
+	if( std::abs( mOffset.y ) >= period )
+		shift.y = mOffset.y - std::fmod( mOffset.y, period );
+
+	if( 0.f != shift.x || 0.f != shift.y )
+	{
+		mOffset -= shift;
+
+		for( auto& x : mX )
+			x -= shift.x;
+		for( auto& y : mY )
+			y -= shift.y;
+	}
+}
+
+std::size_t CollisionGrid::size() const noexcept
+{
+	return mBuckets.size();
+}
+
+
+template< typename tHit > inline
+void CollisionGrid::test_range_( std::uint32_t aBegin, std::uint32_t aEnd, Box2f const& aBox, tHit&& aHit ) const
+{
+	// Prefilter: bodies whose circles overlap the box. Bodies that overlap
+	// a circle inside the box are among them.
+	std::uint32_t found[kChunk_];
+	for( auto begin = aBegin; begin < aEnd; begin += kChunk_ )
+	{
+		auto const count = std::min( aEnd - begin, kChunk_ );
+		auto const hits = circles_in_box( count, mX.data()+begin, mY.data()+begin, mRadius.data()+begin, aBox, found );
+
+		for( std::size_t i = 0; i < hits; ++i )
+			aHit( begin + found[i] );
+	}
+}
+
+template< typename tRange > inline
+void CollisionGrid::row_ranges_( std::int32_t aCellX0, std::int32_t aCellX1, std::int32_t aCellY, tRange&& aRange ) const
+{
+	assert( aCellX1 >= aCellX0 && std::uint32_t(aCellX1 - aCellX0) <= mTableMask );
+
+	auto const side = std::uint32_t(1) << mTableBits;
+	auto const row = (std::uint32_t(aCellY) & mTableMask) << mTableBits;
+
+	auto const x0 = std::uint32_t(aCellX0) & mTableMask;
+	auto const x1 = x0 + std::uint32_t(aCellX1 - aCellX0); // may be past the table
+
+	if( x1 < side )
+	{
+		aRange( mBucketStart[row + x0], mBucketStart[row + x1 + 1] );
+	}
+	else
+	{
+		aRange( mBucketStart[row + x0], mBucketStart[row + side] );
+		aRange( mBucketStart[row], mBucketStart[row + x1 - side + 1] );
+	}
+}
+
+void CollisionGrid::overlaps_( Vec2f aCenter, float aRadius, OverlapFn_ aCallback, void* aContext ) const
+{
+	if( mOrder.empty() )
+		return;
+
+	Vec2f const center = aCenter + mOffset;
+	if( !std::isfinite( center.x ) || !std::isfinite( center.y ) )
+		return;
+
+	auto const box = circle_box_( center.x, center.y, aRadius );
+	auto const hit = [&] (std::uint32_t aK) {
+		float const dx = mX[aK] - center.x;
+		float const dy = mY[aK] - center.y;
+		float const rr = mRadius[aK] + aRadius;
+		if( dx*dx + dy*dy <= rr*rr )
+			aCallback( aContext, mOrder[aK] );
+	};
+
+	// Bodies that overlap the circle have their centers within this distance
+	// of its center. If the cells within that distance span the table (or if
+	// the distance is invalid, e.g., NaN), test all bodies.
+	float const reach = aRadius + mMaxRadius;
+
+	auto const side = std::uint32_t(1) << mTableBits;
+	if( !(2.f*reach*mInvCellSize + 2.f < float(side)) )
+	{
+		test_range_( 0, std::uint32_t(mOrder.size()), box, hit );
+		return;
+	}
+
+	// Fewer cells than the table's size along each axis, so each cell maps
+	// to a different bucket.
+	auto const x0 = cell_( center.x - reach ), x1 = cell_( center.x + reach );
+	auto const y0 = cell_( center.y - reach ), y1 = cell_( center.y + reach );
+
+	for( auto cy = y0; cy <= y1; ++cy )
+	{
+		row_ranges_( x0, x1, cy, [&] (std::uint32_t aBegin, std::uint32_t aEnd) {
+			test_range_( aBegin, aEnd, box, hit );
+		} );
+	}
+}
+
+template< typename tPairs > inline
+void CollisionGrid::pairs_range_( std::uint32_t aBegin, std::uint32_t aEnd, std::int32_t aReach, tPairs& aPairs ) const
+{
+	auto const side = std::int32_t(1) << mTableBits;
+
+	// One pass over the sorted bodies, which knows each body's bucket; most
+	// buckets hold zero or one bodies, so a pass over the buckets would
+	// mostly mispredict whether the next one is empty.
+	for( auto k = aBegin; k < aEnd; ++k )
+	{
+		auto const range = [&] (std::uint32_t aRangeBegin, std::uint32_t aRangeEnd) {
+			test_pairs_( mX.data(), mY.data(), mRadius.data(), k, aRangeBegin, aRangeEnd, aPairs );
+		};
+
+		auto const bucket = mOrderBuckets[k];
+		auto const bx = std::int32_t(bucket & mTableMask);
+		auto const by = std::int32_t(bucket >> mTableBits);
+
+		// Own row: the bodies after this one in its bucket, and the buckets
+		// to the right of it.
+		auto const row = bucket - std::uint32_t(bx);
+		if( bx + aReach < side )
+		{
+			range( k+1, mBucketStart[row + std::uint32_t(bx + aReach) + 1] );
+		}
+		else
+		{
+			range( k+1, mBucketStart[row + std::uint32_t(side)] );
+			range( mBucketStart[row], mBucketStart[row + std::uint32_t(bx + aReach - side) + 1] );
+		}
+
+		// Rows below
+		for( std::int32_t dy = 1; dy <= aReach; ++dy )
+			row_ranges_( bx-aReach, bx+aReach, by+dy, range );
+	}
+}
+
+void CollisionGrid::pairs_( PairFn_ aCallback, void* aContext, bool aParallel ) const
+{
+	if( mOrder.empty() )
+		return;
+
+	// Overlapping bodies are at most 2*mMaxRadius apart, i.e., their cells
+	// differ by at most `reach` along each axis. The bodies of each bucket
+	// look for partners in their own bucket and in the buckets of the half
+	// of that neighbourhood that follows it in row-major order. The latter
+	// buckets are all different from each other if the table is larger than
+	// the neighbourhood; otherwise, all pairs of bodies are tested.
+	auto const side = std::int32_t(1) << mTableBits;
+	auto const count = std::uint32_t(mOrder.size());
+
+	float const reachf = std::ceil( 2.f*mMaxRadius*mInvCellSize );
+	bool const allPairs = !(2.f*reachf + 2.f <= float(side));
+
+	auto const reach = std::int32_t(reachf);
+
+	// Each body finds its pairs with the bodies that follow it, so ranges of
+	// bodies can be searched independently.
+	auto const search = [&] (int aBegin, int aEnd) {
+		PairBuffer_ pairs( aCallback, aContext, mOrder.data() );
+
+		if( allPairs )
+		{
+			for( auto k = std::uint32_t(aBegin); k < std::uint32_t(aEnd); ++k )
+				test_pairs_( mX.data(), mY.data(), mRadius.data(), k, k+1, count, pairs );
+		}
+		else
+		{
+			pairs_range_( std::uint32_t(aBegin), std::uint32_t(aEnd), reach, pairs );
+		}
+
+		pairs.flush();
+	};
+
+	if( !aParallel )
+	{
+		search( 0, int(count) );
+		return;
+	}
+
+	// A few tasks per thread, so that threads that finish early can steal
+	// the remaining ones; pairs are not spread evenly over the bodies.
+	auto const tasks = 4u * executor_concurrency();
+	parallel_for( 0, int(count), int(std::max( kParallelGrain_, (count + tasks-1) / tasks )), search );
+}
+
+void CollisionGrid::rebuild_( std::size_t aCount )
+{
+	auto const side = std::bit_ceil( std::size_t(std::ceil( std::sqrt( double(aCount) / kBodiesPerBucket_ ) )) );
+	mTableBits = std::max( kMinTableBits_, std::uint32_t(std::countr_zero( side )) );
+	mTableMask = (std::uint32_t(1) << mTableBits) - 1;
+
+	// No body is in a bucket yet, so all of them are "moved" into theirs by
+	// the next update(). The scratch arrays are sized such that update()
+	// never allocates.
+	auto const buckets = std::size_t(1) << (2*mTableBits);
+	mBucketStart.assign( buckets+1, 0 );
+	mBucketCount.assign( buckets, 0 );
+	mBuckets.assign( aCount, kNone );
+
+	mOrder.clear();
+	mOrder.reserve( aCount );
+	mOrderBuckets.clear();
+	mOrderBuckets.reserve( aCount );
+	mNextOrder.reserve( aCount );
+	mNextOrderBuckets.reserve( aCount );
+	mX.resize( aCount+8 );
+	mY.resize( aCount+8 );
+	mRadius.resize( aCount+8 );
+
+	mMoved.clear();
+	mMoved.reserve( aCount );
+	mMovedFrom.reserve( aCount );
+	mRemoved.reserve( aCount );
+	mArrivals.reserve( aCount );
+	mSortScratch.reserve( aCount );
+
+	// All bodies are reinserted, so any offset will do.
+	mOffset = Vec2f{ 0.f, 0.f };
+}
+
+void CollisionGrid::reorder_()
+{
+	// Positions of the bodies that left their buckets. A bucket holds few
+	// bodies, so a search of its range finds them quickly.
+	mRemoved.clear();
+	for( std::size_t i = 0; i < mMoved.size(); ++i )
+	{
+		auto const from = mMovedFrom[i];
+		if( kNone == from )
+			continue;
+
+		auto k = mBucketStart[from];
+		while( mOrder[k] != mMoved[i] )
+			++k;
+
+		assert( k < mBucketStart[from+1] );
+		mRemoved.emplace_back( k );
+	}
+
+	radix_sort_( mRemoved, mSortScratch, 0, unsigned(std::bit_width( mOrder.size() )) );
+
+	// Arrivals, by their new buckets. mMoved is sorted by index, which the
+	// (stable) sort keeps for the bodies of each bucket.
+	mArrivals.clear();
+	for( auto const body : mMoved )
+		mArrivals.emplace_back( (std::uint64_t(mBuckets[body]) << 32) | body );
+
+	radix_sort_( mArrivals, mSortScratch, 32, 2*mTableBits );
+
+	// Merge: copy the runs of bodies that stayed, and insert the arrivals at
+	// the ends of their buckets' old ranges. Most bodies stay, so this mostly
+	// copies long runs.
+	auto const count = mBuckets.size();
+	mNextOrder.resize( count );
+	mNextOrderBuckets.resize( count );
+
+	std::uint32_t src = 0, out = 0;
+	auto const copy = [&] (std::uint32_t aEnd) {
+		auto const n = aEnd - src;
+		std::copy_n( mOrder.data()+src, n, mNextOrder.data()+out );
+		std::copy_n( mOrderBuckets.data()+src, n, mNextOrderBuckets.data()+out );
+		src = aEnd;
+		out += n;
+	};
+
+	std::size_t removed = 0, arrived = 0;
+	while( removed < mRemoved.size() || arrived < mArrivals.size() )
+	{
+		auto const removal = removed < mRemoved.size() ? std::uint32_t(mRemoved[removed]) : kNone;
+
+		auto const bucket = arrived < mArrivals.size() ? std::uint32_t(mArrivals[arrived] >> 32) : kNone;
+		auto const arrival = kNone != bucket ? mBucketStart[bucket+1] : kNone;
+
+		// An arrival goes before the body at its position, which is in a
+		// later bucket, even if that body leaves.
+		if( arrival <= removal )
+		{
+			copy( arrival );
+			mNextOrder[out] = std::uint32_t(mArrivals[arrived]);
+			mNextOrderBuckets[out] = bucket;
+			++out;
+			++arrived;
+		}
+		else
+		{
+			copy( removal );
+			++src;
+			++removed;
+		}
+	}
+
+	copy( std::uint32_t(mOrder.size()) );
+
+	assert( out == count );
+	std::swap( mOrder, mNextOrder );
+	std::swap( mOrderBuckets, mNextOrderBuckets );
+
+	// Bucket starts from the counts
+	std::uint32_t start = 0;
+	for( std::size_t b = 0; b < mBucketCount.size(); ++b )
+	{
+		mBucketStart[b] = start;
+		start += mBucketCount[b];
+	}
+	mBucketStart.back() = start;
+}
+
+std::int32_t CollisionGrid::cell_( float aCoord ) const noexcept
+{
+	return std::int32_t(std::floor( aCoord * mInvCellSize ));
+}
+
+std::uint32_t CollisionGrid::bucket_( std::int32_t aCellX, std::int32_t aCellY ) const noexcept
+{
+	return (std::uint32_t(aCellX) & mTableMask) | ((std::uint32_t(aCellY) & mTableMask) << mTableBits);
+}
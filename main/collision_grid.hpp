@@ -0,0 +1,201 @@
+#ifndef COLLISION_GRID_HPP_502138E2_B2D7_4F74_9716_E07A4132BA32
+#define COLLISION_GRID_HPP_502138E2_B2D7_4F74_9716_E07A4132BA32
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/vec2_batch.hpp"
+
+/** CollisionGrid : broad phase for collisions between circles
+ *
+ * The bodies are circles, identified by their index in the arrays passed to
+ * update(). The grid divides the plane into square cells, and hashes each
+ * body into a bucket based on the cell that contains its center. The hash is
+ * the cell's coordinates modulo the size of the table of buckets (a power of
+ * two along each axis), i.e., the plane is folded onto the table like onto a
+ * torus. Neighbouring cells thus map to neighbouring buckets, and the plane
+ * is unbounded. Cells that are a table's size apart share a bucket; this only
+ * costs a few extra narrow phase tests.
+ *
+ * update() is incremental. The bodies are kept sorted by bucket, and each
+ * body remembers its bucket. Only the bodies that moved into a different
+ * bucket are sorted anew and merged back into the order; if the number of
+ * bodies changes, all bodies are inserted anew. Positions may be relative to
+ * a moving origin, such as the screen: translate() moves all bodies at once.
+ *
+ * The bodies' centers and radii are stored as SoA, in the same order, so the
+ * bodies of a bucket are a contiguous range, as are the bodies of a row of
+ * neighbouring buckets. for_each_overlap() first finds the bodies of such a
+ * range that overlap the bounding box of the circle (circles_in_box() from
+ * vmlib), and then tests only those exactly. for_each_pair() tests each body
+ * against the ranges of its neighbourhood directly, eight bodies at a time;
+ * the ranges are short, so a prefilter would not save any work there.
+ *
+ * Queries:
+ *  - for_each_overlap() finds the bodies that overlap a circle (e.g., the
+ *    spaceship)
+ *  - for_each_pair() finds all pairs of overlapping bodies
+ *  - for_each_pair_parallel() does the same, split across the threads of
+ *    the executor (see draw2d/parallel.hpp)
+ *
+ * Circles that touch count as overlapping. The table has about one bucket
+ * per body. If the bodies are large compared to the table (more than about
+ * half as wide, in cells), for_each_pair() tests all pairs.
+ */
+class CollisionGrid
+{
+	public:
+		// Cells should be at least as large as the bodies (twice the largest
+		// radius); smaller cells work, but make queries visit more cells.
+		explicit CollisionGrid( float aCellSize = 128.f );
+
+	public:
+		/* Update the bodies: body i is the circle with center (aX[i], aY[i])
+		 * and radius aRadius[i]. The grid keeps a copy.
+		 */
+		void update( std::size_t aCount, float const* aX, float const* aY, float const* aRadius );
+		void update( Vec2fBatch const& aCenters, std::vector<float> const& aRadii );
+
+		/* Move the origin of the positions by -aOffset, i.e., a body that
+		 * does not move has its position plus aOffset in the next update().
+		 * Such bodies keep their buckets. Queries until then use the new
+		 * origin; the bodies' positions are shifted by aOffset.
+		 */
+		void translate( Vec2f aOffset ) noexcept;
+
+		std::size_t size() const noexcept;
+
+		/* Call aCallback( i ) with the index of each body that overlaps the
+		 * circle (aCenter, aRadius).
+		 */
+		template< typename tCallback >
+		void for_each_overlap( Vec2f aCenter, float aRadius, tCallback&& aCallback ) const;
+
+		/* Call aCallback( i, j ) for each pair of overlapping bodies i and j,
+		 * once per pair (with either i < j or i > j).
+		 */
+		template< typename tCallback >
+		void for_each_pair( tCallback&& aCallback ) const;
+
+		/* As for_each_pair(), but with the bodies split into ranges that the
+		 * current executor's threads search concurrently. The pairs are
+		 * reported in batches, by calls aCallback( aFirst, aSecond, aCount )
+		 * for the pairs aFirst[i], aSecond[i] with i < aCount. These calls
+		 * are concurrent, from different threads.
+		 */
+		template< typename tCallback >
+		void for_each_pair_parallel( tCallback&& aCallback ) const;
+
+	private:
+		using OverlapFn_ = void (*)( void*, std::uint32_t );
+		using PairFn_ = void (*)( void*, std::uint32_t const*, std::uint32_t const*, std::size_t );
+
+		void overlaps_( Vec2f aCenter, float aRadius, OverlapFn_, void* ) const;
+		void pairs_( PairFn_, void*, bool aParallel ) const;
+
+		// Calls aHit( k ) for the bodies k in [aBegin, aEnd) (positions in
+		// the sorted order) that overlap aBox.
+		template< typename tHit >
+		void test_range_( std::uint32_t aBegin, std::uint32_t aEnd, Box2f const& aBox, tHit&& aHit ) const;
+
+		// Calls aRange( begin, end ) for the bodies in the buckets of the
+		// cells [aCellX0, aCellX1] of row aCellY: one range, or two if the
+		// cells wrap around the table. The cells must map to different
+		// buckets.
+		template< typename tRange >
+		void row_ranges_( std::int32_t aCellX0, std::int32_t aCellX1, std::int32_t aCellY, tRange&& aRange ) const;
+
+		// Appends the pairs of the bodies [aBegin, aEnd) (positions in the
+		// sorted order) with the bodies that follow them in their
+		// neighbourhoods (see pairs_()) to aPairs.
+		template< typename tPairs >
+		void pairs_range_( std::uint32_t aBegin, std::uint32_t aEnd, std::int32_t aReach, tPairs& aPairs ) const;
+
+		void rebuild_( std::size_t aCount );
+		void reorder_();
+
+		std::int32_t cell_( float aCoord ) const noexcept;
+		std::uint32_t bucket_( std::int32_t aCellX, std::int32_t aCellY ) const noexcept;
+
+	private:
+		static constexpr std::uint32_t kNone = ~std::uint32_t(0);
+
+		float mCellSize, mInvCellSize;
+
+		// Added to positions to get the "world" positions that the cells are
+		// based on. Kept smaller than the hash's period.
+		Vec2f mOffset{ 0.f, 0.f };
+
+		float mMaxRadius = 0.f;
+
+		// The table has 2^mTableBits buckets along each axis.
+		std::uint32_t mTableBits = 0;
+		std::uint32_t mTableMask = 0;
+
+		// Per body: its bucket.
+		std::vector<std::uint32_t> mBuckets;
+
+		// Bodies sorted by bucket. The bodies of bucket b are the elements
+		// [mBucketStart[b], mBucketStart[b+1]) of mOrder. Their buckets,
+		// "world" positions and radii are at the same positions in
+		// mOrderBuckets, mX, mY and mRadius.
+		std::vector<std::uint32_t> mBucketStart;
+		std::vector<std::uint32_t> mOrder, mOrderBuckets;
+		std::vector<float> mX, mY, mRadius;
+
+		std::vector<std::uint32_t> mBucketCount;
+
+		// Scratch, used in update()
+		std::vector<std::uint32_t> mMoved, mMovedFrom; // bodies, old buckets
+		std::vector<std::uint64_t> mRemoved; // positions in mOrder
+		std::vector<std::uint64_t> mArrivals; // bucket << 32 | body
+		std::vector<std::uint64_t> mSortScratch;
+		std::vector<std::uint32_t> mNextOrder, mNextOrderBuckets;
+};
+
+
+template< typename tCallback > inline
+void CollisionGrid::for_each_overlap( Vec2f aCenter, float aRadius, tCallback&& aCallback ) const
+{
+	struct Context_
+	{
+		tCallback& callback;
+	} context{ aCallback };
+
+	overlaps_( aCenter, aRadius, [] (void* aContext, std::uint32_t aBody) {
+		static_cast<Context_*>(aContext)->callback( aBody );
+	}, &context );
+}
+
+template< typename tCallback > inline
+void CollisionGrid::for_each_pair( tCallback&& aCallback ) const
+{
+	struct Context_
+	{
+		tCallback& callback;
+	} context{ aCallback };
+
+	pairs_( [] (void* aContext, std::uint32_t const* aA, std::uint32_t const* aB, std::size_t aCount) {
+		auto& callback = static_cast<Context_*>(aContext)->callback;
+		for( std::size_t i = 0; i < aCount; ++i )
+			callback( aA[i], aB[i] );
+	}, &context, false );
+}
+
+template< typename tCallback > inline
+void CollisionGrid::for_each_pair_parallel( tCallback&& aCallback ) const
+{
+	struct Context_
+	{
+		tCallback& callback;
+	} context{ aCallback };
+
+	pairs_( [] (void* aContext, std::uint32_t const* aA, std::uint32_t const* aB, std::size_t aCount) {
+		static_cast<Context_*>(aContext)->callback( aA, aB, aCount );
+	}, &context, true );
+}
+
+#endif // COLLISION_GRID_HPP_502138E2_B2D7_4F74_9716_E07A4132BA32
@@ -0,0 +1,351 @@
+#include "impostor_cache.hpp"
+
+#include <numbers>
+#include <algorithm>
+
+#include <cmath>
+#include <cstring>
+#include <cassert>
+
+#include "../draw2d/shape.hpp"
+
+#include "../vmlib/mat22.hpp"
+
+namespace
+{
+	std::uint32_t sprite_size_( float aRadius ) noexcept
+	{
+		return 2u*std::uint32_t(std::ceil( aRadius )) + 2u;
+	}
+
+	std::uint32_t class_size_( std::uint32_t aSpriteSize ) noexcept
+	{
+		constexpr auto step = ImpostorCache::kSizeStep;
+		return (aSpriteSize + step-1) / step * step;
+	}
+}
+
+ImpostorCache::ImpostorCache( std::uint32_t aAngleCount, std::size_t aBudgetBytes )
+	: mAngleCount( aAngleCount )
+	, mBudgetBytes( aBudgetBytes )
+{
+	assert( aAngleCount > 0 );
+
+	mWorker = std::jthread( [this] { worker_(); } );
+}
+
+ImpostorCache::~ImpostorCache()
+{
+	{
+		std::scoped_lock lock( mMutex );
+		mStop = true;
+	}
+
+	mWake.notify_all();
+	// mWorker joins
+}
+
+
+void ImpostorCache::assign( std::size_t aCount, TriangleFan const* aShapes, float const* aRadii )
+{
+	clear();
+
+	assert( aCount < kNone / mAngleCount );
+	assert( 0 == aCount || (aShapes && aRadii) );
+
+	mShapes = aShapes;
+	mRadii = aRadii;
+	mShapeCount = aCount;
+
+	mEntries.assign( aCount * mAngleCount, kNone );
+
+	// Size classes, and the class of each shape
+	std::vector<std::uint32_t> sizes( aCount );
+	for( std::size_t i = 0; i < aCount; ++i )
+		sizes[i] = class_size_( sprite_size_( aRadii[i] ) );
+
+	std::vector<std::uint32_t> classSizes( sizes );
+	std::sort( classSizes.begin(), classSizes.end() );
+	classSizes.erase( std::unique( classSizes.begin(), classSizes.end() ), classSizes.end() );
+
+	std::vector<std::uint32_t> shapesPerClass( classSizes.size(), 0 );
+	mShapeClasses.resize( aCount );
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		auto const it = std::lower_bound( classSizes.begin(), classSizes.end(), sizes[i] );
+		mShapeClasses[i] = std::uint32_t(it - classSizes.begin());
+		++shapesPerClass[mShapeClasses[i]];
+	}
+
+	mClasses.clear();
+	for( auto const size : classSizes )
+		mClasses.emplace_back( Class_{ size, 0, 0, 0, 0 } );
+
+	// The same number of slots per shape in each class: as many as fit into
+	// the budget, but no more than there are angles, and at least one slot
+	// per class.
+	double bytesPerSlotPerShape = 0.0;
+	for( std::size_t c = 0; c < mClasses.size(); ++c )
+		bytesPerSlotPerShape += double(shapesPerClass[c]) * double(mClasses[c].size) * double(mClasses[c].size) * 4.0;
+
+	double const slotsPerShape = bytesPerSlotPerShape > 0.0
+		? std::min( double(mBudgetBytes) / bytesPerSlotPerShape, double(mAngleCount) )
+		: 0.0
+	;
+
+	std::size_t pixels = 0;
+	mSlotCount = 0;
+	for( std::size_t c = 0; c < mClasses.size(); ++c )
+	{
+		auto& cls = mClasses[c];
+		auto const slots = std::max<std::size_t>( std::size_t(double(shapesPerClass[c]) * slotsPerShape), 1 );
+
+		cls.first = cls.unused = cls.hand = std::uint32_t(mSlotCount);
+		cls.end = std::uint32_t(mSlotCount + slots);
+
+		mSlotCount += slots;
+		pixels += slots * cls.size * cls.size;
+	}
+
+	mSlots = std::make_unique<Slot_[]>( mSlotCount );
+	mPixels.assign( pixels, 0u );
+	mQueue.assign( mSlotCount, kNone );
+
+	std::size_t offset = 0;
+	for( auto const& cls : mClasses )
+	{
+		for( auto i = cls.first; i < cls.end; ++i )
+		{
+			auto& slot = mSlots[i];
+			slot.pixels = mPixels.data() + offset;
+			slot.key = kNone;
+			slot.lastUse = 0;
+			slot.sprite.set( 0, 0, reinterpret_cast<std::uint8_t*>(slot.pixels) );
+
+			offset += std::size_t(cls.size) * cls.size;
+		}
+	}
+
+	mFrame = 0;
+	mBuilds = 0;
+
+	mStatsFrame = 0;
+	mWarm = false;
+	mCounts = mStats = Stats{};
+
+	auto const scratch = mClasses.empty() ? 1u : mClasses.back().size;
+	if( mScratch.get_width() < scratch )
+		mScratch = Surface( scratch, scratch );
+}
+
+void ImpostorCache::clear()
+{
+	// Drop the queued sprites, and wait for the one being built.
+	{
+		std::unique_lock lock( mMutex );
+		mQueueHead = 0;
+		mQueueSize = 0;
+
+		mIdle.wait( lock, [this] { return !mRendering; } );
+	}
+
+	mShapes = nullptr;
+	mRadii = nullptr;
+	mShapeCount = 0;
+
+	std::fill( mEntries.begin(), mEntries.end(), kNone );
+
+	for( std::size_t i = 0; i < mSlotCount; ++i )
+	{
+		mSlots[i].key = kNone;
+		mSlots[i].ready.store( false, std::memory_order_relaxed );
+	}
+
+	for( auto& cls : mClasses )
+		cls.unused = cls.hand = cls.first;
+}
+
+ImageRGBA const* ImpostorCache::find( std::uint32_t aShape, std::uint32_t aAngle )
+{
+	assert( aShape < mShapeCount && aAngle < mAngleCount );
+
+	++mCounts.lookups;
+
+	auto const key = aShape * mAngleCount + aAngle;
+	auto& entry = mEntries[key];
+
+	if( kNone != entry )
+	{
+		auto& slot = mSlots[entry];
+		if( !slot.ready.load( std::memory_order_acquire ) )
+			return nullptr; // queued
+
+		slot.lastUse = mFrame;
+		++mCounts.hits;
+		return &slot.sprite;
+	}
+
+	if( mBuilds >= kBuildsPerFrame )
+		return nullptr;
+
+	auto const index = acquire_slot_( mClasses[mShapeClasses[aShape]] );
+	if( kNone == index )
+		return nullptr; // all slots are queued or in use
+
+	auto& slot = mSlots[index];
+	if( kNone != slot.key )
+		mEntries[slot.key] = kNone;
+
+	slot.key = key;
+	slot.lastUse = mFrame;
+	slot.ready.store( false, std::memory_order_relaxed );
+	entry = index;
+
+	++mBuilds;
+
+	{
+		std::scoped_lock lock( mMutex );
+		assert( mQueueSize < mSlotCount );
+
+		mQueue[(mQueueHead + mQueueSize) % mSlotCount] = index;
+		++mQueueSize;
+	}
+
+	mWake.notify_one();
+	return nullptr;
+}
+
+void ImpostorCache::next_frame() noexcept
+{
+	++mFrame;
+	mBuilds = 0;
+
+	if( ++mStatsFrame < kStatsFrames )
+		return;
+
+	if( mWarm )
+		mStats = mCounts;
+
+	mWarm = true;
+	mStatsFrame = 0;
+	mCounts = Stats{};
+}
+
+ImpostorCache::Stats ImpostorCache::stats() const noexcept
+{
+	return mStats;
+}
+
+std::uint32_t ImpostorCache::angle_count() const noexcept
+{
+	return mAngleCount;
+}
+std::size_t ImpostorCache::slot_count() const noexcept
+{
+	return mSlotCount;
+}
+
+std::uint32_t ImpostorCache::acquire_slot_( Class_& aClass ) noexcept
+{
+	if( aClass.unused < aClass.end )
+		return aClass.unused++;
+
+	// A complete sprite that was not used recently. Queued slots are (still)
+	// owned by the background thread. Sweeping the slots like a clock hand
+	// finds one in a few steps if there are many, unlike a search for the
+	// least recently used one.
+	auto const count = aClass.end - aClass.first;
+	for( std::uint32_t i = 0; i < count; ++i )
+	{
+		auto const index = aClass.hand;
+		aClass.hand = aClass.end == index+1 ? aClass.first : index+1;
+
+		auto const& slot = mSlots[index];
+		if( slot.lastUse + kKeepFrames <= mFrame && slot.ready.load( std::memory_order_acquire ) )
+			return index;
+	}
+
+	return kNone;
+}
+
+void ImpostorCache::worker_()
+{
+	std::unique_lock lock( mMutex );
+
+	for( ;; )
+	{
+		mWake.wait( lock, [this] { return mStop || 0 != mQueueSize; } );
+		if( mStop )
+			return;
+
+		auto const index = mQueue[mQueueHead];
+		mQueueHead = (mQueueHead + 1) % mSlotCount;
+		--mQueueSize;
+
+		mRendering = true;
+		lock.unlock();
+
+		auto& slot = mSlots[index];
+		render_( slot );
+		slot.ready.store( true, std::memory_order_release );
+
+		lock.lock();
+		mRendering = false;
+		mIdle.notify_all();
+	}
+}
+
+void ImpostorCache::render_( Slot_& aSlot ) noexcept
+{
+	auto const shape = aSlot.key / mAngleCount;
+	auto const angle = aSlot.key % mAngleCount;
+
+	auto const size = sprite_size_( mRadii[shape] );
+	assert( size <= mClasses[mShapeClasses[shape]].size && size <= mScratch.get_width() );
+
+	auto const rotation = make_rotation_2d( 2.f*std::numbers::pi_v<float> * float(angle) / float(mAngleCount) );
+	Vec2f const origin{ float(size/2), float(size/2) };
+
+	// Draw the shape once, onto black pixels whose padding byte is set. The
+	// rasterizer writes whole pixels, with a zero padding byte, except in
+	// its (rare) floating point fallback, which writes r, g and b only;
+	// pixels that keep the padding byte are covered if they are not black.
+	// (Surface only hands out a const pointer to its data, which itself is
+	// not const.)
+	constexpr std::uint32_t kMarker = 0xff000000u;
+
+	auto* const scratch = const_cast<std::uint8_t*>(mScratch.get_surface_ptr());
+	for( std::uint32_t y = 0; y < size; ++y )
+	{
+		auto* const row = scratch + std::size_t(mScratch.get_linear_index( 0, y ))*4;
+		for( std::uint32_t x = 0; x < size; ++x )
+			std::memcpy( row + x*4, &kMarker, sizeof(kMarker) );
+	}
+
+	mShapes[shape].draw( mScratch, rotation, origin );
+
+	// Surface pixels are RGBx, sprite pixels RGBA (little endian).
+	auto* const pixels = aSlot.pixels;
+	for( std::uint32_t y = 0; y < size; ++y )
+	{
+		auto const* const row = scratch + std::size_t(mScratch.get_linear_index( 0, y ))*4;
+		for( std::uint32_t x = 0; x < size; ++x )
+		{
+			std::uint32_t pixel;
+			std::memcpy( &pixel, row + x*4, sizeof(pixel) );
+
+			bool const covered = 0 == (pixel & kMarker) || 0 != (pixel & ~kMarker);
+			pixels[y*size + x] = (pixel & ~kMarker) | (covered ? 0xff000000u : 0u);
+		}
+	}
+
+	aSlot.sprite.set( size, size, reinterpret_cast<std::uint8_t*>(pixels) );
+}
+
+
+void ImpostorCache::Sprite_::set( Index aWidth, Index aHeight, std::uint8_t* aData ) noexcept
+{
+	mWidth = aWidth;
+	mHeight = aHeight;
+	mData = aData;
+}
@@ -0,0 +1,184 @@
+#ifndef IMPOSTOR_CACHE_HPP_B3103C74_A0BE_46DA_93B8_F6BE1079AC21
+#define IMPOSTOR_CACHE_HPP_B3103C74_A0BE_46DA_93B8_F6BE1079AC21
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../draw2d/image.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/forward.hpp"
+
+/** ImpostorCache : pre-rasterized rotations of triangle fans
+ *
+ * An impostor (sprite) is a shape rasterized once at a fixed rotation into a
+ * small RGBA image, whose alpha marks the pixels that the shape covers.
+ * Drawing the image with blit_masked() replaces rasterizing the shape, as
+ * long as the shape's rotation is close to the sprite's. The cache holds
+ * sprites for K rotations per shape (angle index k is the rotation by
+ * 2*pi*k/K radians, see make_rotation_2d()).
+ *
+ * Sprites are built lazily: find() returns nullptr for a sprite that does
+ * not exist yet, and queues it to be built by the cache's background thread.
+ * The caller draws the shape itself in the meantime. At most
+ * kBuildsPerFrame sprites are queued per frame (see next_frame()).
+ *
+ * Shapes are grouped into size classes by the size of their sprites, rounded
+ * up to a multiple of kSizeStep pixels. Each class has its own slots, each
+ * large enough for the class' largest sprite; within the memory budget,
+ * every class gets the same number of slots per shape. When all slots of a
+ * class are in use, a new sprite replaces one that has not been used for
+ * the last kKeepFrames frames (approximately the least recently used one).
+ * If there is none, the working set does not fit, and find() returns
+ * nullptr without queuing anything, rather than replacing sprites that are
+ * still in use. Apart from assign(), the cache does not allocate.
+ *
+ * stats() reports how many find()s returned a sprite during the last
+ * kStatsFrames frames, so that users can stop using a cache that does not
+ * pay off.
+ *
+ * Sprite k of a shape with bounding radius R is S = 2*ceil(R)+2 pixels
+ * square, with the shape's origin at (S/2, S/2). Drawing it with
+ * blit_masked() at position p + (0.5, 0.5) places the origin at p rounded to
+ * the nearest pixel.
+ *
+ * find(), next_frame() and assign() must not be called concurrently.
+ */
+class ImpostorCache
+{
+	public:
+		static constexpr std::uint32_t kSizeStep = 8;
+		static constexpr std::uint32_t kBuildsPerFrame = 16;
+		static constexpr std::uint64_t kKeepFrames = 2;
+		static constexpr std::uint32_t kStatsFrames = 120;
+
+		struct Stats
+		{
+			std::uint64_t lookups = 0; // calls to find()
+			std::uint64_t hits = 0; // ... that returned a sprite
+		};
+
+	public:
+		explicit ImpostorCache(
+			std::uint32_t aAngleCount = 64,
+			std::size_t aBudgetBytes = std::size_t(32) << 20
+		);
+		~ImpostorCache();
+
+		ImpostorCache( ImpostorCache const& ) = delete;
+		ImpostorCache& operator= (ImpostorCache const&) = delete;
+
+	public:
+		/* Use the shapes aShapes[0..aCount), with bounding radii aRadii (see
+		 * make_asteroid()). Drops all sprites and resets the statistics. The
+		 * shapes must not change (nor move) until the next call to assign()
+		 * or clear().
+		 */
+		void assign( std::size_t aCount, TriangleFan const* aShapes, float const* aRadii );
+
+		/* Drop all sprites and forget the shapes. Waits for the background
+		 * thread to finish the sprite that it is building, if any.
+		 */
+		void clear();
+
+		/* Sprite of shape aShape at angle index aAngle (< angle_count()), or
+		 * nullptr if it is not built yet. The pointer is valid until the next
+		 * call to find(), assign() or clear().
+		 */
+		ImageRGBA const* find( std::uint32_t aShape, std::uint32_t aAngle );
+
+		/* Start a new frame. Sprites used in the last kKeepFrames frames are
+		 * not replaced.
+		 */
+		void next_frame() noexcept;
+
+		/* Counts of the last complete period of kStatsFrames frames. The
+		 * first period after assign(), during which the cache fills, is not
+		 * counted; until the second one completes, both counts are zero.
+		 */
+		Stats stats() const noexcept;
+
+		std::uint32_t angle_count() const noexcept;
+		std::size_t slot_count() const noexcept;
+
+	private:
+		struct Sprite_ final : ImageRGBA
+		{
+			void set( Index aWidth, Index aHeight, std::uint8_t* aData ) noexcept;
+		};
+
+		struct Slot_
+		{
+			Sprite_ sprite;
+			std::uint32_t* pixels;
+			std::uint32_t key; // aShape*angle_count() + aAngle, or kNone
+			std::uint64_t lastUse; // frame
+
+			// Set by the background thread once the sprite is complete.
+			std::atomic<bool> ready{ false };
+		};
+
+		// Slots [first, end) hold the sprites of the shapes whose sprites are
+		// at most `size` pixels square. Slots [unused, end) were never used;
+		// `hand` is where the search for a slot to replace continues.
+		struct Class_
+		{
+			std::uint32_t size;
+			std::uint32_t first, end;
+			std::uint32_t unused, hand;
+		};
+
+		std::uint32_t acquire_slot_( Class_& ) noexcept;
+
+		void worker_();
+		void render_( Slot_& ) noexcept;
+
+	private:
+		static constexpr std::uint32_t kNone = ~std::uint32_t(0);
+
+		std::uint32_t mAngleCount;
+		std::size_t mBudgetBytes;
+
+		TriangleFan const* mShapes = nullptr;
+		float const* mRadii = nullptr;
+		std::size_t mShapeCount = 0;
+
+		// Slot of each sprite (shape-major), or kNone.
+		std::vector<std::uint32_t> mEntries;
+
+		std::vector<Class_> mClasses;
+		std::vector<std::uint32_t> mShapeClasses; // per shape
+
+		std::size_t mSlotCount = 0;
+		std::unique_ptr<Slot_[]> mSlots;
+		std::vector<std::uint32_t> mPixels;
+
+		std::uint64_t mFrame = 0;
+		std::uint32_t mBuilds = 0; // this frame
+
+		std::uint32_t mStatsFrame = 0; // frames into the current period
+		bool mWarm = false; // past the first period
+		Stats mCounts, mStats;
+
+		// Scratch surface for the background thread.
+		Surface mScratch{ 1, 1 };
+
+		// Slots whose sprites are waiting to be built. A slot is queued at
+		// most once, so the ring buffer (mSlotCount entries) cannot overflow.
+		std::mutex mMutex;
+		std::condition_variable mWake, mIdle;
+		std::vector<std::uint32_t> mQueue;
+		std::size_t mQueueHead = 0, mQueueSize = 0;
+		bool mRendering = false;
+		bool mStop = false;
+
+		std::jthread mWorker;
+};
+
+#endif // IMPOSTOR_CACHE_HPP_B3103C74_A0BE_46DA_93B8_F6BE1079AC21
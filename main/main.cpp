@@ -3,18 +3,27 @@
 
 #include <print>
 #include <random>
+#include <algorithm>
 #include <typeinfo>
 #include <stdexcept>
 
+#include <cmath>
 #include <cstdlib>
 
 #include "../draw2d/surface.hpp"
 #include "../draw2d/draw.hpp"
 #include "../draw2d/shape.hpp"
+#include "../draw2d/draw-aa.hpp"
+#include "../draw2d/stroke.hpp"
+#include "../draw2d/parallel.hpp"
 
 #include "../support/error.hpp"
 #include "../support/context.hpp"
+#include "../support/profile.hpp"
 #include "../support/runconfig.hpp"
+#include "../support/frame_arena.hpp"
+#include "../support/alloc_track.hpp"
+#include "../support/thread_pool.hpp"
 
 #include "../vmlib/vec2.hpp"
 #include "../vmlib/mat22.hpp"
@@ -24,13 +33,19 @@
 #include "spaceship.hpp"
 #include "background.hpp"
 #include "asteroid_field.hpp"
+#include "profile_overlay.hpp"
 
 namespace
 {
 	constexpr char const* kWindowTitle = "COMP3811-Coursework 1";
 
+	// Radius of the circle around the origin that contains aShape
+	float bounding_radius_( LineStrip const& aShape );
+
 	void glfw_callback_error_( int, char const* );
 
+	void update_line_width_( RuntimeConfig const&, std::uint32_t aFramebufferHeight );
+
 	void glfw_callback_key_( GLFWwindow*, int, int, int, int );
 	void glfw_callback_button_( GLFWwindow*, int, int, int );
 	void glfw_callback_motion_( GLFWwindow*, double, double );
@@ -51,6 +66,11 @@ int main( int aArgc, char* aArgv[] ) try
 	// Parse command line arguments
 	RuntimeConfig const config = parse_command_line( aArgc, aArgv );
 
+	// Worker threads for parallel drawing. They are kept for the whole run;
+	// the pool uninstalls itself when it is destroyed.
+	ThreadPool pool( config.threadCount );
+	set_executor( &pool );
+
 	// Initialize GLFW
 	if( GLFW_TRUE != glfwInit() )
 	{
@@ -152,19 +172,57 @@ int main( int aArgc, char* aArgv[] ) try
 	glViewport( 0, 0, iwidth, iheight );
 
 	// Resources
+	// The background and the asteroids are updated concurrently (see below),
+	// so each has its own generator.
 	RNG rng( std::random_device{}() );
+	RNG asteroidRng( rng() );
 
 	Background background( rng, fbwidth, fbheight );
-	AsteroidField asteroids( rng, fbwidth, fbheight );
+	AsteroidField asteroids( asteroidRng, fbwidth, fbheight );
+	asteroids.set_impostors( config.asteroidImpostors );
 
 	auto const spaceship = make_spaceship_shape();
+	auto const spaceshipRadius = bounding_radius_( spaceship );
+
+	if( config.antialiasLines )
+		set_line_strip_style( ELineStyle::antialiased );
+
+	update_line_width_( config, fbheight );
+
+#	if COMP3811_CONF_PROFILE
+	if( !config.profileCsvPath.empty() )
+		prof::open_csv( config.profileCsvPath.c_str() );
+#	else
+	if( !config.profileCsvPath.empty() )
+		std::print( stderr, "WARNING: --profile_csv ignored; profiler disabled in this build\n" );
+#	endif
 
+	// Per-frame updates. The background and the asteroids only read the
+	// state, so they are updated in parallel once the state is up to date.
+	float dt = 0.f;
+
+	TaskGraph updates;
+	auto const updateState = updates.add( [&] {
+		state_update( state, dt );
+	} );
+	auto const updateBackground = updates.add( [&] {
+		background.update( state.player.position, state.thisFrame.movement );
+	} );
+	auto const updateAsteroids = updates.add( [&] {
+		asteroids.update( state.thisFrame.dt, state.thisFrame.movement );
+	} );
+
+	updates.precede( updateState, updateBackground );
+	updates.precede( updateState, updateAsteroids );
 
 	// Main loop
 	auto lastUpdateTime = Clock::now();
 
 	while( !glfwWindowShouldClose( window ) )
 	{
+		// Release the previous frame's temporaries
+		frame_arena().reset();
+
 		// Let GLFW process events
 		glfwPollEvents();
 		
@@ -206,35 +264,74 @@ int main( int aArgc, char* aArgv[] ) try
 				surface = Surface( fbwidth, fbheight );
 				background.resize( fbwidth, fbheight );
 				asteroids.resize( fbwidth, fbheight );
+
+				update_line_width_( config, fbheight );
 			}
 		}
 
 		// Update state
 		auto const now = Clock::now();
-		auto const dt = std::chrono::duration_cast<Secondsf>(now - lastUpdateTime).count();
+		dt = std::chrono::duration_cast<Secondsf>(now - lastUpdateTime).count();
 		lastUpdateTime = now;
 
-		state_update( state, dt );
-
-		background.update( state.player.position, state.thisFrame.movement );
-		asteroids.update( state.thisFrame.dt, state.thisFrame.movement );
+		{
+			PROFILE_SCOPE( "update" );
+			updates.run( pool );
+		}
 	
 		// Draw scene
-		surface.clear();
+		{
+			PROFILE_SCOPE( "clear" );
+			surface.clear();
+		}
 
 		background.draw( surface );
 		asteroids.draw( surface );
 
-		auto const rot = make_rotation_2d( state.player.angle );
-		auto const offs = Vec2f{ fbwidth*0.5f, fbheight*0.5f };
-		spaceship.draw( surface, { 0.2f, 0.4f, 0.7f }, rot, offs );
+		auto const spaceshipPos = Vec2f{ fbwidth*0.5f, fbheight*0.5f };
+
+		// With --collisions, the spaceship is tinted while it overlaps an
+		// asteroid.
+		bool spaceshipHit = false;
+		if( config.showCollisions )
+		{
+			PROFILE_SCOPE( "collisions" );
+			asteroids.collisions().for_each_overlap( spaceshipPos, spaceshipRadius, [&] (std::uint32_t) {
+				spaceshipHit = true;
+			} );
+		}
+
+		{
+			PROFILE_SCOPE( "spaceship" );
+
+			auto const rot = make_rotation_2d( state.player.angle );
+			auto const color = spaceshipHit ? ColorF{ 0.9f, 0.3f, 0.2f } : ColorF{ 0.2f, 0.4f, 0.7f };
+			spaceship.draw( surface, color, rot, spaceshipPos );
+		}
 
-		context.draw( surface );
+		if( state.showProfile )
+			draw_profile_overlay( surface );
+
+		{
+			PROFILE_SCOPE( "context.draw" );
+			context.draw( surface );
+		}
 
 		// Display results
 		glfwSwapBuffers( window );
+
+		PROFILE_FRAME_END();
 	}
 
+#	if COMP3811_CONF_PROFILE
+	prof::close_csv();
+
+	std::print( "Frame arena: peak {} KiB of {} KiB\n", (frame_arena().peak()+1023) / 1024, frame_arena().capacity() / 1024 );
+#	endif
+#	if COMP3811_CONF_TRACK_ALLOCATIONS
+	std::print( "Heap allocations: {} in total\n", prof::allocation_count() );
+#	endif
+
 	// Cleanup.
 	// For now, all objects are automatically cleaned up when they go out of
 	// scope.
@@ -257,6 +354,29 @@ namespace
 		std::print( stderr, "GLFW error: {} ({})\n", aErrDesc, aErrNum );
 	}
 
+	void update_line_width_( RuntimeConfig const& aConfig, std::uint32_t aFramebufferHeight )
+	{
+		// 1 px lines were designed for the default 1280x720 window. Scale
+		// the width with the framebuffer so that outlines remain readable
+		// at high resolutions (3 px at 4K).
+		float width = aConfig.lineWidth;
+		if( 0.f == width )
+			width = std::max( 1.f, std::floor( float(aFramebufferHeight) / float(cfg::kInitialWindowHeight) ) );
+
+		StrokeStyle style = line_strip_stroke();
+		style.width = width;
+		set_line_strip_stroke( style );
+	}
+
+	float bounding_radius_( LineStrip const& aShape )
+	{
+		float radius = 0.f;
+		for( std::size_t i = 0; i < aShape.vertex_count(); ++i )
+			radius = std::max( radius, length( aShape.vertices()[i] ) );
+
+		return radius;
+	}
+
 	void glfw_callback_key_( GLFWwindow* aWindow, int aKey, int, int aAction, int )
 	{
 		if( GLFW_KEY_ESCAPE == aKey && GLFW_PRESS == aAction )
@@ -268,6 +388,21 @@ namespace
 		auto* state = static_cast<State*>(glfwGetWindowUserPointer( aWindow ));
 		assert( state );
 
+		if( GLFW_KEY_P == aKey && GLFW_PRESS == aAction )
+		{
+			state->showProfile = !state->showProfile;
+			if( state->showProfile )
+				print_profile_legend();
+			return;
+		}
+
+		if( GLFW_KEY_L == aKey && GLFW_PRESS == aAction )
+		{
+			bool const aa = ELineStyle::antialiased == line_strip_style();
+			set_line_strip_style( aa ? ELineStyle::aliased : ELineStyle::antialiased );
+			return;
+		}
+
 		if( EInputMode::standard == state->inputMode )
 		{
 			if( GLFW_KEY_SPACE == aKey && GLFW_PRESS == aAction )
@@ -2,6 +2,7 @@
 
 #include "../draw2d/surface.hpp"
 
+#include <cstring>
 #include <cassert> 
 
 ParticleField::ParticleField( RNG& aRNG, std::uint32_t aImageWidth, std::uint32_t aImageHeight, ColorF const& aParticleColor, float aParticleDensity, float aParticleSpeedMult, float aPadding )
@@ -11,6 +12,9 @@ ParticleField::ParticleField( RNG& aRNG, std::uint32_t aImageWidth, std::uint32_
 	, mPadding( aPadding )
 	, mRNG( aRNG )
 {
+	std::uint8_t const bytes[4] = { mColor.r, mColor.g, mColor.b, 0 };
+	std::memcpy( &mPackedColor, bytes, sizeof(mPackedColor) );
+
 	// Store extents
 	mVisibleExtent.x = float(aImageWidth);
 	mVisibleExtent.y = float(aImageHeight);
@@ -31,10 +35,10 @@ ParticleField::ParticleField( RNG& aRNG, std::uint32_t aImageWidth, std::uint32_
 	std::uniform_real_distribution<float> xdist( mBoxMin.x, mBoxMax.x );
 	std::uniform_real_distribution<float> ydist( mBoxMin.y, mBoxMax.y );
 
-	for( auto& p : mParticles )
+	for( std::size_t i = 0; i < particleCount; ++i )
 	{
-		p.x = xdist(mRNG);
-		p.y = ydist(mRNG);
+		mParticles.x[i] = xdist(mRNG);
+		mParticles.y[i] = ydist(mRNG);
 	}
 }
 
@@ -55,9 +59,12 @@ void ParticleField::update( Vec2f aDelta ) noexcept
 	std::uniform_real_distribution<float> ypad( 0.f, padY );
 
 
-	for( auto& particle : mParticles )
+	translate_points( mParticles, delta );
+
+	// Respawn particles that left the box
+	for( std::size_t i = 0; i < mParticles.size(); ++i )
 	{
-		Vec2f p = particle + delta;
+		Vec2f p = mParticles.get( i );
 
 		if( p.x < mBoxMin.x )
 		{
@@ -81,25 +88,25 @@ void ParticleField::update( Vec2f aDelta ) noexcept
 			p.y = mBoxMin.y + ypad(mRNG);
 		}
 
-		particle = p;
+		mParticles.set( i, p );
 	}
 }
 
 void ParticleField::draw( Surface& aSurface ) const
 {
-	for( auto const& particle : mParticles )
-	{
-		auto const p = particle + Vec2f{ .5f, .5f };
+	for_each_pixel( aSurface.get_width(), aSurface.get_height(), [&] (std::uint32_t aX, std::uint32_t aY) {
+		aSurface.set_pixel_srgb( aX, aY, mColor );
+	} );
+}
 
-		if( p.x < 0.f || p.y < 0.f )
-			continue;
-		
-		std::uint32_t const xpos = std::uint32_t( p.x + .5f );
-		std::uint32_t const ypos = std::uint32_t( p.y + .5f );
+std::size_t ParticleField::size() const noexcept
+{
+	return mParticles.size();
+}
 
-		if( xpos < aSurface.get_width() && ypos < aSurface.get_height() )
-			aSurface.set_pixel_srgb( xpos, ypos, mColor );
-	}
+std::uint32_t ParticleField::packed_color() const noexcept
+{
+	return mPackedColor;
 }
 
 void ParticleField::resize( std::uint32_t aImageWidth, std::uint32_t aImageHeight )
@@ -120,14 +127,14 @@ void ParticleField::resize( std::uint32_t aImageWidth, std::uint32_t aImageHeigh
 
 	// Remove particles now outside
 	std::size_t activeParticles = 0;
-	for( auto it = mParticles.begin(); it != mParticles.end(); )
+	for( std::size_t i = 0; i < mParticles.size(); ++i )
 	{
-		auto const& part = *it;
+		auto const part = mParticles.get( i );
 
 		if( part.x > mBoxMax.x || part.y > mBoxMax.y )
-			it = mParticles.erase( it );
-		else
-			++it, ++activeParticles;
+			continue;
+
+		mParticles.set( activeParticles++, part );
 	}
 
 	mParticles.resize( particleCount ); // This may kill a few visible particles..
@@ -164,7 +171,7 @@ void ParticleField::resize( std::uint32_t aImageWidth, std::uint32_t aImageHeigh
 				pos.y = yay( mRNG );
 			}
 
-			mParticles[i] = pos;
+			mParticles.set( i, pos );
 		}
 	}
 }
@@ -4,11 +4,13 @@
 #include <vector>
 
 #include <cstdlib>
+#include <cstdint>
 
 #include "../draw2d/forward.hpp"
 #include "../draw2d/color.hpp"
 
 #include "../vmlib/vec2.hpp"
+#include "../vmlib/vec2_batch.hpp"
 
 #include "defaults.hpp"
 
@@ -30,11 +32,24 @@ class ParticleField final
 		void draw( Surface& ) const;
 
 		void resize( std::uint32_t aImageWidth, std::uint32_t aImageHeight );
+
+		/* Call aPixel( x, y ) for each particle that is visible on a surface
+		 * of size aWidth x aHeight, in order, with the pixel that draw()
+		 * sets for it.
+		 */
+		template< typename tPixel >
+		void for_each_pixel( std::uint32_t aWidth, std::uint32_t aHeight, tPixel&& aPixel ) const;
+
+		std::size_t size() const noexcept;
+
+		// The particles' color as stored in a Surface (RGBx, with x = 0).
+		std::uint32_t packed_color() const noexcept;
 	
 	private:
-		std::vector<Vec2f> mParticles;
+		Vec2fBatch mParticles;
 
 		ColorU8_sRGB mColor;
+		std::uint32_t mPackedColor;
 
 		float mParticleSpeedMult;
 		float mParticleDensity;
@@ -46,4 +61,23 @@ class ParticleField final
 		RNG& mRNG;
 };
 
+
+template< typename tPixel > inline
+void ParticleField::for_each_pixel( std::uint32_t aWidth, std::uint32_t aHeight, tPixel&& aPixel ) const
+{
+	for( std::size_t i = 0; i < mParticles.size(); ++i )
+	{
+		auto const p = mParticles.get( i ) + Vec2f{ .5f, .5f };
+
+		if( p.x < 0.f || p.y < 0.f )
+			continue;
+		
+		std::uint32_t const xpos = std::uint32_t( p.x + .5f );
+		std::uint32_t const ypos = std::uint32_t( p.y + .5f );
+
+		if( xpos < aWidth && ypos < aHeight )
+			aPixel( xpos, ypos );
+	}
+}
+
 #endif // PARTICLE_FIELD_HPP_5A795E6D_C839_4944_9020_1AF0FEFE3EFC
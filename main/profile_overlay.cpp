@@ -0,0 +1,109 @@
+#include "profile_overlay.hpp"
+
+#include <print>
+#include <algorithm>
+
+#include "../draw2d/draw.hpp"
+#include "../draw2d/stroke.hpp"
+#include "../draw2d/surface.hpp"
+
+#include "../support/profile.hpp"
+
+namespace
+{
+	constexpr float kPixelsPerMs = 6.f;
+	constexpr float kColumnWidth = 2.f;
+	constexpr float kMargin = 8.f;
+
+	constexpr ColorU8_sRGB kStageColors[] = {
+		{ 230,  25,  75 }, {  60, 180,  75 }, { 255, 225,  25 }, {   0, 130, 200 },
+		{ 245, 130,  48 }, { 145,  30, 180 }, {  70, 240, 240 }, { 240,  50, 230 },
+		{ 210, 245,  60 }, { 250, 190, 212 }, {   0, 128, 128 }, { 220, 190, 255 }
+	};
+	constexpr std::size_t kStageColorCount = sizeof(kStageColors)/sizeof(kStageColors[0]);
+
+	constexpr ColorU8_sRGB kBudgetColor60 = { 255, 255, 255 };
+	constexpr ColorU8_sRGB kBudgetColor30 = { 128, 128, 128 };
+
+	constexpr ColorU8_sRGB kAllocationColor = { 255, 0, 0 };
+	constexpr float kMarkerHeight = 4.f;
+
+#	if COMP3811_CONF_PROFILE
+	// Budget lines use the same width as the spaceship's outline.
+	void draw_budget_line_( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+	{
+		if( StrokeStyle const& stroke = line_strip_stroke(); stroke.width > 1.f )
+		{
+			Vec2f const points[] = { aBegin, aEnd };
+			draw_stroke( aSurface, 2, points, stroke, aColor );
+		}
+		else
+		{
+			draw_line_solid( aSurface, aBegin, aEnd, aColor );
+		}
+	}
+#	endif // ~ COMP3811_CONF_PROFILE
+}
+
+void draw_profile_overlay( Surface& aSurface )
+{
+#	if COMP3811_CONF_PROFILE
+	auto const stages = prof::stage_count();
+	auto const width = float(aSurface.get_width());
+	auto const height = float(aSurface.get_height());
+
+	// Number of columns that fit on screen
+	auto const maxColumns = std::size_t(std::max( 0.f, (width - 2.f*kMargin) / kColumnWidth ));
+	auto const columns = std::min( { maxColumns, prof::frames_recorded(), prof::kHistoryFrames } );
+
+	float const baseY = height - kMargin;
+	float const right = kMargin + columns * kColumnWidth;
+
+	for( std::size_t i = 0; i < columns; ++i )
+	{
+		float const x1 = right - i * kColumnWidth;
+		float const x0 = x1 - kColumnWidth;
+
+		float y = baseY;
+		for( std::size_t s = 0; s < stages; ++s )
+		{
+			float const ms = prof::stage_milliseconds( prof::StageId(s), i );
+			float const h = ms * kPixelsPerMs;
+
+			draw_rectangle_solid( aSurface, { x0, y - h }, { x1, y }, kStageColors[s % kStageColorCount] );
+			y -= h;
+		}
+
+		// Frames that allocated (only with allocation tracking)
+		if( prof::frame_allocations( i ) )
+			draw_rectangle_solid( aSurface, { x0, y - kMarkerHeight - 1.f }, { x1, y - 1.f }, kAllocationColor );
+	}
+
+	// Frame budgets
+	float const y60 = baseY - kPixelsPerMs * (1000.f/60.f);
+	float const y30 = baseY - kPixelsPerMs * (1000.f/30.f);
+
+	draw_budget_line_( aSurface, { kMargin, y60 }, { right, y60 }, kBudgetColor60 );
+	draw_budget_line_( aSurface, { kMargin, y30 }, { right, y30 }, kBudgetColor30 );
+#	else // !COMP3811_CONF_PROFILE
+	(void)aSurface;
+#	endif // ~ COMP3811_CONF_PROFILE
+}
+
+void print_profile_legend()
+{
+#	if COMP3811_CONF_PROFILE
+	std::print( "Profiler stages (bottom to top):\n" );
+	for( std::size_t s = 0; s < prof::stage_count(); ++s )
+	{
+		auto const& col = kStageColors[s % kStageColorCount];
+		std::print( "  {:<16} rgb({}, {}, {})\n", prof::stage_name( prof::StageId(s) ), int(col.r), int(col.g), int(col.b) );
+	}
+#	if COMP3811_CONF_TRACK_ALLOCATIONS
+	std::print( "Red markers: frames with heap allocations\n" );
+#	endif
+
+#	else // !COMP3811_CONF_PROFILE
+	std::print( "Profiler disabled in this build (see COMP3811_CONF_PROFILE)\n" );
+#	endif // ~ COMP3811_CONF_PROFILE
+}
@@ -0,0 +1,20 @@
+#ifndef PROFILE_OVERLAY_HPP_646910F6_BDA9_48CB_B611_028434EF2CA4
+#define PROFILE_OVERLAY_HPP_646910F6_BDA9_48CB_B611_028434EF2CA4
+
+#include "../draw2d/forward.hpp"
+
+/* Draw the profiler's frame history as a bar graph
+ *
+ * Each column corresponds to one recorded frame (most recent on the right).
+ * The column is a stack of bars, one per profiler stage, with a height
+ * proportional to the time spent in that stage. Horizontal lines mark the
+ * 60 Hz and 30 Hz frame budgets.
+ *
+ * Does nothing if the profiler is disabled (see COMP3811_CONF_PROFILE).
+ */
+void draw_profile_overlay( Surface& );
+
+// Print which color corresponds to which profiler stage to stdout.
+void print_profile_legend();
+
+#endif // PROFILE_OVERLAY_HPP_646910F6_BDA9_48CB_B611_028434EF2CA4
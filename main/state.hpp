@@ -35,6 +35,8 @@ struct State
 
 	// Misc.
 	GLFWcursor* crosshair = nullptr;
+
+	bool showProfile = false; // toggled with 'P'
 };
 
 
@@ -1,3 +1,13 @@
+newoption {
+	trigger = "with-libpfm",
+	description = "Build Google Benchmark with libpfm (enables --benchmark_perf_counters; Linux only)"
+}
+
+newoption {
+	trigger = "with-alloc-tracking",
+	description = "Count heap allocations per profiler stage and frame (see support/alloc_track.hpp)"
+}
+
 workspace "COMP3811-cw1"
 	language "C++"
 	cppdialect "C++23"
@@ -40,6 +50,12 @@ workspace "COMP3811-cw1"
 	-- default libraries
 	filter "system:linux"
 		links "dl"
+
+	filter { "system:linux", "options:with-libpfm" }
+		links "pfm"
+
+	filter "options:with-alloc-tracking"
+		defines { "COMP3811_CONF_TRACK_ALLOCATIONS=1" }
 	
 	filter "system:windows"
 		links "OpenGL32"
@@ -111,14 +127,28 @@ project "draw2d"
 
 project "support"
 	local sources = { 
+		"support/alloc_track.cpp",
 		"support/checkpoint.cpp",
 		--"support/context.cpp", -- separate implementation on Apple
 		"support/error.cpp",
+		"support/frame_arena.cpp",
+		"support/perf_counters.cpp",
+		"support/profile.cpp",
 		"support/runconfig.cpp",
+		"support/sysinfo.cpp",
+		"support/thread_pool.cpp",
+		"support/alloc_track.hpp",
+		"support/benchmark_main.hpp",
 		"support/checkpoint.hpp",
 		"support/context.hpp",
 		"support/error.hpp",
+		"support/frame_arena.hpp",
+		"support/perf_counters.hpp",
+		"support/perf_counters_benchmark.hpp",
+		"support/profile.hpp",
 		"support/runconfig.hpp",
+		"support/sysinfo.hpp",
+		"support/thread_pool.hpp",
 	}
 
 	kind "StaticLib"
@@ -126,6 +156,17 @@ project "support"
 
 	files( sources )
 
+	-- Capture the git revision at build time (see support/sysinfo.hpp), so
+	-- that results are tagged with the revision that was built, wherever the
+	-- programs run from.
+	filter "system:windows"
+		prebuildcommands { 'powershell -NoProfile -ExecutionPolicy Bypass -File "%{wks.location}/support/git_revision.ps1" "%{wks.location}" "%{wks.location}/support/git_revision.gen.hpp"' }
+
+	filter "system:not windows"
+		prebuildcommands { 'sh "%{wks.location}/support/git_revision.sh" "%{wks.location}" "%{wks.location}/support/git_revision.gen.hpp"' }
+
+	filter "*"
+
 	-- Most systems use the normal context.cpp implementation
 	filter "system:not macosx"
 		files( "support/context.cpp" );
@@ -183,6 +224,7 @@ project "lines-test"
 	files( sources )
 
 	links "vmlib"
+	links "support"
 	links "draw2d"
 
 	links "x-catch2"
@@ -226,6 +268,71 @@ project "triangles-test"
 
 	links "x-catch2"
 
+project "vmlib-test"
+	local sources = { 
+		"vmlib-test/**.cpp",
+		"vmlib-test/**.hpp",
+		"vmlib-test/**.hxx",
+		"vmlib-test/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "vmlib-test"
+
+	files( sources )
+
+	links "vmlib"
+
+	links "x-catch2"
+
+project "support-test"
+	local sources = { 
+		"support-test/**.cpp",
+		"support-test/**.hpp",
+		"support-test/**.hxx",
+		"support-test/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "support-test"
+
+	files( sources )
+
+	links "vmlib"
+	links "support"
+	links "draw2d"
+
+	links "x-catch2"
+
+project "scene-test"
+	local sources = { 
+		"scene-test/**.cpp",
+		"scene-test/**.hpp",
+		"scene-test/**.hxx",
+		"scene-test/**.inl"
+	}
+
+	-- The scene objects under test, from main/ (see frame-benchmark).
+	local scene = {
+		"main/asteroid.cpp",
+		"main/asteroid_field.cpp",
+		"main/collision_grid.cpp",
+		"main/impostor_cache.cpp"
+	}
+
+	kind "ConsoleApp"
+	location "scene-test"
+
+	files( sources )
+	files( scene )
+
+	links "vmlib"
+	links "draw2d"
+	links "support"
+
+	links "x-stb"
+	links "x-catch2"
+
 project "blit-benchmark"
 	local sources = { 
 		"blit-benchmark/**.cpp",
@@ -261,7 +368,76 @@ project "lines-benchmark"
 
 	links "vmlib"
 	links "draw2d"
+	links "support"
+
+	links "x-benchmark"
+
+project "triangles-benchmark"
+	local sources = { 
+		"triangles-benchmark/**.cpp",
+		"triangles-benchmark/**.hpp",
+		"triangles-benchmark/**.hxx",
+		"triangles-benchmark/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "triangles-benchmark"
+
+	files( sources )
+	files( "main/asteroid.cpp" ) -- for make_asteroid()
+
+	links "vmlib"
+	links "draw2d"
+	links "support"
+
+	links "x-benchmark"
+
+project "frame-benchmark"
+	local sources = { 
+		"frame-benchmark/**.cpp",
+		"frame-benchmark/**.hpp",
+		"frame-benchmark/**.hxx",
+		"frame-benchmark/**.inl"
+	}
+
+	-- The scene objects from main/. main.cpp and state.cpp are left out, as
+	-- they depend on GLFW.
+	local scene = {
+		"main/asteroid.cpp",
+		"main/asteroid_field.cpp",
+		"main/background.cpp",
+		"main/collision_grid.cpp",
+		"main/impostor_cache.cpp",
+		"main/particle_field.cpp",
+		"main/spaceship.cpp"
+	}
+
+	kind "ConsoleApp"
+	location "frame-benchmark"
+
+	files( sources )
+	files( scene )
+
+	links "vmlib"
+	links "draw2d"
+	links "support"
 
+	links "x-stb"
 	links "x-benchmark"
 
+project "bench-compare"
+	local sources = { 
+		"bench-compare/**.cpp",
+		"bench-compare/**.hpp",
+		"bench-compare/**.hxx",
+		"bench-compare/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "bench-compare"
+
+	files( sources )
+
+	links "support"
+
 --EOF
@@ -0,0 +1,127 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/vec2_batch.hpp"
+
+#include "../main/defaults.hpp"
+#include "../main/asteroid_field.hpp"
+
+namespace
+{
+	// Asteroids whose bounding circles overlap aBox, by testing each one.
+	std::vector<std::uint32_t> visible_brute_force_( AsteroidField const& aField, Box2f const& aBox )
+	{
+		auto const& pos = aField.positions();
+		auto const& radii = aField.radii();
+
+		std::vector<std::uint32_t> ret;
+		for( std::size_t i = 0; i < aField.size(); ++i )
+		{
+			float const dx = std::max( { aBox.min.x - pos.x[i], pos.x[i] - aBox.max.x, 0.f } );
+			float const dy = std::max( { aBox.min.y - pos.y[i], pos.y[i] - aBox.max.y, 0.f } );
+			if( dx*dx + dy*dy <= radii[i]*radii[i] )
+				ret.emplace_back( std::uint32_t(i) );
+		}
+
+		return ret;
+	}
+
+	std::vector<std::uint32_t> visible_grid_( AsteroidField const& aField, Box2f const& aBox )
+	{
+		std::vector<std::uint32_t> ret( aField.size() );
+		ret.resize( aField.find_visible( aBox, ret.data() ) );
+		return ret;
+	}
+
+	// The viewport, boxes that cross cell boundaries (cells are 128 pixels,
+	// starting at the padding, -300), and boxes that extend past the
+	// simulation area or lie entirely outside of it.
+	std::vector<Box2f> boxes_( float aWidth, float aHeight, std::minstd_rand& aRng )
+	{
+		std::vector<Box2f> ret{
+			{ { 0.f, 0.f }, { aWidth, aHeight } },
+			{ { 100.f, 100.f }, { 101.f, 101.f } },
+			{ { -44.f, -44.f }, { 84.f, 84.f } },
+			{ { 211.f, -300.f }, { 213.f, aHeight+300.f } },
+			{ { -300.f, 339.f }, { aWidth+300.f, 341.f } },
+			{ { -1000.f, -1000.f }, { aWidth+1000.f, aHeight+1000.f } },
+			{ { aWidth+100.f, -50.f }, { aWidth+2000.f, 50.f } },
+			{ { 5000.f, 5000.f }, { 6000.f, 6000.f } },
+			{ { -6000.f, -6000.f }, { -5000.f, -5000.f } },
+		};
+
+		std::uniform_real_distribution<float> x( -400.f, aWidth+400.f ), y( -400.f, aHeight+400.f );
+		for( int i = 0; i < 16; ++i )
+		{
+			Vec2f const a{ x( aRng ), y( aRng ) }, b{ x( aRng ), y( aRng ) };
+			ret.emplace_back( Box2f{
+				{ std::min( a.x, b.x ), std::min( a.y, b.y ) },
+				{ std::max( a.x, b.x ), std::max( a.y, b.y ) }
+			} );
+		}
+
+		return ret;
+	}
+}
+
+
+TEST_CASE( "AsteroidField grid culling", "[asteroid_field][cull]" )
+{
+	// Dense field, such that cells hold several asteroids.
+	RNG rng( 3811 );
+	AsteroidField field( rng, 640, 480, 1e-4f );
+	REQUIRE( field.size() > 100 );
+
+	std::minstd_rand boxRng( 42 );
+
+	auto const check = [&] (float aWidth, float aHeight) {
+		for( auto const& box : boxes_( aWidth, aHeight, boxRng ) )
+		{
+			INFO( "box " << box.min.x << "," << box.min.y << " - " << box.max.x << "," << box.max.y );
+			REQUIRE( visible_grid_( field, box ) == visible_brute_force_( field, box ) );
+		}
+	};
+
+	check( 640.f, 480.f );
+
+	// Moving, which respawns asteroids that leave the simulation area.
+	for( int frame = 0; frame < 120; ++frame )
+	{
+		field.update( 1.f / 60.f, Vec2f{ 9.f, -4.f } );
+
+		INFO( "frame " << frame );
+		check( 640.f, 480.f );
+	}
+
+	// A resize changes the grid.
+	SECTION( "larger" )
+	{
+		field.resize( 1280, 720 );
+		check( 1280.f, 720.f );
+
+		field.update( 1.f / 60.f, Vec2f{ -3.f, 5.f } );
+		check( 1280.f, 720.f );
+	}
+	SECTION( "smaller" )
+	{
+		field.resize( 200, 100 );
+		check( 200.f, 100.f );
+
+		field.update( 1.f / 60.f, Vec2f{ -3.f, 5.f } );
+		check( 200.f, 100.f );
+	}
+}
+
+TEST_CASE( "AsteroidField without asteroids", "[asteroid_field][cull]" )
+{
+	RNG rng( 3811 );
+	AsteroidField field( rng, 640, 480, 0.f );
+	REQUIRE( 0 == field.size() );
+
+	std::uint32_t dummy;
+	REQUIRE( 0 == field.find_visible( Box2f{ { 0.f, 0.f }, { 640.f, 480.f } }, &dummy ) );
+}
@@ -0,0 +1,315 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <mutex>
+#include <random>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdint>
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/vec2_batch.hpp"
+
+#include "../support/thread_pool.hpp"
+
+#include "../main/collision_grid.hpp"
+
+namespace
+{
+	using Pair_ = std::pair<std::uint32_t,std::uint32_t>;
+
+	struct Bodies_
+	{
+		Vec2fBatch centers;
+		std::vector<float> radii;
+
+		std::size_t size() const { return radii.size(); }
+	};
+
+	Bodies_ random_bodies_( std::size_t aCount, Box2f const& aArea, float aMinRadius, float aMaxRadius, std::minstd_rand& aRng )
+	{
+		std::uniform_real_distribution<float> x( aArea.min.x, aArea.max.x ), y( aArea.min.y, aArea.max.y );
+		std::uniform_real_distribution<float> radius( aMinRadius, aMaxRadius );
+
+		Bodies_ ret;
+		ret.centers.resize( aCount );
+		ret.radii.resize( aCount );
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			ret.centers.set( i, Vec2f{ x( aRng ), y( aRng ) } );
+			ret.radii[i] = radius( aRng );
+		}
+
+		return ret;
+	}
+
+	bool overlap_( Bodies_ const& aBodies, std::size_t aI, Vec2f aCenter, float aRadius )
+	{
+		float const dx = aBodies.centers.x[aI] - aCenter.x;
+		float const dy = aBodies.centers.y[aI] - aCenter.y;
+		float const rr = aBodies.radii[aI] + aRadius;
+		return dx*dx + dy*dy <= rr*rr;
+	}
+
+	// Overlapping pairs (i < j), by testing all of them.
+	std::vector<Pair_> pairs_brute_force_( Bodies_ const& aBodies )
+	{
+		std::vector<Pair_> ret;
+		for( std::size_t i = 0; i < aBodies.size(); ++i )
+		{
+			for( std::size_t j = i+1; j < aBodies.size(); ++j )
+			{
+				if( overlap_( aBodies, j, aBodies.centers.get( i ), aBodies.radii[i] ) )
+					ret.emplace_back( std::uint32_t(i), std::uint32_t(j) );
+			}
+		}
+
+		return ret;
+	}
+
+	// The grid's pairs, as (i < j) in sorted order. Pairs must be reported
+	// only once, and never pair a body with itself.
+	std::vector<Pair_> pairs_grid_( CollisionGrid const& aGrid )
+	{
+		std::vector<Pair_> ret;
+		aGrid.for_each_pair( [&] (std::uint32_t aA, std::uint32_t aB) {
+			REQUIRE( aA != aB );
+			ret.emplace_back( std::min( aA, aB ), std::max( aA, aB ) );
+		} );
+
+		std::sort( ret.begin(), ret.end() );
+		REQUIRE( std::adjacent_find( ret.begin(), ret.end() ) == ret.end() );
+		return ret;
+	}
+
+	// As above, with for_each_pair_parallel().
+	std::vector<Pair_> pairs_grid_parallel_( CollisionGrid const& aGrid )
+	{
+		std::mutex mutex;
+		std::vector<Pair_> ret;
+		aGrid.for_each_pair_parallel( [&] (std::uint32_t const* aA, std::uint32_t const* aB, std::size_t aCount) {
+			std::scoped_lock lock( mutex );
+			for( std::size_t i = 0; i < aCount; ++i )
+				ret.emplace_back( std::min( aA[i], aB[i] ), std::max( aA[i], aB[i] ) );
+		} );
+
+		for( auto const& pair : ret )
+			REQUIRE( pair.first != pair.second );
+
+		std::sort( ret.begin(), ret.end() );
+		REQUIRE( std::adjacent_find( ret.begin(), ret.end() ) == ret.end() );
+		return ret;
+	}
+
+	std::vector<std::uint32_t> overlaps_brute_force_( Bodies_ const& aBodies, Vec2f aCenter, float aRadius )
+	{
+		std::vector<std::uint32_t> ret;
+		for( std::size_t i = 0; i < aBodies.size(); ++i )
+		{
+			if( overlap_( aBodies, i, aCenter, aRadius ) )
+				ret.emplace_back( std::uint32_t(i) );
+		}
+
+		return ret;
+	}
+
+	std::vector<std::uint32_t> overlaps_grid_( CollisionGrid const& aGrid, Vec2f aCenter, float aRadius )
+	{
+		std::vector<std::uint32_t> ret;
+		aGrid.for_each_overlap( aCenter, aRadius, [&] (std::uint32_t aBody) {
+			ret.emplace_back( aBody );
+		} );
+
+		std::sort( ret.begin(), ret.end() );
+		REQUIRE( std::adjacent_find( ret.begin(), ret.end() ) == ret.end() );
+		return ret;
+	}
+
+	void check_overlaps_( CollisionGrid const& aGrid, Bodies_ const& aBodies, std::minstd_rand& aRng )
+	{
+		std::uniform_int_distribution<std::size_t> body( 0, aBodies.size()-1 );
+		std::uniform_real_distribution<float> radius( 0.f, 300.f );
+
+		for( int i = 0; i < 16; ++i )
+		{
+			auto const center = aBodies.centers.get( body( aRng ) ) + Vec2f{ 17.f, -9.f };
+			auto const r = radius( aRng );
+
+			INFO( "circle " << center.x << "," << center.y << " r " << r );
+			REQUIRE( overlaps_grid_( aGrid, center, r ) == overlaps_brute_force_( aBodies, center, r ) );
+		}
+	}
+
+	void move_( Bodies_& aBodies, Vec2f aDelta )
+	{
+		for( std::size_t i = 0; i < aBodies.size(); ++i )
+			aBodies.centers.set( i, aBodies.centers.get( i ) + aDelta );
+	}
+}
+
+
+TEST_CASE( "CollisionGrid pairs and overlaps", "[collision_grid]" )
+{
+	auto const count = std::size_t(GENERATE( 2, 7, 100, 2000 ));
+	CAPTURE( count );
+
+	// Dense enough that bodies overlap often, and spanning several periods
+	// of the hash, so unrelated cells share buckets.
+	std::minstd_rand rng( 3811 );
+	auto const extent = 60.f * std::sqrt( float(count) );
+	auto bodies = random_bodies_( count, Box2f{ { -extent, -extent }, { extent, extent } }, 5.f, 45.f, rng );
+
+	CollisionGrid grid;
+	grid.update( bodies.centers, bodies.radii );
+	REQUIRE( grid.size() == count );
+
+	REQUIRE( pairs_grid_( grid ) == pairs_brute_force_( bodies ) );
+	check_overlaps_( grid, bodies, rng );
+
+	// Bodies move by different amounts, including across cells; the origin
+	// moves as well.
+	std::normal_distribution<float> velocity( 0.f, 40.f );
+	std::vector<Vec2f> velocities( count );
+	for( auto& v : velocities )
+		v = Vec2f{ velocity( rng ), velocity( rng ) };
+
+	Vec2f const origin{ 33.f, -71.f };
+	for( int frame = 0; frame < 40; ++frame )
+	{
+		move_( bodies, origin );
+		for( std::size_t i = 0; i < count; ++i )
+			bodies.centers.set( i, bodies.centers.get( i ) + velocities[i] );
+
+		grid.translate( origin );
+		grid.update( bodies.centers, bodies.radii );
+
+		INFO( "frame " << frame );
+		REQUIRE( pairs_grid_( grid ) == pairs_brute_force_( bodies ) );
+		check_overlaps_( grid, bodies, rng );
+	}
+}
+
+TEST_CASE( "CollisionGrid parallel pairs", "[collision_grid]" )
+{
+	// Enough bodies for several tasks per thread.
+	auto const count = std::size_t(GENERATE( 0, 100, 3000, 20000 ));
+	CAPTURE( count );
+
+	std::minstd_rand rng( 5 );
+	auto const extent = 60.f * std::sqrt( float(count) );
+	auto const bodies = random_bodies_( count, Box2f{ { -extent, -extent }, { extent, extent } }, 5.f, 45.f, rng );
+
+	CollisionGrid grid;
+	grid.update( bodies.centers, bodies.radii );
+
+	// Without an executor, the ranges are searched one after another.
+	auto const expected = pairs_grid_( grid );
+	REQUIRE( pairs_grid_parallel_( grid ) == expected );
+
+	ThreadPool pool( 4 );
+	set_executor( &pool );
+
+	REQUIRE( pairs_grid_parallel_( grid ) == expected );
+
+	// Cells so small that all pairs are tested
+	if( count <= 3000 )
+	{
+		CollisionGrid fine( 2.f );
+		fine.update( bodies.centers, bodies.radii );
+		REQUIRE( pairs_grid_parallel_( fine ) == expected );
+	}
+}
+
+TEST_CASE( "CollisionGrid torus seams", "[collision_grid]" )
+{
+	// 64 bodies use a table of 8x8 buckets; with 100 pixel cells, the hash
+	// repeats every 800 pixels.
+	float const cell = 100.f, period = 800.f;
+
+	std::minstd_rand rng( 42 );
+	Bodies_ bodies;
+
+	SECTION( "pairs across the seam" )
+	{
+		// Clusters on both sides of the seams at multiples of the period
+		// (including negative coordinates), whose bodies overlap across them.
+		for( float const seam : { -period, 0.f, period, 2.f*period } )
+		{
+			auto cluster = random_bodies_( 16, Box2f{ { seam - 60.f, seam - 60.f }, { seam + 60.f, seam + 60.f } }, 10.f, 40.f, rng );
+			for( std::size_t i = 0; i < cluster.size(); ++i )
+			{
+				bodies.centers.push_back( cluster.centers.get( i ) );
+				bodies.radii.push_back( cluster.radii[i] );
+			}
+		}
+	}
+	SECTION( "bodies that share buckets" )
+	{
+		// Bodies exactly one or more periods apart share a bucket, but do
+		// not overlap.
+		for( std::size_t i = 0; i < 64; ++i )
+		{
+			auto const k = float(i % 4);
+			bodies.centers.push_back( Vec2f{ 50.f + k*period, 350.f - k*period } );
+			bodies.radii.push_back( 20.f );
+		}
+	}
+
+	CollisionGrid grid( cell );
+	grid.update( bodies.centers, bodies.radii );
+	REQUIRE( pairs_grid_( grid ) == pairs_brute_force_( bodies ) );
+	check_overlaps_( grid, bodies, rng );
+
+	// Moving the origin by more than the period, in steps.
+	for( Vec2f const step : { Vec2f{ 350.f, 0.f }, Vec2f{ -130.f, 610.f }, Vec2f{ 1999.f, -2001.f } } )
+	{
+		for( int i = 0; i < 5; ++i )
+		{
+			move_( bodies, step );
+			grid.translate( step );
+
+			// Queries see the bodies at their new positions before update().
+			REQUIRE( pairs_grid_( grid ) == pairs_brute_force_( bodies ) );
+			check_overlaps_( grid, bodies, rng );
+
+			grid.update( bodies.centers, bodies.radii );
+			REQUIRE( pairs_grid_( grid ) == pairs_brute_force_( bodies ) );
+		}
+	}
+}
+
+TEST_CASE( "CollisionGrid large bodies and queries", "[collision_grid]" )
+{
+	std::minstd_rand rng( 7 );
+
+	// Bodies much larger than the cells: the neighbourhood of a cell spans
+	// the table, and all pairs are tested.
+	auto bodies = random_bodies_( 50, Box2f{ { 0.f, 0.f }, { 2000.f, 2000.f } }, 100.f, 600.f, rng );
+
+	CollisionGrid grid( 32.f );
+	grid.update( bodies.centers, bodies.radii );
+	REQUIRE( pairs_grid_( grid ) == pairs_brute_force_( bodies ) );
+	check_overlaps_( grid, bodies, rng );
+
+	// Queries larger than the table, and invalid ones.
+	Vec2f const center{ 1000.f, 1000.f };
+	REQUIRE( overlaps_grid_( grid, center, 1e6f ).size() == bodies.size() );
+	REQUIRE( overlaps_grid_( grid, Vec2f{ std::nanf( "" ), 0.f }, 10.f ).empty() );
+
+	// Changing the number of bodies rebuilds the grid.
+	bodies = random_bodies_( 300, Box2f{ { -500.f, -500.f }, { 500.f, 500.f } }, 1.f, 20.f, rng );
+	grid.update( bodies.centers, bodies.radii );
+	REQUIRE( grid.size() == 300 );
+	REQUIRE( pairs_grid_( grid ) == pairs_brute_force_( bodies ) );
+	check_overlaps_( grid, bodies, rng );
+
+	SECTION( "no bodies" )
+	{
+		grid.update( Vec2fBatch{}, std::vector<float>{} );
+		REQUIRE( grid.size() == 0 );
+		REQUIRE( pairs_grid_( grid ).empty() );
+		REQUIRE( overlaps_grid_( grid, center, 100.f ).empty() );
+	}
+}
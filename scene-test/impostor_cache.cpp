@@ -0,0 +1,200 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <numbers>
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include "../draw2d/shape.hpp"
+#include "../draw2d/image.hpp"
+#include "../draw2d/surface.hpp"
+
+#include "../vmlib/mat22.hpp"
+
+#include "../main/defaults.hpp"
+#include "../main/asteroid.hpp"
+#include "../main/impostor_cache.hpp"
+
+namespace
+{
+	std::uint32_t sprite_size_( float aRadius )
+	{
+		return 2u*std::uint32_t(std::ceil( aRadius )) + 2u;
+	}
+
+	// Sprites are built by the background thread; find() until it is done.
+	ImageRGBA const* wait_for_( ImpostorCache& aCache, std::uint32_t aShape, std::uint32_t aAngle )
+	{
+		for( int i = 0; i < 2000; ++i )
+		{
+			if( auto const* sprite = aCache.find( aShape, aAngle ) )
+				return sprite;
+
+			aCache.next_frame();
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+		}
+
+		return nullptr;
+	}
+
+	std::uint32_t pixel_( Surface const& aSurface, std::uint32_t aX, std::uint32_t aY )
+	{
+		std::uint32_t ret;
+		std::memcpy( &ret, aSurface.get_surface_ptr() + std::size_t(aSurface.get_linear_index( aX, aY ))*4, sizeof(ret) );
+		return ret & 0x00ffffffu;
+	}
+
+	struct Shapes_
+	{
+		std::vector<TriangleFan> shapes;
+		std::vector<float> radii;
+	};
+
+	// Asteroids of different sizes, i.e., in different size classes.
+	Shapes_ make_shapes_( std::size_t aCount )
+	{
+		RNG rng( 3811 );
+
+		Shapes_ ret;
+		ret.radii.resize( aCount );
+		for( std::size_t i = 0; i < aCount; ++i )
+			ret.shapes.emplace_back( make_asteroid( rng, ret.radii[i], 18, 10.f + 9.f*float(i) ) );
+
+		return ret;
+	}
+}
+
+
+TEST_CASE( "ImpostorCache sprites", "[impostor_cache]" )
+{
+	auto const shapes = make_shapes_( 5 );
+
+	std::uint32_t const angles = 16;
+	ImpostorCache cache( angles );
+	cache.assign( shapes.shapes.size(), shapes.shapes.data(), shapes.radii.data() );
+	REQUIRE( cache.angle_count() == angles );
+
+	for( std::uint32_t shape = 0; shape < shapes.shapes.size(); ++shape )
+	{
+		for( std::uint32_t const angle : { 0u, 3u, 9u } )
+		{
+			INFO( "shape " << shape << " (radius " << shapes.radii[shape] << "), angle " << angle );
+
+			auto const* sprite = wait_for_( cache, shape, angle );
+			REQUIRE( sprite );
+
+			auto const size = sprite_size_( shapes.radii[shape] );
+			REQUIRE( sprite->get_width() == size );
+			REQUIRE( sprite->get_height() == size );
+
+			// Reference: the shape drawn onto black and onto white. Pixels
+			// that it covers are the same in both.
+			auto const rotation = make_rotation_2d( 2.f*std::numbers::pi_v<float> * float(angle) / float(angles) );
+			Vec2f const origin{ float(size/2), float(size/2) };
+
+			Surface black( size, size ), white( size, size );
+			black.fill( { 0, 0, 0 } );
+			white.fill( { 255, 255, 255 } );
+			shapes.shapes[shape].draw( black, rotation, origin );
+			shapes.shapes[shape].draw( white, rotation, origin );
+
+			std::size_t covered = 0;
+			for( std::uint32_t y = 0; y < size; ++y )
+			{
+				for( std::uint32_t x = 0; x < size; ++x )
+				{
+					auto const ref = pixel_( black, x, y );
+					auto const inside = ref == pixel_( white, x, y );
+					auto const p = sprite->get_pixel( x, y );
+
+					INFO( "pixel " << x << "," << y );
+					REQUIRE( (inside ? 255 : 0) == p.a );
+					if( inside )
+					{
+						REQUIRE( std::uint32_t(p.r | p.g << 8 | p.b << 16) == ref );
+						++covered;
+					}
+				}
+			}
+
+			REQUIRE( covered > 0 );
+		}
+	}
+}
+
+TEST_CASE( "ImpostorCache replacement", "[impostor_cache]" )
+{
+	auto const shapes = make_shapes_( 1 );
+
+	// Room for two sprites
+	auto const size = (sprite_size_( shapes.radii[0] ) + ImpostorCache::kSizeStep-1) / ImpostorCache::kSizeStep * ImpostorCache::kSizeStep;
+
+	ImpostorCache cache( 16, 2 * std::size_t(size)*size*4 );
+	cache.assign( 1, shapes.shapes.data(), shapes.radii.data() );
+	REQUIRE( cache.slot_count() == 2 );
+
+	REQUIRE( wait_for_( cache, 0, 0 ) );
+	REQUIRE( wait_for_( cache, 0, 1 ) );
+
+	// Sprites that are in use are not replaced.
+	for( std::uint64_t frame = 0; frame < 2*ImpostorCache::kKeepFrames; ++frame )
+	{
+		REQUIRE( cache.find( 0, 0 ) );
+		REQUIRE( cache.find( 0, 1 ) );
+		REQUIRE( !cache.find( 0, 2 ) );
+
+		cache.next_frame();
+	}
+
+	// Once one of them is no longer used, it is. (The sprite is built by
+	// the background thread in the meantime.)
+	ImageRGBA const* sprite = nullptr;
+	for( int i = 0; i < 2000 && !sprite; ++i )
+	{
+		REQUIRE( cache.find( 0, 1 ) );
+		sprite = cache.find( 0, 2 );
+
+		cache.next_frame();
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+
+	REQUIRE( sprite );
+	REQUIRE( cache.find( 0, 1 ) );
+	REQUIRE( cache.find( 0, 2 ) );
+	REQUIRE( !cache.find( 0, 0 ) );
+}
+
+TEST_CASE( "ImpostorCache statistics", "[impostor_cache]" )
+{
+	auto const shapes = make_shapes_( 2 );
+
+	ImpostorCache cache( 16 );
+	cache.assign( shapes.shapes.size(), shapes.shapes.data(), shapes.radii.data() );
+
+	// The first period is not counted.
+	for( std::uint32_t frame = 0; frame < ImpostorCache::kStatsFrames; ++frame )
+	{
+		cache.find( 0, 0 );
+		cache.next_frame();
+	}
+
+	REQUIRE( 0 == cache.stats().lookups );
+	REQUIRE( wait_for_( cache, 0, 0 ) );
+
+	// Two lookups per frame, of which the first always finds its sprite.
+	for( std::uint32_t frame = 0; frame < 2*ImpostorCache::kStatsFrames; ++frame )
+	{
+		REQUIRE( cache.find( 0, 0 ) );
+		cache.find( 1, frame % 16 );
+		cache.next_frame();
+	}
+
+	auto const stats = cache.stats();
+	REQUIRE( stats.lookups == 2*ImpostorCache::kStatsFrames );
+	REQUIRE( stats.hits >= ImpostorCache::kStatsFrames );
+	REQUIRE( stats.hits <= stats.lookups );
+}
@@ -0,0 +1,187 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+#include <memory_resource>
+
+#include <cstdint>
+
+#include "../support/alloc_track.hpp"
+#include "../support/frame_arena.hpp"
+
+namespace
+{
+	// The arena's memory_resource::allocate() is [[nodiscard]]; the tests
+	// often only need the side effects.
+	std::byte* allocate_( FrameArena& aArena, std::size_t aBytes, std::size_t aAlignment )
+	{
+		return static_cast<std::byte*>(aArena.allocate( aBytes, aAlignment ));
+	}
+
+	bool aligned_( void const* aPtr, std::size_t aAlignment )
+	{
+		return 0 == reinterpret_cast<std::uintptr_t>(aPtr) % aAlignment;
+	}
+}
+
+
+TEST_CASE( "FrameArena allocations", "[frame_arena]" )
+{
+	FrameArena arena( 4096 );
+	REQUIRE( arena.capacity() == 4096 );
+	REQUIRE( arena.used() == 0 );
+	REQUIRE( arena.peak() == 0 );
+
+	SECTION( "consecutive" )
+	{
+		auto* const a = allocate_( arena, 100, 4 );
+		auto* const b = allocate_( arena, 28, 4 );
+		REQUIRE( b == a + 100 );
+		REQUIRE( arena.used() == 128 );
+	}
+
+	SECTION( "alignment" )
+	{
+		allocate_( arena, 1, 1 );
+		for( std::size_t alignment = 1; alignment <= 64; alignment *= 2 )
+		{
+			auto* const p = allocate_( arena, 3, alignment );
+			INFO( "alignment " << alignment );
+			REQUIRE( aligned_( p, alignment ) );
+		}
+	}
+
+	SECTION( "pmr container" )
+	{
+		std::pmr::vector<int> values( &arena );
+		for( int i = 0; i < 100; ++i )
+			values.emplace_back( i );
+
+		REQUIRE( values.size() == 100 );
+		REQUIRE( values[99] == 99 );
+		REQUIRE( arena.used() >= 100 * sizeof(int) );
+	}
+}
+
+TEST_CASE( "FrameArena reset and peak", "[frame_arena]" )
+{
+	FrameArena arena( 4096 );
+
+	auto* const first = allocate_( arena, 1000, 8 );
+	allocate_( arena, 500, 8 );
+	REQUIRE( arena.used() == 1500 );
+	REQUIRE( arena.peak() == 1500 );
+
+	// reset() releases everything; the next frame starts at the beginning
+	// of the block again. The peak is kept.
+	arena.reset();
+	REQUIRE( arena.used() == 0 );
+	REQUIRE( arena.peak() == 1500 );
+	REQUIRE( allocate_( arena, 200, 8 ) == first );
+
+	// The peak only grows.
+	arena.reset();
+	allocate_( arena, 2000, 8 );
+	REQUIRE( arena.peak() == 2000 );
+	arena.reset();
+	allocate_( arena, 10, 8 );
+	REQUIRE( arena.peak() == 2000 );
+}
+
+TEST_CASE( "FrameArena scopes", "[frame_arena]" )
+{
+	FrameArena arena( 4096 );
+
+	allocate_( arena, 100, 4 );
+	void* inner = nullptr;
+	{
+		FrameArena::Scope scope( arena );
+		inner = allocate_( arena, 1000, 4 );
+		REQUIRE( arena.used() == 1100 );
+	}
+
+	// The scope's allocations are released, but count towards the peak.
+	REQUIRE( arena.used() == 100 );
+	REQUIRE( arena.peak() == 1100 );
+	REQUIRE( allocate_( arena, 8, 4 ) == inner );
+}
+
+TEST_CASE( "FrameArena overflow", "[frame_arena]" )
+{
+	FrameArena arena( 1024 );
+
+	// More than the block holds: further blocks come from the heap.
+	std::vector<std::byte*> ptrs;
+	for( int i = 0; i < 10; ++i )
+	{
+		auto* const p = allocate_( arena, 300, 16 );
+		for( int j = 0; j < 300; ++j )
+			p[j] = std::byte(i);
+
+		ptrs.emplace_back( p );
+	}
+
+	REQUIRE( arena.used() >= 3000 );
+	REQUIRE( arena.capacity() >= 3000 );
+	REQUIRE( arena.peak() == arena.used() );
+
+	// Earlier allocations are left alone.
+	for( int i = 0; i < 10; ++i )
+	{
+		INFO( "allocation " << i );
+		REQUIRE( ptrs[i][0] == std::byte(i) );
+		REQUIRE( ptrs[i][299] == std::byte(i) );
+	}
+
+	// A single allocation larger than everything so far.
+	auto* const big = allocate_( arena, 64 * 1024, 64 );
+	REQUIRE( aligned_( big, 64 ) );
+	REQUIRE( arena.capacity() >= 64 * 1024 + 3000 );
+
+	// reset() consolidates the blocks into one, which the same frame then
+	// fits into.
+	auto const capacity = arena.capacity();
+
+	arena.reset();
+	REQUIRE( arena.capacity() == capacity );
+
+	auto* const start = allocate_( arena, 1, 1 );
+	for( int i = 0; i < 10; ++i )
+		allocate_( arena, 300, 16 );
+	auto* const end = allocate_( arena, 64 * 1024, 64 );
+
+	REQUIRE( end + 64 * 1024 <= start + capacity );
+	REQUIRE( arena.capacity() == capacity );
+
+	SECTION( "empty arena" )
+	{
+		FrameArena empty( 0 );
+		REQUIRE( empty.capacity() == 0 );
+
+		REQUIRE( allocate_( empty, 100, 8 ) );
+		REQUIRE( empty.capacity() >= 100 );
+	}
+}
+
+TEST_CASE( "FrameArena grows in no-allocation scopes", "[frame_arena]" )
+{
+	FrameArena arena( 256 );
+
+	auto const before = prof::thread_allocation_count();
+
+	std::byte* ptr = nullptr;
+	{
+		// With allocation tracking (and without NDEBUG), the program is
+		// aborted if the arena's new block counts against the scope.
+		NO_ALLOCATION_SCOPE( "FrameArena test" );
+		ptr = allocate_( arena, 4096, 16 );
+	}
+
+	REQUIRE( ptr );
+	REQUIRE( arena.capacity() > 256 );
+
+	// The block is still counted as an allocation.
+	if( COMP3811_CONF_TRACK_ALLOCATIONS )
+		REQUIRE( prof::thread_allocation_count() > before );
+	else
+		REQUIRE( prof::thread_allocation_count() == before );
+}
@@ -0,0 +1,259 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+#include <stdexcept>
+
+#include "../support/error.hpp"
+#include "../support/thread_pool.hpp"
+
+// The tests use more threads than the machine may have CPUs; the pool then
+// does not pin its workers, but otherwise behaves the same.
+
+namespace
+{
+	unsigned thread_count_()
+	{
+		return GENERATE( 1u, 2u, 4u, 8u );
+	}
+}
+
+
+TEST_CASE( "ThreadPool runs each task once", "[thread_pool]" )
+{
+	auto const threads = thread_count_();
+	auto const count = std::size_t(GENERATE( 0, 1, 7, 1000 ));
+	CAPTURE( threads, count );
+
+	ThreadPool pool( threads );
+	REQUIRE( pool.concurrency() == threads );
+
+	std::vector<std::atomic<int>> calls( count );
+	pool.run( count, [] (void* aCalls, std::size_t aIndex) {
+		auto& calls = *static_cast<std::vector<std::atomic<int>>*>(aCalls);
+		++calls[aIndex];
+	}, &calls );
+
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		INFO( "i = " << i );
+		REQUIRE( 1 == calls[i] );
+	}
+}
+
+TEST_CASE( "ThreadPool parallel_for", "[thread_pool]" )
+{
+	auto const threads = thread_count_();
+	auto const grain = GENERATE( 1, 7, 64, 5000 );
+	CAPTURE( threads, grain );
+
+	ThreadPool pool( threads );
+
+	// The ranges must cover [begin, end) exactly once, and none may be
+	// longer than the grain.
+	int const begin = -13, end = 1000;
+
+	std::vector<std::atomic<int>> visits( end - begin );
+	std::atomic<int> tooLong{ 0 };
+
+	pool.parallel_for( begin, end, grain, [&] (int aBegin, int aEnd) {
+		if( aEnd - aBegin > grain || aEnd <= aBegin )
+			++tooLong;
+
+		for( int i = aBegin; i < aEnd; ++i )
+			++visits[i - begin];
+	} );
+
+	REQUIRE( 0 == tooLong );
+	for( int i = begin; i < end; ++i )
+	{
+		INFO( "i = " << i );
+		REQUIRE( 1 == visits[i - begin] );
+	}
+
+	SECTION( "empty range" )
+	{
+		int calls = 0;
+		pool.parallel_for( 5, 5, grain, [&] (int, int) { ++calls; } );
+		REQUIRE( 0 == calls );
+	}
+}
+
+TEST_CASE( "ThreadPool nested submits", "[thread_pool]" )
+{
+	auto const threads = thread_count_();
+	CAPTURE( threads );
+
+	ThreadPool pool( threads );
+
+	// Tasks submit work to the pool and wait for it. The waiting threads
+	// run tasks themselves, so this completes even with a single thread.
+	int const outer = 16, inner = 100;
+
+	std::vector<std::atomic<int>> visits( outer * inner );
+	pool.parallel_for( 0, outer, 1, [&] (int aBegin, int aEnd) {
+		for( int i = aBegin; i < aEnd; ++i )
+		{
+			pool.parallel_for( 0, inner, 3, [&] (int aInnerBegin, int aInnerEnd) {
+				for( int j = aInnerBegin; j < aInnerEnd; ++j )
+				{
+					// ... and once more.
+					pool.parallel_for( 0, 2, 1, [&] (int, int) {} );
+					++visits[i*inner + j];
+				}
+			} );
+		}
+	} );
+
+	for( int i = 0; i < outer * inner; ++i )
+	{
+		INFO( "i = " << i );
+		REQUIRE( 1 == visits[i] );
+	}
+}
+
+TEST_CASE( "ThreadPool exceptions", "[thread_pool]" )
+{
+	auto const threads = thread_count_();
+	CAPTURE( threads );
+
+	ThreadPool pool( threads );
+
+	// The exception reaches the caller. With workers, the other tasks still
+	// run; a single thread runs the tasks in a loop that stops at the first
+	// exception.
+	std::atomic<int> completed{ 0 };
+	REQUIRE_THROWS_AS( pool.parallel_for( 0, 64, 1, [&] (int aBegin, int) {
+		if( 0 == aBegin % 16 )
+			throw std::runtime_error( "task failed" );
+
+		++completed;
+	} ), std::runtime_error );
+
+	if( threads > 1 )
+		REQUIRE( 60 == completed );
+
+	// The pool remains usable.
+	completed = 0;
+	pool.parallel_for( 0, 64, 1, [&] (int, int) { ++completed; } );
+	REQUIRE( 64 == completed );
+}
+
+
+TEST_CASE( "TaskGraph ordering", "[thread_pool][task_graph]" )
+{
+	auto const threads = thread_count_();
+	CAPTURE( threads );
+
+	ThreadPool pool( threads );
+
+	// Random DAG: edges only lead to nodes that were added later. Each task
+	// records when it started and when it finished, in a global order.
+	std::size_t const count = 200;
+
+	std::atomic<int> clock{ 0 };
+	std::vector<int> started( count ), finished( count );
+
+	TaskGraph graph;
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		graph.add( [&, i] {
+			started[i] = clock++;
+			finished[i] = clock++;
+		} );
+	}
+
+	std::minstd_rand rng( 3811 );
+	std::vector<std::pair<std::size_t,std::size_t>> edges;
+	for( std::size_t i = 1; i < count; ++i )
+	{
+		std::uniform_int_distribution<std::size_t> pred( 0, i-1 );
+		for( int k = std::uniform_int_distribution<int>( 0, 3 )( rng ); k > 0; --k )
+		{
+			auto const before = pred( rng );
+			graph.precede( before, i );
+			edges.emplace_back( before, i );
+		}
+	}
+
+	REQUIRE( count == graph.size() );
+
+	// The graph can be run repeatedly.
+	for( int run = 0; run < 3; ++run )
+	{
+		clock = 0;
+		std::fill( started.begin(), started.end(), -1 );
+
+		graph.run( pool );
+
+		REQUIRE( int(2*count) == clock );
+		for( auto const& [before, after] : edges )
+		{
+			INFO( "run " << run << ": " << before << " -> " << after );
+			REQUIRE( started[after] >= 0 );
+			REQUIRE( finished[before] < started[after] );
+		}
+	}
+}
+
+TEST_CASE( "TaskGraph exceptions", "[thread_pool][task_graph]" )
+{
+	auto const threads = thread_count_();
+	CAPTURE( threads );
+
+	ThreadPool pool( threads );
+
+	// a -> b -> c, where b throws: c still runs, and run() rethrows.
+	bool ranA = false, ranC = false;
+
+	TaskGraph graph;
+	auto const a = graph.add( [&] { ranA = true; } );
+	auto const b = graph.add( [&] { throw std::runtime_error( "b failed" ); } );
+	auto const c = graph.add( [&] { ranC = true; } );
+	graph.precede( a, b );
+	graph.precede( b, c );
+
+	REQUIRE_THROWS_AS( graph.run( pool ), std::runtime_error );
+	REQUIRE( ranA );
+	REQUIRE( ranC );
+
+	// The pool and the graph remain usable.
+	ranA = ranC = false;
+	REQUIRE_THROWS_AS( graph.run( pool ), std::runtime_error );
+	REQUIRE( ranA );
+	REQUIRE( ranC );
+}
+
+TEST_CASE( "TaskGraph cycles", "[thread_pool][task_graph]" )
+{
+	ThreadPool pool( 2 );
+
+	int calls = 0;
+
+	// a -> b -> c -> b; d is independent.
+	TaskGraph graph;
+	auto const a = graph.add( [&] { ++calls; } );
+	auto const b = graph.add( [&] { ++calls; } );
+	auto const c = graph.add( [&] { ++calls; } );
+	graph.add( [&] { ++calls; } );
+
+	graph.precede( a, b );
+	graph.precede( b, c );
+	graph.precede( c, b );
+
+	// The cycle is detected before any task runs.
+	REQUIRE_THROWS_AS( graph.run( pool ), Error );
+	REQUIRE( 0 == calls );
+
+	SECTION( "self-dependency" )
+	{
+		TaskGraph self;
+		auto const x = self.add( [&] { ++calls; } );
+		self.precede( x, x );
+
+		REQUIRE_THROWS_AS( self.run( pool ), Error );
+		REQUIRE( 0 == calls );
+	}
+}
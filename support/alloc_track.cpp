@@ -0,0 +1,156 @@
+#include "alloc_track.hpp"
+
+#include <new>
+#include <atomic>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	std::atomic<std::uint64_t> gAllocations_{ 0 };
+	thread_local std::uint64_t gThreadAllocations_ = 0;
+
+	// Allocations of the calling thread in (outermost) AllowAllocationScopes
+	thread_local std::uint64_t gThreadAllowed_ = 0;
+	thread_local unsigned gThreadAllowDepth_ = 0;
+}
+
+namespace prof
+{
+	std::uint64_t allocation_count() noexcept
+	{
+		return gAllocations_.load( std::memory_order_relaxed );
+	}
+	std::uint64_t thread_allocation_count() noexcept
+	{
+		return gThreadAllocations_;
+	}
+
+	NoAllocationScope::NoAllocationScope( char const* aName ) noexcept
+		: mName( aName )
+		, mStart( gThreadAllocations_ )
+		, mStartAllowed( gThreadAllowed_ )
+	{}
+
+	NoAllocationScope::~NoAllocationScope()
+	{
+		auto const count = (gThreadAllocations_ - mStart) - (gThreadAllowed_ - mStartAllowed);
+		if( 0 != count )
+		{
+			// Not std::print(), which may allocate.
+			std::fprintf( stderr, "%llu heap allocation(s) in no-allocation scope '%s'\n", (unsigned long long)count, mName );
+			std::abort();
+		}
+	}
+
+	AllowAllocationScope::AllowAllocationScope() noexcept
+		: mStart( gThreadAllocations_ )
+	{
+		++gThreadAllowDepth_;
+	}
+
+	AllowAllocationScope::~AllowAllocationScope()
+	{
+		// Nested scopes: the outermost one accounts for all of them.
+		if( 0 == --gThreadAllowDepth_ )
+			gThreadAllowed_ += gThreadAllocations_ - mStart;
+	}
+}
+
+
+#if COMP3811_CONF_TRACK_ALLOCATIONS
+/* Replacement operator new
+ *
+ * The remaining forms of operator new (array, nothrow) call these by default.
+ * The default operator delete forms call std::free(), which matches the
+ * unaligned forms. The aligned forms are paired with their own delete, as
+ * memory from _aligned_malloc() must be released with _aligned_free().
+ */
+namespace
+{
+	void count_allocation_() noexcept
+	{
+		gAllocations_.fetch_add( 1, std::memory_order_relaxed );
+		++gThreadAllocations_;
+	}
+
+	void* allocate_( std::size_t aSize )
+	{
+		count_allocation_();
+
+		for( ;; )
+		{
+			if( void* ptr = std::malloc( aSize ? aSize : 1 ) )
+				return ptr;
+
+			auto const handler = std::get_new_handler();
+			if( !handler )
+				throw std::bad_alloc();
+
+			handler();
+		}
+	}
+
+	void* allocate_aligned_( std::size_t aSize, std::align_val_t aAlign )
+	{
+		count_allocation_();
+
+		auto const align = std::size_t(aAlign);
+		for( ;; )
+		{
+#			if defined(_WIN32)
+			void* ptr = _aligned_malloc( aSize ? aSize : 1, align );
+#			else
+			// std::aligned_alloc() requires a multiple of the alignment.
+			auto const size = ((aSize ? aSize : 1) + align-1) & ~(align-1);
+			void* ptr = std::aligned_alloc( align, size );
+#			endif
+			if( ptr )
+				return ptr;
+
+			auto const handler = std::get_new_handler();
+			if( !handler )
+				throw std::bad_alloc();
+
+			handler();
+		}
+	}
+
+	void free_aligned_( void* aPtr ) noexcept
+	{
+#		if defined(_WIN32)
+		_aligned_free( aPtr );
+#		else
+		std::free( aPtr );
+#		endif
+	}
+}
+
+void* operator new( std::size_t aSize )
+{
+	return allocate_( aSize );
+}
+void operator delete( void* aPtr ) noexcept
+{
+	std::free( aPtr );
+}
+void operator delete( void* aPtr, std::size_t ) noexcept
+{
+	std::free( aPtr );
+}
+
+void* operator new( std::size_t aSize, std::align_val_t aAlign )
+{
+	return allocate_aligned_( aSize, aAlign );
+}
+void operator delete( void* aPtr, std::align_val_t ) noexcept
+{
+	free_aligned_( aPtr );
+}
+void operator delete( void* aPtr, std::size_t, std::align_val_t ) noexcept
+{
+	free_aligned_( aPtr );
+}
+
+#endif // ~ TRACK_ALLOCATIONS
@@ -0,0 +1,76 @@
+#ifndef ALLOC_TRACK_HPP_ADC28100_EB4A_413D_B5E5_8CC9C7203522
+#define ALLOC_TRACK_HPP_ADC28100_EB4A_413D_B5E5_8CC9C7203522
+
+#include <cstdint>
+
+#include "defaults.hpp"
+
+/* Heap allocation tracking
+ *
+ * With COMP3811_CONF_TRACK_ALLOCATIONS (see defaults.hpp), the global
+ * operator new is replaced by one that counts calls, in total and per
+ * thread. The profiler (profile.hpp) records the allocations made in each
+ * stage and in each frame; the overlay marks frames that allocated, and the
+ * CSV output includes the counts.
+ *
+ * NO_ALLOCATION_SCOPE( "name" ) marks the rest of the enclosing scope as one
+ * that must not allocate, e.g., the per-frame updates of the scene. In
+ * builds without NDEBUG, the program is aborted with a message when the
+ * current thread allocates in such a scope.
+ *
+ * AllowAllocationScope exempts the allocations made during its lifetime
+ * from the enclosing no-allocation scopes. It is meant for allocations that
+ * happen rarely and by design, such as FrameArena taking a further block
+ * when a frame outgrows its current one (the arena then grows such that
+ * later frames fit). These allocations are still counted.
+ *
+ * Without tracking, the counts are zero and NO_ALLOCATION_SCOPE() expands to
+ * nothing.
+ */
+namespace prof
+{
+	// Number of allocations since program start, by all threads or by the
+	// calling thread.
+	std::uint64_t allocation_count() noexcept;
+	std::uint64_t thread_allocation_count() noexcept;
+
+	class NoAllocationScope final
+	{
+		public:
+			explicit NoAllocationScope( char const* aName ) noexcept;
+			~NoAllocationScope();
+
+			NoAllocationScope( NoAllocationScope const& ) = delete;
+			NoAllocationScope& operator= (NoAllocationScope const&) = delete;
+
+		private:
+			char const* mName;
+			std::uint64_t mStart, mStartAllowed;
+	};
+
+	class AllowAllocationScope final
+	{
+		public:
+			AllowAllocationScope() noexcept;
+			~AllowAllocationScope();
+
+			AllowAllocationScope( AllowAllocationScope const& ) = delete;
+			AllowAllocationScope& operator= (AllowAllocationScope const&) = delete;
+
+		private:
+			std::uint64_t mStart;
+	};
+}
+
+#define ALLOC_TRACK_CAT_IMPL_( a, b ) a##b
+#define ALLOC_TRACK_CAT_( a, b ) ALLOC_TRACK_CAT_IMPL_( a, b )
+
+#if COMP3811_CONF_TRACK_ALLOCATIONS && !defined(NDEBUG)
+#	define NO_ALLOCATION_SCOPE( aName )                                        \
+		::prof::NoAllocationScope ALLOC_TRACK_CAT_(noAlloc_,__LINE__)( aName ) \
+		/*ENDM*/
+#else
+#	define NO_ALLOCATION_SCOPE( aName )     do {} while(0)
+#endif // ~ TRACK_ALLOCATIONS && !NDEBUG
+
+#endif // ALLOC_TRACK_HPP_ADC28100_EB4A_413D_B5E5_8CC9C7203522
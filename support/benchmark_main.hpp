@@ -0,0 +1,107 @@
+#ifndef BENCHMARK_MAIN_HPP_8485B9D3_3477_43E7_9AEA_3BDE9E1CD3AF
+#define BENCHMARK_MAIN_HPP_8485B9D3_3477_43E7_9AEA_3BDE9E1CD3AF
+
+// Header-only replacement for BENCHMARK_MAIN(). Only include this from the
+// *-benchmark targets.
+
+#include <benchmark/benchmark.h>
+
+#include <print>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <string_view>
+
+#include <ctime>
+
+#include "sysinfo.hpp"
+
+/* Benchmark main()
+ *
+ * Like BENCHMARK_MAIN(), with the following additions:
+ *  - the git revision and the CPU model are added to the results' context
+ *    (as "git_revision" and "cpu_model")
+ *  - unless --benchmark_out=<file> is given, JSON results are written to
+ *    benchmark-results/<benchmark>-<revision>-<date>-<time>.json (with a
+ *    further "-<n>" suffix if that file exists already), so that runs do not
+ *    overwrite each other's results. Nothing is written when only listing
+ *    the benchmarks (--benchmark_list_tests).
+ *
+ * Compare two JSON results with the bench-compare tool.
+ */
+#define COMP3811_BENCHMARK_MAIN()                                      \
+	int main( int aArgc, char** aArgv )                                \
+	{                                                                  \
+		return comp3811_benchmark_main( aArgc, aArgv );                \
+	}                                                                  \
+	int main( int, char** ) /* force the trailing semicolon */
+
+inline
+int comp3811_benchmark_main( int aArgc, char** aArgv )
+{
+	benchmark::MaybeReenterWithoutASLR( aArgc, aArgv );
+
+	auto const revision = git_revision();
+
+	benchmark::AddCustomContext( "git_revision", revision );
+	benchmark::AddCustomContext( "cpu_model", cpu_model() );
+
+	std::vector<char*> args( aArgv, aArgv+aArgc );
+
+	bool hasOut = false, listOnly = false;
+	for( int i = 1; i < aArgc; ++i )
+	{
+		std::string_view const arg( aArgv[i] );
+		if( arg.starts_with( "--benchmark_out=" ) )
+			hasOut = true;
+
+		if( arg == "--benchmark_list_tests" )
+			listOnly = true;
+		else if( arg.starts_with( "--benchmark_list_tests=" ) )
+			listOnly = !(arg.ends_with( "=false" ) || arg.ends_with( "=0" ));
+	}
+
+	std::string outArg;
+	if( !hasOut && !listOnly && aArgc >= 1 )
+	{
+		namespace fs_ = std::filesystem;
+
+		// Strip the -<config>-<platform>-<toolset> suffix from the executable
+		// name, if present. E.g., "triangles-benchmark-release-x64-gcc".
+		auto name = fs_::path( aArgv[0] ).stem().string();
+		if( auto const pos = name.find( "-benchmark" ); std::string::npos != pos )
+			name = name.substr( 0, pos + 10 );
+
+		std::error_code ec;
+		fs_::create_directories( "benchmark-results", ec );
+
+		char date[32] = "unknown";
+		auto const now = std::time( nullptr );
+		if( auto const* local = std::localtime( &now ) )
+			std::strftime( date, sizeof(date), "%Y%m%d-%H%M%S", local );
+
+		auto const stem = name + "-" + revision + "-" + date;
+
+		auto path = fs_::path( "benchmark-results" ) / (stem + ".json");
+		for( int n = 2; fs_::exists( path, ec ); ++n )
+			path = fs_::path( "benchmark-results" ) / std::format( "{}-{}.json", stem, n );
+
+		outArg = "--benchmark_out=" + path.string();
+		args.push_back( outArg.data() );
+
+		std::print( stderr, "Writing JSON results to '{}'\n", path.string() );
+	}
+
+	args.push_back( nullptr );
+	int argc = int(args.size()) - 1;
+
+	benchmark::Initialize( &argc, args.data() );
+	if( benchmark::ReportUnrecognizedArguments( argc, args.data() ) )
+		return 1;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
+
+#endif // BENCHMARK_MAIN_HPP_8485B9D3_3477_43E7_9AEA_3BDE9E1CD3AF
@@ -20,4 +20,31 @@
 #	endif
 #endif // ~ COMP3811_CONF_USE_STACKTRACE
 
+/* Compile time config: Enable the frame profiler (profile.hpp)?
+ *
+ * Enabled by default unless NDEBUG is specified. When disabled, the profiling
+ * macros (PROFILE_SCOPE() and friends) expand to nothing, and the profiler
+ * adds no overhead whatsoever. You can force it on in release builds by
+ * defining COMP3811_CONF_PROFILE=1.
+ */
+#if !defined(COMP3811_CONF_PROFILE)
+#	if defined(NDEBUG)
+#		define COMP3811_CONF_PROFILE 0
+#	else
+#		define COMP3811_CONF_PROFILE 1
+#	endif
+#endif // ~ COMP3811_CONF_PROFILE
+
+/* Compile time config: Count heap allocations (alloc_track.hpp)?
+ *
+ * Disabled by default, as it replaces the global operator new and delete.
+ * Define COMP3811_CONF_TRACK_ALLOCATIONS=1 to enable it (premake5 option
+ * --with-alloc-tracking). The profiler then reports allocations per stage
+ * and per frame, and, unless NDEBUG is specified, NO_ALLOCATION_SCOPE()
+ * checks that the marked scopes do not allocate.
+ */
+#if !defined(COMP3811_CONF_TRACK_ALLOCATIONS)
+#	define COMP3811_CONF_TRACK_ALLOCATIONS 0
+#endif // ~ COMP3811_CONF_TRACK_ALLOCATIONS
+
 #endif // DEFAULTS_HPP_15153D57_59D5_4A86_A2F7_77B24A50AA8A
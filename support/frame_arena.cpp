@@ -0,0 +1,160 @@
+#include "frame_arena.hpp"
+
+#include <new>
+#include <algorithm>
+
+#include <cassert>
+#include <cstdint>
+
+#include "alloc_track.hpp"
+
+namespace
+{
+	// Blocks start on a cache line.
+	constexpr std::size_t kBlockAlignment_ = 64;
+}
+
+FrameArena::FrameArena( std::size_t aCapacity )
+{
+	if( aCapacity )
+		add_block_( aCapacity );
+}
+
+FrameArena::~FrameArena()
+{
+	for( auto const& block : mBlocks )
+		::operator delete( block.data, std::align_val_t(kBlockAlignment_) );
+}
+
+void FrameArena::reset() noexcept
+{
+	// Consolidate. The previous frame fit into the blocks, so it will fit
+	// into a single block of their combined size.
+	if( mBlocks.size() > 1 )
+	{
+		auto const size = capacity();
+
+		std::byte* data = nullptr;
+		try
+		{
+			data = static_cast<std::byte*>(::operator new( size, std::align_val_t(kBlockAlignment_) ));
+		}
+		catch( std::bad_alloc const& )
+		{
+			// Keep the blocks. Consolidation is retried at the next reset().
+		}
+
+		if( data )
+		{
+			for( auto const& block : mBlocks )
+				::operator delete( block.data, std::align_val_t(kBlockAlignment_) );
+
+			mBlocks.resize( 1 );
+			mBlocks[0] = Block_{ data, size };
+		}
+	}
+
+	mBlock = 0;
+	mOffset = 0;
+	mUsed = 0;
+}
+
+std::size_t FrameArena::used() const noexcept
+{
+	return mUsed;
+}
+std::size_t FrameArena::peak() const noexcept
+{
+	return mPeak;
+}
+std::size_t FrameArena::capacity() const noexcept
+{
+	std::size_t total = 0;
+	for( auto const& block : mBlocks )
+		total += block.size;
+	return total;
+}
+
+void* FrameArena::do_allocate( std::size_t aBytes, std::size_t aAlignment )
+{
+	assert( aAlignment && 0 == (aAlignment & (aAlignment-1)) );
+
+	for( ;; )
+	{
+		if( mBlock < mBlocks.size() )
+		{
+			auto const& block = mBlocks[mBlock];
+
+			auto const base = reinterpret_cast<std::uintptr_t>(block.data);
+			auto const begin = ((base + mOffset + aAlignment-1) & ~std::uintptr_t(aAlignment-1)) - base;
+
+			if( begin + aBytes <= block.size )
+			{
+				mUsed += begin + aBytes - mOffset;
+				mOffset = begin + aBytes;
+				mPeak = std::max( mPeak, mUsed );
+				return block.data + begin;
+			}
+
+			// Continue in the next block, if there is one (i.e., after a
+			// Scope released memory in an earlier block).
+			if( mBlock+1 < mBlocks.size() )
+			{
+				++mBlock;
+				mOffset = 0;
+				continue;
+			}
+		}
+
+		// Grow geometrically, so that a frame needs few extra blocks.
+		add_block_( std::max( aBytes + aAlignment, capacity() ) );
+		mBlock = mBlocks.size()-1;
+		mOffset = 0;
+	}
+}
+
+void FrameArena::do_deallocate( void*, std::size_t, std::size_t ) noexcept
+{}
+
+bool FrameArena::do_is_equal( std::pmr::memory_resource const& aOther ) const noexcept
+{
+	return this == &aOther;
+}
+
+void FrameArena::add_block_( std::size_t aMinimumSize )
+{
+	// Growing is what the arena does by design when a frame outgrows it; the
+	// next reset() makes room for such frames. The arena's users may thus
+	// run in no-allocation scopes.
+	prof::AllowAllocationScope const allowed;
+
+	mBlocks.reserve( mBlocks.size()+1 );
+
+	auto const size = (aMinimumSize + kBlockAlignment_-1) & ~(kBlockAlignment_-1);
+	auto* const data = static_cast<std::byte*>(::operator new( size, std::align_val_t(kBlockAlignment_) ));
+	mBlocks.emplace_back( Block_{ data, size } );
+}
+
+
+FrameArena::Scope::Scope( FrameArena& aArena ) noexcept
+	: mArena( aArena )
+	, mBlock( aArena.mBlock )
+	, mOffset( aArena.mOffset )
+	, mUsed( aArena.mUsed )
+{}
+
+FrameArena::Scope::~Scope()
+{
+	assert( mArena.mUsed >= mUsed ); // no reset() in between
+
+	mArena.mBlock = mBlock;
+	mArena.mOffset = mOffset;
+	mArena.mUsed = mUsed;
+}
+
+
+FrameArena& frame_arena()
+{
+	static FrameArena arena;
+	return arena;
+}
@@ -0,0 +1,89 @@
+#ifndef FRAME_ARENA_HPP_82C73570_B30F_4B9E_8E2B_92FB6706ADCF
+#define FRAME_ARENA_HPP_82C73570_B30F_4B9E_8E2B_92FB6706ADCF
+
+#include <vector>
+#include <memory_resource>
+
+#include <cstddef>
+
+/** FrameArena : linear allocator for data that lives for at most one frame
+ *
+ * Allocations bump a pointer through a block of memory; deallocation does
+ * nothing. reset() releases everything at once; the main loop calls it at
+ * the start of each frame. Scope releases the allocations made during its
+ * lifetime (e.g., the temporaries of a function) early.
+ *
+ * If a frame needs more memory than the block holds, further blocks are
+ * taken from the heap. The next reset() replaces all blocks by a single one
+ * that is large enough for the peak usage. In steady state, the arena thus
+ * makes no heap allocations. Taking further blocks is exempt from
+ * NO_ALLOCATION_SCOPE() (see alloc_track.hpp), as it only happens until the
+ * arena has grown to the frames' peak usage.
+ *
+ * FrameArena is a std::pmr::memory_resource, so standard containers can use
+ * it:
+ *
+ *	std::pmr::vector<Vec2f> points( &frame_arena() );
+ *
+ * Such containers must not outlive the frame (or the Scope) in which they
+ * allocated. The arena is not thread safe.
+ */
+class FrameArena final : public std::pmr::memory_resource
+{
+	public:
+		explicit FrameArena( std::size_t aCapacity = kDefaultCapacity );
+		~FrameArena();
+
+		FrameArena( FrameArena const& ) = delete;
+		FrameArena& operator= (FrameArena const&) = delete;
+
+	public:
+		void reset() noexcept;
+
+		std::size_t used() const noexcept; // bytes, since the last reset()
+		std::size_t peak() const noexcept; // bytes, maximum of used()
+		std::size_t capacity() const noexcept; // bytes, all blocks
+
+		class Scope
+		{
+			public:
+				explicit Scope( FrameArena& ) noexcept;
+				~Scope();
+
+				Scope( Scope const& ) = delete;
+				Scope& operator= (Scope const&) = delete;
+
+			private:
+				FrameArena& mArena;
+				std::size_t mBlock, mOffset, mUsed;
+		};
+
+	public:
+		static constexpr std::size_t kDefaultCapacity = std::size_t(1) << 20;
+
+	private:
+		void* do_allocate( std::size_t, std::size_t ) override;
+		void do_deallocate( void*, std::size_t, std::size_t ) noexcept override;
+		bool do_is_equal( std::pmr::memory_resource const& ) const noexcept override;
+
+		void add_block_( std::size_t aMinimumSize );
+
+	private:
+		struct Block_
+		{
+			std::byte* data;
+			std::size_t size;
+		};
+
+		std::vector<Block_> mBlocks;
+		std::size_t mBlock = 0; // current
+		std::size_t mOffset = 0; // into current
+
+		std::size_t mUsed = 0;
+		std::size_t mPeak = 0;
+};
+
+// Arena of the main loop.
+FrameArena& frame_arena();
+
+#endif // FRAME_ARENA_HPP_82C73570_B30F_4B9E_8E2B_92FB6706ADCF
@@ -0,0 +1,26 @@
+# Write the git revision of a checkout to a header, as
+#   #define COMP3811_GIT_REVISION "<revision>"
+# (see support/sysinfo.hpp). The header is only rewritten if the revision
+# changed, so that a rebuild does not recompile its users needlessly.
+#
+# Usage: git_revision.ps1 <checkout> <header>
+param( [string]$Checkout, [string]$Header )
+
+$rev = 'unknown'
+try
+{
+	$hash = git -C $Checkout rev-parse --short=12 HEAD 2>$null
+	if( 0 -eq $LASTEXITCODE -and $hash )
+	{
+		$rev = $hash
+		git -C $Checkout diff --quiet HEAD -- 2>$null
+		if( 0 -ne $LASTEXITCODE ) { $rev += '-dirty' }
+	}
+}
+catch {}
+
+$line = "#define COMP3811_GIT_REVISION `"$rev`""
+if( -not (Test-Path $Header) -or (Get-Content $Header -Raw).Trim() -ne $line )
+{
+	Set-Content -Path $Header -Value $line
+}
@@ -0,0 +1,17 @@
+#!/bin/sh
+# Write the git revision of a checkout to a header, as
+#   #define COMP3811_GIT_REVISION "<revision>"
+# (see support/sysinfo.hpp). The header is only rewritten if the revision
+# changed, so that a rebuild does not recompile its users needlessly.
+#
+# Usage: git_revision.sh <checkout> <header>
+
+rev=$(git -C "$1" rev-parse --short=12 HEAD 2>/dev/null) || rev=unknown
+if [ "$rev" != unknown ] && ! git -C "$1" diff --quiet HEAD -- 2>/dev/null; then
+	rev="$rev-dirty"
+fi
+
+line="#define COMP3811_GIT_REVISION \"$rev\""
+if [ "$(cat "$2" 2>/dev/null)" != "$line" ]; then
+	echo "$line" > "$2"
+fi
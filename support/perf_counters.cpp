@@ -0,0 +1,154 @@
+#include "perf_counters.hpp"
+
+#if defined(__linux__)
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+
+#	include <cstring>
+#endif // ~ __linux__
+
+namespace
+{
+#	if defined(__linux__)
+	struct EventDesc_
+	{
+		std::uint32_t type;
+		std::uint64_t config;
+	};
+
+	constexpr std::uint64_t cache_event_( std::uint64_t aCache, std::uint64_t aOp, std::uint64_t aResult )
+	{
+		return aCache | (aOp << 8) | (aResult << 16);
+	}
+
+	constexpr EventDesc_ kEvents_[PerfCounters::eventCount] = {
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HW_CACHE, cache_event_( PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS ) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+	};
+
+	int open_event_( EventDesc_ const& aEvent )
+	{
+		perf_event_attr attr;
+		std::memset( &attr, 0, sizeof(attr) );
+
+		attr.size = sizeof(attr);
+		attr.type = aEvent.type;
+		attr.config = aEvent.config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		// pid = 0, cpu = -1: this thread, on any CPU.
+		return int(syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ));
+	}
+#	endif // ~ __linux__
+}
+
+PerfCounters::PerfCounters()
+{
+	for( int i = 0; i < eventCount; ++i )
+	{
+#		if defined(__linux__)
+		mFds[i] = open_event_( kEvents_[i] );
+#		else
+		mFds[i] = -1;
+#		endif
+
+		mValues[i] = 0.0;
+	}
+}
+
+PerfCounters::~PerfCounters()
+{
+#	if defined(__linux__)
+	for( auto const fd : mFds )
+	{
+		if( fd >= 0 )
+			close( fd );
+	}
+#	endif // ~ __linux__
+}
+
+void PerfCounters::start() noexcept
+{
+#	if defined(__linux__)
+	for( auto const fd : mFds )
+	{
+		if( fd >= 0 )
+		{
+			ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+			ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+		}
+	}
+#	endif // ~ __linux__
+}
+
+void PerfCounters::stop() noexcept
+{
+#	if defined(__linux__)
+	for( auto const fd : mFds )
+	{
+		if( fd >= 0 )
+			ioctl( fd, PERF_EVENT_IOC_DISABLE, 0 );
+	}
+
+	for( int i = 0; i < eventCount; ++i )
+	{
+		mValues[i] = 0.0;
+		if( mFds[i] < 0 )
+			continue;
+
+		// { value, time enabled, time running }
+		std::uint64_t buffer[3] = {};
+		if( sizeof(buffer) != read( mFds[i], buffer, sizeof(buffer) ) )
+			continue;
+
+		// Scale if the counter was multiplexed with others
+		if( buffer[2] > 0 && buffer[2] < buffer[1] )
+			mValues[i] = double(buffer[0]) * double(buffer[1]) / double(buffer[2]);
+		else
+			mValues[i] = double(buffer[0]);
+	}
+#	endif // ~ __linux__
+}
+
+bool PerfCounters::available( Event aEvent ) const noexcept
+{
+	return mFds[aEvent] >= 0;
+}
+bool PerfCounters::any_available() const noexcept
+{
+	for( auto const fd : mFds )
+	{
+		if( fd >= 0 )
+			return true;
+	}
+
+	return false;
+}
+
+double PerfCounters::value( Event aEvent ) const noexcept
+{
+	return mValues[aEvent];
+}
+
+char const* PerfCounters::name( Event aEvent ) noexcept
+{
+	switch( aEvent )
+	{
+		case cycles: return "cycles";
+		case instructions: return "instructions";
+		case l1dMisses: return "L1D-misses";
+		case llcMisses: return "LLC-misses";
+		case branchMisses: return "branch-misses";
+		case eventCount: break;
+	}
+
+	return "<unknown>";
+}
@@ -0,0 +1,67 @@
+#ifndef PERF_COUNTERS_HPP_3FF5DD1D_223D_4B44_9129_0D849DBD06AD
+#define PERF_COUNTERS_HPP_3FF5DD1D_223D_4B44_9129_0D849DBD06AD
+
+#include <cstdint>
+#include <cstdlib>
+
+/* Hardware performance counters
+ *
+ * Thin wrapper around Linux' perf_event_open(2). It measures a fixed set of
+ * hardware events for the calling thread between start() and stop(). This
+ * does not require libpfm, and so works with the default premake build.
+ *
+ * Counters that cannot be opened (unsupported hardware, virtual machines,
+ * perf_event_paranoid restrictions, non-Linux systems) are reported as
+ * unavailable; the remaining ones still work. If the kernel multiplexes the
+ * counters, values are scaled by enabled/running time.
+ *
+ * Example:
+ *
+ *	PerfCounters counters;
+ *	counters.start();
+ *	... work ...
+ *	counters.stop();
+ *
+ *	if( counters.available( PerfCounters::cycles ) )
+ *		std::print( "{} cycles\n", counters.value( PerfCounters::cycles ) );
+ */
+class PerfCounters final
+{
+	public:
+		enum Event
+		{
+			cycles,
+			instructions,
+			l1dMisses,      // L1 data cache read misses
+			llcMisses,      // last level cache misses
+			branchMisses,
+
+			eventCount
+		};
+
+	public:
+		PerfCounters();
+		~PerfCounters();
+
+		PerfCounters( PerfCounters const& ) = delete;
+		PerfCounters& operator= (PerfCounters const&) = delete;
+
+	public:
+		// Reset and start counting.
+		void start() noexcept;
+		// Stop counting and read back the values.
+		void stop() noexcept;
+
+		bool available( Event ) const noexcept;
+		bool any_available() const noexcept;
+
+		double value( Event ) const noexcept;
+
+		static char const* name( Event ) noexcept;
+
+	private:
+		int mFds[eventCount];
+		double mValues[eventCount];
+};
+
+#endif // PERF_COUNTERS_HPP_3FF5DD1D_223D_4B44_9129_0D849DBD06AD
@@ -0,0 +1,63 @@
+#ifndef PERF_COUNTERS_BENCHMARK_HPP_B4E7857E_715A_423F_A811_646D1B0B6ADF
+#define PERF_COUNTERS_BENCHMARK_HPP_B4E7857E_715A_423F_A811_646D1B0B6ADF
+
+// Header-only glue between PerfCounters and Google Benchmark. Only include
+// this from the *-benchmark targets.
+
+#include <benchmark/benchmark.h>
+
+#include <print>
+
+#include "perf_counters.hpp"
+
+/* Report hardware counters normalized per pixel
+ *
+ * Adds "<event>/px" counters (plus "IPC") to the benchmark's results, where
+ * the counters were measured across all of the benchmark's iterations. This
+ * separates compute-bound kernels (high instructions/px, high IPC) from
+ * memory-bound ones (high miss counts, low IPC).
+ *
+ * Events that are not available are skipped. If no events are available at
+ * all, a note is printed once.
+ *
+ * Google Benchmark's own --benchmark_perf_counters option is additionally
+ * available when building with `premake5 --with-libpfm ...`.
+ */
+inline
+void report_perf_counters( benchmark::State& aState, PerfCounters const& aCounters, double aPixelsPerIteration )
+{
+	static constexpr char const* kNames[PerfCounters::eventCount] = {
+		"cycles/px",
+		"instr/px",
+		"L1D-miss/px",
+		"LLC-miss/px",
+		"br-miss/px"
+	};
+
+	if( !aCounters.any_available() )
+	{
+		static bool warned = false;
+		if( !warned )
+		{
+			std::print( stderr, "Note: hardware performance counters unavailable (see perf_event_open(2) and /proc/sys/kernel/perf_event_paranoid)\n" );
+			warned = true;
+		}
+		return;
+	}
+
+	double const pixels = aPixelsPerIteration * double(aState.iterations());
+	if( pixels <= 0.0 )
+		return;
+
+	for( int i = 0; i < PerfCounters::eventCount; ++i )
+	{
+		auto const event = PerfCounters::Event(i);
+		if( aCounters.available( event ) )
+			aState.counters[kNames[i]] = aCounters.value( event ) / pixels;
+	}
+
+	if( aCounters.available( PerfCounters::cycles ) && aCounters.available( PerfCounters::instructions ) && aCounters.value( PerfCounters::cycles ) > 0.0 )
+		aState.counters["IPC"] = aCounters.value( PerfCounters::instructions ) / aCounters.value( PerfCounters::cycles );
+}
+
+#endif // PERF_COUNTERS_BENCHMARK_HPP_B4E7857E_715A_423F_A811_646D1B0B6ADF
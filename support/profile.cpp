@@ -0,0 +1,159 @@
+#include "profile.hpp"
+
+#include <atomic>
+#include <algorithm>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include "error.hpp"
+
+namespace
+{
+	using Rep_ = prof::Clock::duration::rep;
+
+	// Stage table. Names are only ever appended; the count is published after
+	// the name has been written.
+	char const* gStageNames_[prof::kMaxStages] = {};
+	std::atomic<std::size_t> gStageCount_{ 0 };
+
+	// Per-stage totals of the frame that is currently in progress.
+	Rep_ gCurrent_[prof::kMaxStages] = {};
+	std::uint64_t gCurrentAllocations_[prof::kMaxStages] = {};
+
+	// Allocation count (all threads) at the end of the previous frame.
+	std::uint64_t gFrameStartAllocations_ = 0;
+
+	// Ring buffer with the per-stage times (in milliseconds) and allocation
+	// counts of completed frames. Slot (n % kHistoryFrames) holds frame n.
+	float gHistory_[prof::kHistoryFrames][prof::kMaxStages] = {};
+	std::uint32_t gAllocationHistory_[prof::kHistoryFrames][prof::kMaxStages] = {};
+	std::uint32_t gFrameAllocationHistory_[prof::kHistoryFrames] = {};
+	std::atomic<std::uint64_t> gFramesCompleted_{ 0 };
+
+	std::FILE* gCsv_ = nullptr;
+
+	constexpr float kRepToMilliseconds_ = 1000.f
+		* float(prof::Clock::period::num) / float(prof::Clock::period::den);
+}
+
+namespace prof
+{
+	StageId register_stage( char const* aName ) noexcept
+	{
+		auto const count = gStageCount_.load( std::memory_order_acquire );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			if( gStageNames_[i] == aName || 0 == std::strcmp( gStageNames_[i], aName ) )
+				return StageId(i);
+		}
+
+		if( count >= kMaxStages )
+			return StageId(kMaxStages);
+
+		gStageNames_[count] = aName;
+		gStageCount_.store( count+1, std::memory_order_release );
+		return StageId(count);
+	}
+
+	void record( StageId aStage, Clock::duration aTime, std::uint64_t aAllocations ) noexcept
+	{
+		if( aStage < kMaxStages )
+		{
+			gCurrent_[aStage] += aTime.count();
+			gCurrentAllocations_[aStage] += aAllocations;
+		}
+	}
+
+	void end_frame() noexcept
+	{
+		auto const frame = gFramesCompleted_.load( std::memory_order_relaxed );
+		auto const count = gStageCount_.load( std::memory_order_acquire );
+
+		auto& slot = gHistory_[frame & (kHistoryFrames-1)];
+		auto& allocSlot = gAllocationHistory_[frame & (kHistoryFrames-1)];
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			slot[i] = float(gCurrent_[i]) * kRepToMilliseconds_;
+			gCurrent_[i] = 0;
+
+			allocSlot[i] = std::uint32_t(std::min<std::uint64_t>( gCurrentAllocations_[i], UINT32_MAX ));
+			gCurrentAllocations_[i] = 0;
+		}
+
+		auto const allocations = allocation_count();
+		gFrameAllocationHistory_[frame & (kHistoryFrames-1)] = std::uint32_t(std::min<std::uint64_t>( allocations - gFrameStartAllocations_, UINT32_MAX ));
+		gFrameStartAllocations_ = allocations;
+
+		gFramesCompleted_.store( frame+1, std::memory_order_release );
+
+		if( gCsv_ )
+		{
+			for( std::size_t i = 0; i < count; ++i )
+				std::fprintf( gCsv_, "%llu,%s,%.4f,%u\n", (unsigned long long)frame, gStageNames_[i], double(slot[i]), unsigned(allocSlot[i]) );
+		}
+	}
+
+	std::size_t stage_count() noexcept
+	{
+		return gStageCount_.load( std::memory_order_acquire );
+	}
+	char const* stage_name( StageId aStage ) noexcept
+	{
+		if( aStage >= stage_count() )
+			return "";
+
+		return gStageNames_[aStage];
+	}
+
+	std::size_t frames_recorded() noexcept
+	{
+		return std::size_t(gFramesCompleted_.load( std::memory_order_acquire ));
+	}
+
+	float stage_milliseconds( StageId aStage, std::size_t aFramesAgo ) noexcept
+	{
+		auto const frames = gFramesCompleted_.load( std::memory_order_acquire );
+		if( aStage >= kMaxStages || aFramesAgo >= frames || aFramesAgo >= kHistoryFrames )
+			return 0.f;
+
+		return gHistory_[(frames-1-aFramesAgo) & (kHistoryFrames-1)][aStage];
+	}
+
+	std::uint32_t stage_allocations( StageId aStage, std::size_t aFramesAgo ) noexcept
+	{
+		auto const frames = gFramesCompleted_.load( std::memory_order_acquire );
+		if( aStage >= kMaxStages || aFramesAgo >= frames || aFramesAgo >= kHistoryFrames )
+			return 0;
+
+		return gAllocationHistory_[(frames-1-aFramesAgo) & (kHistoryFrames-1)][aStage];
+	}
+	std::uint32_t frame_allocations( std::size_t aFramesAgo ) noexcept
+	{
+		auto const frames = gFramesCompleted_.load( std::memory_order_acquire );
+		if( aFramesAgo >= frames || aFramesAgo >= kHistoryFrames )
+			return 0;
+
+		return gFrameAllocationHistory_[(frames-1-aFramesAgo) & (kHistoryFrames-1)];
+	}
+
+	void open_csv( char const* aPath )
+	{
+		close_csv();
+
+		gCsv_ = std::fopen( aPath, "w" );
+		if( !gCsv_ )
+			throw Error( "Unable to open profiler CSV output \"{}\"", aPath );
+
+		std::fprintf( gCsv_, "frame,stage,milliseconds,allocations\n" );
+	}
+	void close_csv() noexcept
+	{
+		if( gCsv_ )
+		{
+			std::fclose( gCsv_ );
+			gCsv_ = nullptr;
+		}
+	}
+}
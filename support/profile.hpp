@@ -0,0 +1,139 @@
+#ifndef PROFILE_HPP_A344794D_08E5_49FB_BB6E_3A19DF4D337E
+#define PROFILE_HPP_A344794D_08E5_49FB_BB6E_3A19DF4D337E
+
+#include <chrono>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "defaults.hpp"
+#include "alloc_track.hpp"
+
+/* Lightweight per-stage frame profiler
+ *
+ * Code marks the stages of a frame with PROFILE_SCOPE( "name" ). Each scope
+ * measures the time between its construction and destruction (using the
+ * steady clock) and adds it to the named stage's total for the current frame.
+ * PROFILE_FRAME_END() commits the per-stage totals of the frame into a ring
+ * buffer that holds the last kHistoryFrames frames.
+ *
+ * The profiler is meant to be driven from a single thread (the main loop). The
+ * ring buffer is published with atomic indices, so other code may read back
+ * completed frames without taking any locks.
+ *
+ * Example:
+ *
+ *	while( running )
+ *	{
+ *		{
+ *			PROFILE_SCOPE( "update" );
+ *			...
+ *		}
+ *
+ *		PROFILE_FRAME_END();
+ *	}
+ *
+ * The macros expand to nothing unless COMP3811_CONF_PROFILE is enabled (see
+ * defaults.hpp). By default, this is the case in debug builds only.
+ */
+namespace prof
+{
+	using Clock = std::chrono::steady_clock;
+
+	using StageId = std::uint32_t;
+
+	constexpr std::size_t kMaxStages = 32;
+	constexpr std::size_t kHistoryFrames = 256; // must be a power of two
+
+	static_assert( 0 == (kHistoryFrames & (kHistoryFrames-1)) );
+
+	// Returns the ID of the stage with the given name, registering it if
+	// necessary. The name must remain valid for the lifetime of the program
+	// (string literals are fine). Returns kMaxStages if the table is full.
+	StageId register_stage( char const* aName ) noexcept;
+
+	// Adds aTime and aAllocations to the stage's totals in the current frame.
+	void record( StageId, Clock::duration aTime, std::uint64_t aAllocations = 0 ) noexcept;
+
+	// Completes the current frame. Appends a row per stage to the CSV file if
+	// one is open.
+	void end_frame() noexcept;
+
+	// Readback. Stage IDs are contiguous in [0, stage_count()). A frame index
+	// of 0 refers to the most recently completed frame, 1 to the one before
+	// that, and so on. Frames that were not recorded return zero.
+	std::size_t stage_count() noexcept;
+	char const* stage_name( StageId ) noexcept;
+
+	std::size_t frames_recorded() noexcept;
+	float stage_milliseconds( StageId, std::size_t aFramesAgo ) noexcept;
+
+	// Heap allocations made by the thread running a stage, and by all
+	// threads during a frame. Zero unless COMP3811_CONF_TRACK_ALLOCATIONS is
+	// enabled (see alloc_track.hpp).
+	std::uint32_t stage_allocations( StageId, std::size_t aFramesAgo ) noexcept;
+	std::uint32_t frame_allocations( std::size_t aFramesAgo ) noexcept;
+
+	// CSV export. Each completed frame appends one
+	// "frame,stage,milliseconds,allocations" row per stage. Throws Error if
+	// the file cannot be opened.
+	void open_csv( char const* aPath );
+	void close_csv() noexcept;
+
+	class ScopedTimer final
+	{
+		public:
+			explicit ScopedTimer( StageId aStage ) noexcept
+				: mStage( aStage )
+				, mAllocations( thread_allocation_count() )
+				, mStart( Clock::now() )
+			{}
+
+			~ScopedTimer()
+			{
+				auto const elapsed = Clock::now() - mStart;
+				record( mStage, elapsed, thread_allocation_count() - mAllocations );
+			}
+
+			ScopedTimer( ScopedTimer const& ) = delete;
+			ScopedTimer& operator= (ScopedTimer const&) = delete;
+
+		private:
+			StageId mStage;
+			std::uint64_t mAllocations;
+			Clock::time_point mStart;
+	};
+}
+
+#define PROFILE_CAT_IMPL_( a, b ) a##b
+#define PROFILE_CAT_( a, b ) PROFILE_CAT_IMPL_( a, b )
+
+#if COMP3811_CONF_PROFILE
+	// Time the rest of the enclosing scope. aName should be a string literal;
+	// the stage is looked up once and cached.
+#	define PROFILE_SCOPE( aName )                                              \
+		static ::prof::StageId const PROFILE_CAT_(profStage_,__LINE__)      \
+			= ::prof::register_stage( aName );                              \
+		::prof::ScopedTimer PROFILE_CAT_(profTimer_,__LINE__)(              \
+			PROFILE_CAT_(profStage_,__LINE__)                               \
+		)                                                                   \
+		/*ENDM*/
+
+	// As PROFILE_SCOPE(), but aName may differ between invocations (e.g.,
+	// when profiling the iterations of a short loop separately). The stage is
+	// looked up each time.
+#	define PROFILE_SCOPE_DYNAMIC( aName )                                      \
+		::prof::ScopedTimer PROFILE_CAT_(profTimer_,__LINE__)(              \
+			::prof::register_stage( aName )                                 \
+		)                                                                   \
+		/*ENDM*/
+
+#	define PROFILE_FRAME_END() ::prof::end_frame()
+
+#else // !COMP3811_CONF_PROFILE
+#	define PROFILE_SCOPE( aName )           do {} while(0)
+#	define PROFILE_SCOPE_DYNAMIC( aName )   do {} while(0)
+#	define PROFILE_FRAME_END()              do {} while(0)
+#endif // ~ COMP3811_CONF_PROFILE
+
+#endif // PROFILE_HPP_A344794D_08E5_49FB_BB6E_3A19DF4D337E
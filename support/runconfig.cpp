@@ -27,6 +27,18 @@ RuntimeConfig parse_command_line( int aArgc, char const* const* aArgv )
 				synopsis_( aArgv[0] );
 				std::exit( 0 );
 			}
+			else if( 0 == std::strcmp( "aalines", name ) )
+			{
+				config.antialiasLines = true;
+			}
+			else if( 0 == std::strcmp( "impostors", name ) )
+			{
+				config.asteroidImpostors = true;
+			}
+			else if( 0 == std::strcmp( "collisions", name ) )
+			{
+				config.showCollisions = true;
+			}
 			else
 			{
 				throw Error( "Error while parsing command line\n" 
@@ -63,6 +75,35 @@ RuntimeConfig parse_command_line( int aArgc, char const* const* aArgv )
 				config.initialWindowWidth = width;
 				config.initialWindowHeight = height;
 			}
+			else if( 0 == std::strcmp( "line_width", name ) )
+			{
+				float width = 0.f;
+				if( 1 != std::sscanf( value, "%f%c", &width, &dummy ) || !(width >= 0.f) )
+				{
+					throw Error( "Error while parsing command line\n" 
+						"Value '{}' not valid for --line_width; expected non-negative number\n"
+						"Use --help to print available command line options", value );
+				}
+
+				config.lineWidth = width;
+			}
+			else if( 0 == std::strcmp( "threads", name ) )
+			{
+				// %u would accept (and wrap) negative values.
+				int count = 0;
+				if( 1 != std::sscanf( value, "%d%c", &count, &dummy ) || count < 1 || count > 256 )
+				{
+					throw Error( "Error while parsing command line\n" 
+						"Value '{}' not valid for --threads; expected integer between 1 and 256\n"
+						"Use --help to print available command line options", value );
+				}
+
+				config.threadCount = unsigned(count);
+			}
+			else if( 0 == std::strcmp( "profile_csv", name ) )
+			{
+				config.profileCsvPath = value;
+			}
 			else
 			{
 				throw Error( "Error while parsing command line\n" 
@@ -88,10 +129,20 @@ namespace
 
 Where <flag> may be one off the following
   help         : print this help and exit successfully
+  aalines      : draw the spaceship with anti-aliased lines (toggle with 'L')
+  impostors    : draw asteroids from pre-rasterized sprites where possible
+  collisions   : tint the spaceship while it overlaps an asteroid
 
 and where <option> and <value> may be the following
   geometry    <width>x<height>    set initial window size to (width, height)
   fbshift     <shift>             scale framebuffer by 2^-<shift> (unsigned int)
+  line_width  <pixels>            width of the spaceship's outline and the
+                                  profiler's budget lines; 0 (default) picks
+                                  one pixel per 720 rows of the framebuffer
+  threads     <count>             number of threads (1 to 256) for parallel
+                                  drawing; default: one per hardware thread
+  profile_csv <path>              write per-stage frame timings to <path>
+                                  (only in builds with the profiler enabled)
 
 Example:
   {0} --geometry=1920x1080 --fbshift=1
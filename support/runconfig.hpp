@@ -1,6 +1,8 @@
 #ifndef RUNCONFIG_HPP_6700ED29_C137_4C7A_8BE7_00D6C7CDD0D1
 #define RUNCONFIG_HPP_6700ED29_C137_4C7A_8BE7_00D6C7CDD0D1
 
+#include <string>
+
 namespace cfg
 {
 	constexpr unsigned kInitialWindowWidth = 1280;
@@ -13,6 +15,15 @@ struct RuntimeConfig
 	unsigned initialWindowHeight = cfg::kInitialWindowHeight;
 
 	unsigned framebufferScaleShift = 0;
+
+	bool antialiasLines = false;
+	bool asteroidImpostors = false;
+	bool showCollisions = false;
+	float lineWidth = 0.f; // pixels; 0 = scale with the framebuffer height
+
+	unsigned threadCount = 0; // 0 = one per hardware thread
+
+	std::string profileCsvPath; // empty = no CSV output
 };
 
 RuntimeConfig parse_command_line( int aArgc, char const* const* aArgv );
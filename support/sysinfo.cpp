@@ -0,0 +1,110 @@
+#include "sysinfo.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#endif // ~ x86-64
+
+// Generated by the build (see support/git_revision.sh), unless the build does
+// not run the pre-build step.
+#if __has_include("git_revision.gen.hpp")
+#	include "git_revision.gen.hpp"
+#else
+#	define COMP3811_GIT_REVISION "unknown"
+#endif
+
+namespace
+{
+	std::string trim_( std::string const& aStr )
+	{
+		auto const beg = aStr.find_first_not_of( " \t" );
+		if( std::string::npos == beg )
+			return {};
+
+		auto const end = aStr.find_last_not_of( " \t\r\n" );
+		return aStr.substr( beg, end - beg + 1 );
+	}
+
+#	if defined(__x86_64__) || defined(_M_X64)
+	void cpuid_( std::uint32_t aLeaf, std::uint32_t aRegs[4] )
+	{
+#		if defined(_MSC_VER)
+		int regs[4];
+		__cpuid( regs, int(aLeaf) );
+		for( int i = 0; i < 4; ++i )
+			aRegs[i] = std::uint32_t(regs[i]);
+#		else
+		__cpuid( aLeaf, aRegs[0], aRegs[1], aRegs[2], aRegs[3] );
+#		endif
+	}
+
+	std::string cpuid_brand_()
+	{
+		std::uint32_t regs[4];
+		cpuid_( 0x80000000u, regs );
+		if( regs[0] < 0x80000004u )
+			return {};
+
+		// The brand string is returned in EAX..EDX of leaves 0x80000002 to
+		// 0x80000004, 16 characters per leaf.
+		char brand[49] = {};
+		for( std::uint32_t i = 0; i < 3; ++i )
+		{
+			cpuid_( 0x80000002u + i, regs );
+			std::memcpy( brand + 16*i, regs, 16 );
+		}
+
+		return trim_( brand );
+	}
+#	endif // ~ x86-64
+
+	std::string proc_cpuinfo_model_()
+	{
+		FILE* info = std::fopen( "/proc/cpuinfo", "r" );
+		if( !info )
+			return {};
+
+		char line[512];
+		std::string ret;
+		while( std::fgets( line, sizeof(line), info ) )
+		{
+			// "model name" on x86, "Model" or "Hardware" on some ARM systems
+			if( 0 == std::strncmp( line, "model name", 10 ) || 0 == std::strncmp( line, "Model", 5 ) )
+			{
+				if( char const* colon = std::strchr( line, ':' ) )
+				{
+					ret = trim_( colon+1 );
+					break;
+				}
+			}
+		}
+
+		std::fclose( info );
+		return ret;
+	}
+}
+
+std::string git_revision()
+{
+	return COMP3811_GIT_REVISION;
+}
+
+std::string cpu_model()
+{
+#	if defined(__x86_64__) || defined(_M_X64)
+	if( auto brand = cpuid_brand_(); !brand.empty() )
+		return brand;
+#	endif // ~ x86-64
+
+	if( auto model = proc_cpuinfo_model_(); !model.empty() )
+		return model;
+
+	return "unknown";
+}
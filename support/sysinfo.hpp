@@ -0,0 +1,29 @@
+#ifndef SYSINFO_HPP_2DADDB0A_E38B_4A76_9319_DA56EA6CC3F2
+#define SYSINFO_HPP_2DADDB0A_E38B_4A76_9319_DA56EA6CC3F2
+
+#include <string>
+
+/* Information about the build and the machine
+ *
+ * Used to tag results (e.g., benchmark output) such that runs from different
+ * revisions or machines can be told apart.
+ */
+
+/* Git revision of the build
+ *
+ * Abbreviated hash of HEAD of the checkout that the program was built from,
+ * captured at build time. A "-dirty" suffix is appended if there were
+ * uncommitted changes to tracked files. Returns "unknown" if git was not
+ * available during the build.
+ */
+std::string git_revision();
+
+/* CPU model
+ *
+ * Brand string of the CPU, e.g. "AMD Ryzen 7 5800X 8-Core Processor". Uses
+ * CPUID on x86-64 and /proc/cpuinfo elsewhere on Linux. Returns "unknown" if
+ * neither is available.
+ */
+std::string cpu_model();
+
+#endif // SYSINFO_HPP_2DADDB0A_E38B_4A76_9319_DA56EA6CC3F2
@@ -0,0 +1,479 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+#include <cassert>
+
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#elif defined(__linux__)
+#	include <sched.h>
+#	include <pthread.h>
+#endif // ~ platform
+
+#include "error.hpp"
+#include "alloc_track.hpp"
+
+namespace
+{
+	// Pool and deque of the current thread, if it is a worker.
+	thread_local ThreadPool const* gCurrentPool_ = nullptr;
+	thread_local unsigned gCurrentQueue_ = 0;
+
+	// Initial capacity of each thread's deque
+	constexpr std::size_t kQueueCapacity_ = 256;
+
+	// Idle workers look for work this many times (yielding in between)
+	// before they go to sleep. Waking a sleeping thread takes several
+	// microseconds, which matters for the short bursts of work in a frame.
+	constexpr int kSpinRounds_ = 64;
+
+	std::vector<unsigned> allowed_cpus_();
+	void pin_( std::jthread&, unsigned aCpu ) noexcept;
+}
+
+ThreadPool::ThreadPool( unsigned aThreadCount )
+	: mThreadCount( aThreadCount ? aThreadCount : std::max( 1u, std::thread::hardware_concurrency() ) )
+	, mQueues( std::make_unique<Queue_[]>( mThreadCount ) )
+{
+	for( unsigned i = 0; i < mThreadCount; ++i )
+		mQueues[i].tasks.resize( kQueueCapacity_ );
+
+	auto const cpus = allowed_cpus_();
+	bool const pin = cpus.size() >= mThreadCount;
+
+	try
+	{
+		mWorkers.reserve( mThreadCount-1 );
+		for( unsigned i = 1; i < mThreadCount; ++i )
+		{
+			mWorkers.emplace_back( [this, i] { worker_( i ); } );
+			if( pin )
+				pin_( mWorkers.back(), cpus[i] );
+		}
+	}
+	catch( ... )
+	{
+		{
+			std::scoped_lock lock( mSleepMutex );
+			mStop = true;
+		}
+		mWake.notify_all();
+		throw;
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	if( executor() == this )
+		set_executor( nullptr );
+
+	{
+		std::scoped_lock lock( mSleepMutex );
+		mStop = true;
+	}
+	mWake.notify_all();
+
+	mWorkers.clear(); // joins
+}
+
+unsigned ThreadPool::concurrency() const noexcept
+{
+	return mThreadCount;
+}
+
+void ThreadPool::run( std::size_t aCount, void (*aTask)( void*, std::size_t ), void* aContext )
+{
+	if( 0 == aCount )
+		return;
+
+	if( 1 == mThreadCount )
+	{
+		for( std::size_t i = 0; i < aCount; ++i )
+			aTask( aContext, i );
+		return;
+	}
+
+	Job_ job;
+	job.remaining.store( aCount, std::memory_order_relaxed );
+
+	submit_( aCount, aTask, aContext, job );
+	wait_( job );
+}
+
+void ThreadPool::submit_( std::size_t aCount, void (*aTask)( void*, std::size_t ), void* aContext, Job_& aJob )
+{
+	// Deal the tasks out to all deques, starting with the current thread's,
+	// so that the workers can start without stealing.
+	unsigned const first = current_queue_();
+	for( unsigned i = 0; i < mThreadCount && i < aCount; ++i )
+	{
+		auto& queue = mQueues[(first + i) % mThreadCount];
+
+		std::scoped_lock lock( queue.mutex );
+		for( std::size_t index = i; index < aCount; index += mThreadCount )
+			queue.push_back( Task_{ aTask, aContext, index, &aJob } );
+	}
+
+	mQueued.fetch_add( aCount, std::memory_order_release );
+	wake_( aCount );
+}
+
+void ThreadPool::push_( Task_ const& aTask )
+{
+	auto& queue = mQueues[current_queue_()];
+	{
+		std::scoped_lock lock( queue.mutex );
+		queue.push_back( aTask );
+	}
+
+	mQueued.fetch_add( 1, std::memory_order_release );
+	wake_( 1 );
+}
+
+void ThreadPool::wait_( Job_& aJob )
+{
+	// Run tasks (of any job) until the job has completed. Sleep only if
+	// there is nothing left to take; the remaining tasks are then running on
+	// other threads.
+	unsigned const queue = current_queue_();
+	for( ;; )
+	{
+		auto const seen = mCompletions.load( std::memory_order_acquire );
+		if( 0 == aJob.remaining.load( std::memory_order_acquire ) )
+			break;
+
+		Task_ task;
+		if( pop_( queue, task ) )
+		{
+			execute_( task );
+			continue;
+		}
+
+		mCompletions.wait( seen, std::memory_order_acquire );
+	}
+
+	if( aJob.error )
+		std::rethrow_exception( aJob.error );
+}
+
+bool ThreadPool::pop_( unsigned aQueue, Task_& aTask )
+{
+	if( 0 == mQueued.load( std::memory_order_acquire ) )
+		return false;
+
+	// Newest task from the own deque...
+	{
+		auto& own = mQueues[aQueue];
+
+		std::scoped_lock lock( own.mutex );
+		if( 0 != own.count )
+		{
+			aTask = own.pop_back();
+			mQueued.fetch_sub( 1, std::memory_order_relaxed );
+			return true;
+		}
+	}
+
+	// ... or the oldest one from someone else's.
+	for( unsigned i = 1; i < mThreadCount; ++i )
+	{
+		auto& other = mQueues[(aQueue + i) % mThreadCount];
+
+		std::scoped_lock lock( other.mutex );
+		if( 0 != other.count )
+		{
+			aTask = other.pop_front();
+			mQueued.fetch_sub( 1, std::memory_order_relaxed );
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::execute_( Task_ const& aTask ) noexcept
+{
+	Job_& job = *aTask.job;
+
+	try
+	{
+		aTask.call( aTask.context, aTask.index );
+	}
+	catch( ... )
+	{
+		std::scoped_lock lock( job.errorMutex );
+		if( !job.error )
+			job.error = std::current_exception();
+	}
+
+	// The job may be destroyed as soon as remaining reaches zero. Waiters
+	// are therefore notified through a counter that belongs to the pool.
+	if( 1 == job.remaining.fetch_sub( 1, std::memory_order_acq_rel ) )
+	{
+		mCompletions.fetch_add( 1, std::memory_order_release );
+		mCompletions.notify_all();
+	}
+}
+
+void ThreadPool::Queue_::push_back( Task_ const& aTask )
+{
+	if( count == tasks.size() )
+	{
+		// Rare: the queue only grows if a job has more tasks per thread
+		// than it has ever had. Allowed in no-allocation scopes, like the
+		// growth of a FrameArena.
+		prof::AllowAllocationScope const allowed;
+
+		std::vector<Task_> grown( std::max<std::size_t>( 2*tasks.size(), kQueueCapacity_ ) );
+		for( std::size_t i = 0; i < count; ++i )
+			grown[i] = tasks[(head + i) & (tasks.size()-1)];
+
+		tasks = std::move(grown);
+		head = 0;
+	}
+
+	tasks[(head + count) & (tasks.size()-1)] = aTask;
+	++count;
+}
+
+ThreadPool::Task_ ThreadPool::Queue_::pop_back() noexcept
+{
+	assert( count );
+	--count;
+	return tasks[(head + count) & (tasks.size()-1)];
+}
+
+ThreadPool::Task_ ThreadPool::Queue_::pop_front() noexcept
+{
+	assert( count );
+	auto const ret = tasks[head];
+	head = (head + 1) & (tasks.size()-1);
+	--count;
+	return ret;
+}
+
+unsigned ThreadPool::current_queue_() const noexcept
+{
+	return gCurrentPool_ == this ? gCurrentQueue_ : 0;
+}
+
+void ThreadPool::wake_( std::size_t aNewTasks )
+{
+	// Workers check mQueued while holding the mutex. Taking it here (after
+	// mQueued was increased) ensures that none of them misses the change
+	// between checking and going to sleep.
+	{
+		std::scoped_lock lock( mSleepMutex );
+	}
+
+	if( aNewTasks > 1 )
+		mWake.notify_all();
+	else
+		mWake.notify_one();
+}
+
+void ThreadPool::worker_( unsigned aQueue )
+{
+	gCurrentPool_ = this;
+	gCurrentQueue_ = aQueue;
+
+	for( int idle = 0; ; )
+	{
+		Task_ task;
+		if( pop_( aQueue, task ) )
+		{
+			execute_( task );
+			idle = 0;
+			continue;
+		}
+
+		if( ++idle < kSpinRounds_ )
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock lock( mSleepMutex );
+		mWake.wait( lock, [this] {
+			return mStop || mQueued.load( std::memory_order_acquire ) > 0;
+		} );
+
+		if( mStop )
+			return;
+
+		idle = 0;
+	}
+}
+
+
+TaskGraph::Node TaskGraph::add( std::function<void()> aTask )
+{
+	mNodes.emplace_back();
+	mNodes.back().task = std::move(aTask);
+	mValidated = false;
+	return mNodes.size()-1;
+}
+
+void TaskGraph::precede( Node aBefore, Node aAfter )
+{
+	assert( aBefore < mNodes.size() && aAfter < mNodes.size() );
+
+	mNodes[aBefore].successors.emplace_back( aAfter );
+	++mNodes[aAfter].predecessors;
+	mValidated = false;
+}
+
+std::size_t TaskGraph::size() const noexcept
+{
+	return mNodes.size();
+}
+
+void TaskGraph::run( ThreadPool& aPool )
+{
+	if( mNodes.empty() )
+		return;
+
+	if( !mValidated )
+		validate_();
+
+	ThreadPool::Job_ job;
+	job.remaining.store( mNodes.size(), std::memory_order_relaxed );
+
+	mPool = &aPool;
+	mJob = &job;
+
+	for( auto& node : mNodes )
+		node.pending.store( node.predecessors, std::memory_order_relaxed );
+
+	for( Node i = 0; i < mNodes.size(); ++i )
+	{
+		if( 0 == mNodes[i].predecessors )
+			aPool.push_( ThreadPool::Task_{ &TaskGraph::run_node_, this, i, &job } );
+	}
+
+	try
+	{
+		aPool.wait_( job );
+	}
+	catch( ... )
+	{
+		mPool = nullptr;
+		mJob = nullptr;
+		throw;
+	}
+
+	mPool = nullptr;
+	mJob = nullptr;
+}
+
+void TaskGraph::run_node_( void* aGraph, std::size_t aNode )
+{
+	auto& graph = *static_cast<TaskGraph*>(aGraph);
+
+	try
+	{
+		graph.mNodes[aNode].task();
+	}
+	catch( ... )
+	{
+		graph.release_successors_( aNode );
+		throw;
+	}
+
+	graph.release_successors_( aNode );
+}
+
+void TaskGraph::release_successors_( Node aNode )
+{
+	for( auto const next : mNodes[aNode].successors )
+	{
+		if( 1 == mNodes[next].pending.fetch_sub( 1, std::memory_order_acq_rel ) )
+			mPool->push_( ThreadPool::Task_{ &TaskGraph::run_node_, this, next, mJob } );
+	}
+}
+
+void TaskGraph::validate_()
+{
+	// Kahn's algorithm: all nodes can be ordered iff there is no cycle. A
+	// cycle would otherwise make run() wait forever.
+	std::vector<unsigned> pending( mNodes.size() );
+	std::vector<Node> ready;
+	for( Node i = 0; i < mNodes.size(); ++i )
+	{
+		pending[i] = mNodes[i].predecessors;
+		if( 0 == pending[i] )
+			ready.emplace_back( i );
+	}
+
+	std::size_t ordered = 0;
+	while( !ready.empty() )
+	{
+		Node const node = ready.back();
+		ready.pop_back();
+		++ordered;
+
+		for( auto const next : mNodes[node].successors )
+		{
+			if( 0 == --pending[next] )
+				ready.emplace_back( next );
+		}
+	}
+
+	if( ordered != mNodes.size() )
+		throw Error( "TaskGraph: dependencies between {} of {} tasks form a cycle", mNodes.size() - ordered, mNodes.size() );
+
+	mValidated = true;
+}
+
+
+namespace
+{
+	std::vector<unsigned> allowed_cpus_()
+	{
+		std::vector<unsigned> cpus;
+
+#		if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO( &set );
+		if( 0 == sched_getaffinity( 0, sizeof(set), &set ) )
+		{
+			for( unsigned i = 0; i < CPU_SETSIZE; ++i )
+			{
+				if( CPU_ISSET( i, &set ) )
+					cpus.emplace_back( i );
+			}
+		}
+#		elif defined(_WIN32)
+		DWORD_PTR process = 0, system = 0;
+		if( GetProcessAffinityMask( GetCurrentProcess(), &process, &system ) )
+		{
+			for( unsigned i = 0; i < sizeof(DWORD_PTR)*8; ++i )
+			{
+				if( process & (DWORD_PTR(1) << i) )
+					cpus.emplace_back( i );
+			}
+		}
+#		endif // ~ platform
+
+		return cpus;
+	}
+
+	// Best effort. Failures are ignored; the thread then runs unpinned.
+	void pin_( std::jthread& aThread, unsigned aCpu ) noexcept
+	{
+#		if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO( &set );
+		CPU_SET( aCpu, &set );
+		pthread_setaffinity_np( aThread.native_handle(), sizeof(set), &set );
+#		elif defined(_WIN32)
+		SetThreadAffinityMask( aThread.native_handle(), DWORD_PTR(1) << aCpu );
+#		else
+		(void)aThread;
+		(void)aCpu;
+#		endif // ~ platform
+	}
+}
@@ -0,0 +1,177 @@
+#ifndef THREAD_POOL_HPP_C32C4071_9A91_4E5C_8B92_B883941D30EC
+#define THREAD_POOL_HPP_C32C4071_9A91_4E5C_8B92_B883941D30EC
+
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../draw2d/parallel.hpp"
+
+/** ThreadPool : persistent worker threads with work stealing
+ *
+ * The pool starts its threads once and keeps them until it is destroyed, so
+ * parallel work in a frame does not pay for starting threads. A pool with N
+ * threads starts N-1 workers; the thread that submits work runs tasks too
+ * while it waits for them to complete.
+ *
+ * Each thread owns a deque of tasks. It takes tasks from the back of its own
+ * deque, and, once that is empty, steals from the front of the others'.
+ * Workers that find no work sleep until new tasks are submitted.
+ *
+ * Workers are pinned to separate CPUs (the i-th worker to the i-th CPU that
+ * the process may run on, leaving the first to the submitting thread), unless
+ * there are more threads than CPUs.
+ *
+ * ThreadPool implements draw2d's Executor; install it with set_executor()
+ * to have draw2d use it (see draw2d/parallel.hpp). Tasks may submit work to
+ * the pool themselves.
+ */
+class ThreadPool final : public Executor
+{
+	public:
+		// aThreadCount = 0 uses std::thread::hardware_concurrency().
+		explicit ThreadPool( unsigned aThreadCount = 0 );
+		~ThreadPool();
+
+		ThreadPool( ThreadPool const& ) = delete;
+		ThreadPool& operator= (ThreadPool const&) = delete;
+
+	public:
+		unsigned concurrency() const noexcept override;
+
+		void run( std::size_t aCount, void (*aTask)( void*, std::size_t ), void* aContext ) override;
+
+		/* Call aBody( begin, end ) for consecutive ranges that cover
+		 * [aBegin, aEnd), each at most aGrain long (e.g., rows of a
+		 * surface). Returns once all calls have returned.
+		 */
+		template< typename tBody >
+		void parallel_for( int aBegin, int aEnd, int aGrain, tBody&& aBody );
+
+	private:
+		friend class TaskGraph;
+
+		struct Job_
+		{
+			std::atomic<std::size_t> remaining;
+
+			std::mutex errorMutex;
+			std::exception_ptr error;
+		};
+
+		struct Task_
+		{
+			void (*call)( void*, std::size_t );
+			void* context;
+			std::size_t index;
+			Job_* job;
+		};
+
+		// Deque of tasks, as a ring buffer. Unlike std::deque, it does not
+		// allocate and free blocks as tasks come and go; it only grows.
+		struct alignas(64) Queue_
+		{
+			std::mutex mutex;
+			std::vector<Task_> tasks; // ring buffer, size is a power of two
+			std::size_t head = 0, count = 0;
+
+			void push_back( Task_ const& );
+			Task_ pop_back() noexcept;
+			Task_ pop_front() noexcept;
+		};
+
+		void submit_( std::size_t aCount, void (*)( void*, std::size_t ), void*, Job_& );
+		void push_( Task_ const& ); // onto the current thread's deque
+		void wait_( Job_& );
+
+		bool pop_( unsigned aQueue, Task_& );
+		void execute_( Task_ const& ) noexcept;
+
+		unsigned current_queue_() const noexcept;
+		void wake_( std::size_t aNewTasks );
+
+		void worker_( unsigned aQueue );
+
+	private:
+		unsigned mThreadCount;
+		std::unique_ptr<Queue_[]> mQueues; // [0] is for threads outside the pool
+
+		std::atomic<std::size_t> mQueued{ 0 };
+		std::atomic<std::uint32_t> mCompletions{ 0 }; // jobs completed
+
+		std::mutex mSleepMutex;
+		std::condition_variable mWake;
+		bool mStop = false;
+
+		std::vector<std::jthread> mWorkers;
+};
+
+/** TaskGraph : tasks with dependencies
+ *
+ * A task starts once all the tasks that precede it have completed. Tasks
+ * without predecessors start immediately. The graph can be run repeatedly,
+ * e.g., once per frame; it must not be changed while it runs.
+ *
+ * Example:
+ *
+ *	TaskGraph graph;
+ *	auto const update = graph.add( [&] { asteroids.update( dt ); } );
+ *	auto const draw = graph.add( [&] { asteroids.draw( surface ); } );
+ *	graph.precede( update, draw );
+ *
+ *	graph.run( pool );
+ */
+class TaskGraph
+{
+	public:
+		using Node = std::size_t;
+
+		Node add( std::function<void()> aTask );
+		void precede( Node aBefore, Node aAfter );
+
+		std::size_t size() const noexcept;
+
+		// Runs all tasks and returns once they have completed. If tasks
+		// throw, their successors still run, and one of the exceptions is
+		// rethrown. Throws Error if the dependencies form a cycle.
+		void run( ThreadPool& );
+
+	private:
+		struct Node_
+		{
+			std::function<void()> task;
+			std::vector<Node> successors;
+			unsigned predecessors = 0;
+			std::atomic<unsigned> pending{ 0 };
+		};
+
+		static void run_node_( void*, std::size_t );
+		void release_successors_( Node );
+
+		void validate_();
+
+	private:
+		std::deque<Node_> mNodes; // stable addresses
+		bool mValidated = false;
+
+		ThreadPool* mPool = nullptr;
+		ThreadPool::Job_* mJob = nullptr;
+};
+
+
+template< typename tBody > inline
+void ThreadPool::parallel_for( int aBegin, int aEnd, int aGrain, tBody&& aBody )
+{
+	::parallel_for( this, aBegin, aEnd, aGrain, static_cast<tBody&&>(aBody) );
+}
+
+#endif // THREAD_POOL_HPP_C32C4071_9A91_4E5C_8B92_B883941D30EC
@@ -144,6 +144,8 @@ project( "x-benchmark" )
 
 	filter "system:linux"
 		defines { "BENCHMARK_HAS_PTHREAD_AFFINITY=1" }
+	filter { "system:linux", "options:with-libpfm" }
+		defines { "HAVE_LIBPFM=1" }
 	filter "system:windows"
 		links { "shlwapi" }
 	--filter "system:macosx"
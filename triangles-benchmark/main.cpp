@@ -0,0 +1,329 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdint>
+
+#include "../draw2d/draw.hpp"
+#include "../draw2d/shape.hpp"
+#include "../draw2d/surface-ex.hpp"
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/mat22.hpp"
+
+#include "../main/defaults.hpp"
+#include "../main/asteroid.hpp"
+
+#include "../support/benchmark_main.hpp"
+#include "../support/perf_counters_benchmark.hpp"
+
+namespace
+{
+	struct Triangle_
+	{
+		Vec2f p0, p1, p2;
+	};
+
+	constexpr ColorF kC0{ 1.f, 0.2f, 0.2f };
+	constexpr ColorF kC1{ 0.2f, 1.f, 0.2f };
+	constexpr ColorF kC2{ 0.2f, 0.2f, 1.f };
+
+	constexpr ColorU8_sRGB kSolid{ 200, 120, 40 };
+
+	enum class Fill_
+	{
+		interp, // draw_triangle_interp()
+		solid   // draw_triangle_solid()
+	};
+
+	// Number of pixels written when drawing the triangles once. This is
+	// measured rather than computed from the triangle areas, so that it
+	// accounts for clipping and for the rasterizer's fill convention.
+	std::size_t count_covered_pixels_( SurfaceEx& aSurface, std::vector<Triangle_> const& aTris )
+	{
+		std::size_t count = 0;
+		for( auto const& tri : aTris )
+		{
+			aSurface.clear();
+			draw_triangle_interp( aSurface, tri.p0, tri.p1, tri.p2, kC0, kC1, kC2 );
+
+			auto const* ptr = aSurface.get_surface_ptr();
+			auto const pixels = std::size_t(aSurface.get_width()) * aSurface.get_height();
+			for( std::size_t i = 0; i < pixels; ++i, ptr += 4 )
+			{
+				if( ptr[0] || ptr[1] || ptr[2] )
+					++count;
+			}
+		}
+
+		aSurface.clear();
+		return count;
+	}
+
+	void run_triangles_( benchmark::State& aState, std::vector<Triangle_> const& aTris, Fill_ aFill = Fill_::interp )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		SurfaceEx surface( width, height );
+		auto const pixels = count_covered_pixels_( surface, aTris );
+
+		PerfCounters perf;
+		perf.start();
+
+		for( auto _ : aState )
+		{
+			if( Fill_::solid == aFill )
+			{
+				for( auto const& tri : aTris )
+					draw_triangle_solid( surface, tri.p0, tri.p1, tri.p2, kSolid );
+			}
+			else
+			{
+				for( auto const& tri : aTris )
+					draw_triangle_interp( surface, tri.p0, tri.p1, tri.p2, kC0, kC1, kC2 );
+			}
+
+			benchmark::ClobberMemory();
+		}
+
+		perf.stop();
+
+		using Counter_ = benchmark::Counter;
+		aState.counters["pixels"] = Counter_( double(pixels) * aState.iterations(), Counter_::kIsRate );
+		aState.counters["triangles"] = Counter_( double(aTris.size()) * aState.iterations(), Counter_::kIsRate );
+
+		aState.SetBytesProcessed( std::int64_t(pixels) * 4 * aState.iterations() );
+
+		report_perf_counters( aState, perf, double(pixels) );
+	}
+
+	// Place aCount copies of the triangle (given relative to its origin) on a
+	// regular grid across the surface.
+	std::vector<Triangle_> tile_( Triangle_ const& aTri, std::size_t aCount, float aWidth, float aHeight, float aExtent )
+	{
+		std::vector<Triangle_> ret;
+		ret.reserve( aCount );
+
+		std::size_t const perRow = std::max( std::size_t(1), std::size_t((aWidth-aExtent) / aExtent) );
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			float const x = float(i % perRow) * aExtent;
+			float const y = std::fmod( float(i / perRow) * aExtent, std::max( 1.f, aHeight-aExtent ) );
+			Vec2f const offs{ x, y };
+			ret.push_back( { aTri.p0 + offs, aTri.p1 + offs, aTri.p2 + offs } );
+		}
+
+		return ret;
+	}
+
+
+	// Asteroid-sized triangles: one wedge of an 18-point fan with radius 30.
+	std::vector<Triangle_> small_triangles_( float aWidth, float aHeight )
+	{
+		return tile_( { { 0.f, 0.f }, { 30.f, 0.f }, { 28.f, 10.f } }, 256, aWidth, aHeight, 32.f );
+	}
+	std::vector<Triangle_> medium_triangles_( float aWidth, float aHeight )
+	{
+		return tile_( { { 0.f, 0.f }, { 200.f, 30.f }, { 60.f, 190.f } }, 16, aWidth, aHeight, 210.f );
+	}
+	std::vector<Triangle_> large_triangles_( float aWidth, float aHeight )
+	{
+		return { { { 0.1f*aWidth, 0.1f*aHeight }, { 0.9f*aWidth, 0.2f*aHeight }, { 0.4f*aWidth, 0.9f*aHeight } } };
+	}
+	// Single triangle covering the whole surface (compare
+	// triangles-test/specials.cpp "Fullscreen").
+	std::vector<Triangle_> fullscreen_triangles_( float aWidth, float aHeight )
+	{
+		return { { { -5.f, -5.f }, { 2.2f*aWidth, -5.f }, { -5.f, 2.2f*aHeight } } };
+	}
+
+	void benchmark_small_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, small_triangles_( w, h ) );
+	}
+	void benchmark_medium_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, medium_triangles_( w, h ) );
+	}
+	void benchmark_large_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, large_triangles_( w, h ) );
+	}
+	void benchmark_fullscreen_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, fullscreen_triangles_( w, h ) );
+	}
+
+	// Same triangles, flat shaded with draw_triangle_solid().
+	void benchmark_solid_small_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, small_triangles_( w, h ), Fill_::solid );
+	}
+	void benchmark_solid_medium_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, medium_triangles_( w, h ), Fill_::solid );
+	}
+	void benchmark_solid_large_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, large_triangles_( w, h ), Fill_::solid );
+	}
+	void benchmark_solid_fullscreen_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, fullscreen_triangles_( w, h ), Fill_::solid );
+	}
+
+	// Long thin triangles: large bounding box, very few covered pixels.
+	void benchmark_sliver_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+
+		std::vector<Triangle_> tris;
+		for( std::size_t i = 0; i < 8; ++i )
+		{
+			float const offs = 4.f * float(i);
+			tris.push_back( { { 10.f+offs, 10.f }, { w-10.f, h-10.f-offs }, { w-10.f, h-8.f-offs } } );
+		}
+
+		run_triangles_( aState, tris );
+	}
+
+	// Mostly offscreen: only a corner of each triangle overlaps the surface.
+	void benchmark_offscreen_( benchmark::State& aState )
+	{
+		auto const w = float(aState.range(0)), h = float(aState.range(1));
+		run_triangles_( aState, {
+			{ { -400.f, -300.f }, { 100.f, -250.f }, { -350.f, 120.f } },
+			{ { w+400.f, -300.f }, { w-100.f, -250.f }, { w+350.f, 120.f } },
+			{ { -400.f, h+300.f }, { 100.f, h+250.f }, { -350.f, h-120.f } },
+			{ { w+400.f, h+300.f }, { w-100.f, h+250.f }, { w+350.f, h-120.f } },
+			{ { -2000.f, 0.5f*h }, { w+2000.f, 0.5f*h-40.f }, { w+2000.f, 0.5f*h+40.f } }
+		} );
+	}
+
+	// Triangle fans created by make_asteroid(), drawn via TriangleFan::draw.
+	void benchmark_asteroid_fans_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const count = std::size_t(aState.range(2));
+
+		SurfaceEx surface( width, height );
+		surface.clear();
+
+		RNG rng( 3811 );
+
+		std::vector<TriangleFan> fans;
+		std::vector<Vec2f> positions;
+		std::vector<Mat22f> rotations;
+
+		std::uniform_real_distribution<float> xpos( 40.f, width-40.f );
+		std::uniform_real_distribution<float> ypos( 40.f, height-40.f );
+		std::uniform_real_distribution<float> angle( 0.f, 6.2831853f );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			fans.emplace_back( make_asteroid( rng ) );
+			positions.push_back( { xpos( rng ), ypos( rng ) } );
+			rotations.push_back( make_rotation_2d( angle( rng ) ) );
+		}
+
+		// Pixels written per iteration, for the per-pixel hardware counters.
+		// Overlapping asteroids are counted once.
+		for( std::size_t i = 0; i < count; ++i )
+			fans[i].draw( surface, rotations[i], positions[i] );
+
+		std::size_t pixels = 0;
+		auto const* ptr = surface.get_surface_ptr();
+		for( std::size_t i = 0; i < std::size_t(width)*height; ++i, ptr += 4 )
+		{
+			if( ptr[0] || ptr[1] || ptr[2] )
+				++pixels;
+		}
+
+		PerfCounters perf;
+		perf.start();
+
+		for( auto _ : aState )
+		{
+			for( std::size_t i = 0; i < count; ++i )
+				fans[i].draw( surface, rotations[i], positions[i] );
+
+			benchmark::ClobberMemory();
+		}
+
+		perf.stop();
+
+		// make_asteroid() defaults to 18 points around the center -> 18
+		// triangles per fan.
+		using Counter_ = benchmark::Counter;
+		aState.counters["triangles"] = Counter_( 18.0 * double(count) * aState.iterations(), Counter_::kIsRate );
+		aState.counters["fans"] = Counter_( double(count) * aState.iterations(), Counter_::kIsRate );
+
+		report_perf_counters( aState, perf, double(pixels) );
+	}
+}
+
+BENCHMARK( benchmark_small_ )
+	->Args( { 1920, 1080 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_medium_ )
+	->Args( { 1920, 1080 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_large_ )
+	->Args( { 1920, 1080 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_fullscreen_ )
+	->Args( { 640, 480 } )
+	->Args( { 1920, 1080 } )
+	->Args( { 3840, 2160 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_solid_small_ )
+	->Args( { 1920, 1080 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_solid_medium_ )
+	->Args( { 1920, 1080 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_solid_large_ )
+	->Args( { 1920, 1080 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_solid_fullscreen_ )
+	->Args( { 640, 480 } )
+	->Args( { 1920, 1080 } )
+	->Args( { 3840, 2160 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_sliver_ )
+	->Args( { 1920, 1080 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_offscreen_ )
+	->Args( { 1920, 1080 } )
+	->Unit( benchmark::kMicrosecond );
+
+BENCHMARK( benchmark_asteroid_fans_ )
+	->ArgsProduct( {
+		{ 1920 }, { 1080 },
+		{ 16, 128, 1024 }  // number of asteroids
+	} )
+	->Unit( benchmark::kMicrosecond );
+
+COMP3811_BENCHMARK_MAIN();
@@ -0,0 +1,286 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <numbers>
+#include <vector>
+
+#include <cmath>
+
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+#include "../draw2d/stroke.hpp"
+
+namespace
+{
+	// Draws each triangle into its own (cleared) surface and counts how often
+	// each pixel was covered in total.
+	class CoverageCounter_
+	{
+		public:
+			CoverageCounter_( std::uint32_t aWidth, std::uint32_t aHeight )
+				: mSurface( aWidth, aHeight )
+				, mCounts( std::size_t(aWidth) * aHeight, 0 )
+			{}
+
+			void add( Vec2f aP0, Vec2f aP1, Vec2f aP2 )
+			{
+				mSurface.clear();
+				draw_triangle_interp( mSurface, aP0, aP1, aP2,
+					{ 1.f, 1.f, 1.f }, { 1.f, 1.f, 1.f }, { 1.f, 1.f, 1.f }
+				);
+
+				auto const* ptr = mSurface.get_surface_ptr();
+				for( std::size_t i = 0; i < mCounts.size(); ++i )
+				{
+					if( ptr[4*i] )
+						++mCounts[i];
+				}
+			}
+
+			int count( std::uint32_t aX, std::uint32_t aY ) const
+			{
+				return mCounts[aY * mSurface.get_width() + aX];
+			}
+
+		private:
+			Surface mSurface;
+			std::vector<int> mCounts;
+	};
+}
+
+TEST_CASE( "Watertight triangle meshes", "[watertight][triangle]" )
+{
+	constexpr std::uint32_t width = 96, height = 64;
+	CoverageCounter_ coverage( width, height );
+
+	SECTION( "Jittered grid covering the surface" )
+	{
+		// Triangulated grid covering the whole surface. Inner vertices are
+		// moved by fractional amounts, so that many pixel centers lie on or
+		// very near to shared edges. Every pixel must be covered exactly once.
+		constexpr int cellsX = 7, cellsY = 5;
+
+		auto const vertex = [&] (int aI, int aJ) {
+			float x = aI * float(width) / cellsX;
+			float y = aJ * float(height) / cellsY;
+			if( aI > 0 && aI < cellsX ) x += 0.37f * float((aI*7 + aJ*3) % 5 - 2);
+			if( aJ > 0 && aJ < cellsY ) y += 0.29f * float((aI*5 + aJ*11) % 5 - 2);
+			return Vec2f{ x, y };
+		};
+
+		for( int j = 0; j < cellsY; ++j )
+		{
+			for( int i = 0; i < cellsX; ++i )
+			{
+				Vec2f const a = vertex( i, j ), b = vertex( i+1, j );
+				Vec2f const c = vertex( i, j+1 ), d = vertex( i+1, j+1 );
+
+				// Alternate the diagonal and the winding order.
+				if( (i + j) % 2 )
+				{
+					coverage.add( a, b, d );
+					coverage.add( a, c, d );
+				}
+				else
+				{
+					coverage.add( a, c, b );
+					coverage.add( b, c, d );
+				}
+			}
+		}
+
+		int holes = 0, overlaps = 0;
+		for( std::uint32_t y = 0; y < height; ++y )
+		{
+			for( std::uint32_t x = 0; x < width; ++x )
+			{
+				int const count = coverage.count( x, y );
+				if( 0 == count ) ++holes;
+				if( count > 1 ) ++overlaps;
+			}
+		}
+
+		REQUIRE( 0 == holes );
+		REQUIRE( 0 == overlaps );
+	}
+
+	SECTION( "Triangle fan" )
+	{
+		// Triangle fan, as drawn by TriangleFan::draw(). Pixels near the
+		// center and on the spokes must be covered exactly once.
+		Vec2f const center{ 47.3f, 31.6f };
+		constexpr int spokes = 13;
+		constexpr float radius = 29.f;
+
+		std::vector<Vec2f> rim;
+		for( int i = 0; i < spokes; ++i )
+		{
+			float const angle = 2.f * std::numbers::pi_v<float> * float(i) / spokes + 0.1f;
+			rim.emplace_back( Vec2f{ center.x + radius * std::cos( angle ), center.y + radius * std::sin( angle ) } );
+		}
+
+		for( int i = 0; i < spokes; ++i )
+			coverage.add( center, rim[i], rim[(i+1) % spokes] );
+
+		int holes = 0, overlaps = 0;
+		for( std::uint32_t y = 0; y < height; ++y )
+		{
+			for( std::uint32_t x = 0; x < width; ++x )
+			{
+				int const count = coverage.count( x, y );
+				if( count > 1 ) ++overlaps;
+
+				// The inscribed circle of the polygon has radius
+				// radius * cos(pi/spokes); stay a pixel away from it.
+				float const dx = float(x) + 0.5f - center.x;
+				float const dy = float(y) + 0.5f - center.y;
+				float const inner = radius * std::cos( std::numbers::pi_v<float> / spokes ) - 1.f;
+				if( dx*dx + dy*dy < inner*inner && 0 == count )
+					++holes;
+			}
+		}
+
+		REQUIRE( 0 == holes );
+		REQUIRE( 0 == overlaps );
+	}
+
+	SECTION( "Shared edge through pixel centers" )
+	{
+		// The shared diagonal passes exactly through pixel centers (x+0.5,
+		// y+0.5). The top-left rule must assign each of them to one triangle.
+		Vec2f const a{ 0.5f, 0.5f }, b{ 40.5f, 0.5f }, c{ 0.5f, 40.5f }, d{ 40.5f, 40.5f };
+		coverage.add( a, b, d );
+		coverage.add( a, d, c );
+
+		int holes = 0, overlaps = 0, outside = 0;
+		for( std::uint32_t y = 0; y < height; ++y )
+		{
+			for( std::uint32_t x = 0; x < width; ++x )
+			{
+				int const count = coverage.count( x, y );
+				if( count > 1 ) ++overlaps;
+
+				// Pixels 0..39 in both directions (the right and bottom
+				// edges of the square are excluded by the fill rule).
+				if( x < 40 && y < 40 && 0 == count )
+					++holes;
+				if( (x >= 40 || y >= 40) && 0 != count )
+					++outside;
+			}
+		}
+
+		REQUIRE( 0 == holes );
+		REQUIRE( 0 == overlaps );
+		REQUIRE( 0 == outside );
+	}
+}
+
+TEST_CASE( "Solid and interpolated triangles cover the same pixels", "[watertight][triangle][solid]" )
+{
+	// draw_triangle_solid() finds spans per row instead of testing each
+	// pixel. The coverage must nevertheless be identical.
+	Surface interp( 160, 120 ), solid( 160, 120 );
+
+	std::minstd_rand rng( 3811 );
+	std::uniform_real_distribution<float> near( -40.f, 200.f );
+	std::uniform_real_distribution<float> far( -1e6f, 1e6f );
+
+	int mismatches = 0;
+	for( int i = 0; i < 500; ++i )
+	{
+		auto& dist = (i % 5) ? near : far;
+		Vec2f const p0{ dist( rng ), dist( rng ) };
+		Vec2f const p1{ dist( rng ), dist( rng ) };
+		Vec2f const p2{ near( rng ), near( rng ) };
+
+		interp.clear();
+		draw_triangle_interp( interp, p0, p1, p2, { 1.f, 1.f, 1.f }, { 1.f, 1.f, 1.f }, { 1.f, 1.f, 1.f } );
+
+		solid.clear();
+		draw_triangle_solid( solid, p0, p1, p2, { 255, 255, 255 } );
+
+		auto const* a = interp.get_surface_ptr();
+		auto const* b = solid.get_surface_ptr();
+		for( std::size_t j = 0; j < std::size_t(160)*120; ++j )
+		{
+			if( (0 != a[4*j]) != (0 != b[4*j]) )
+				++mismatches;
+		}
+	}
+
+	REQUIRE( 0 == mismatches );
+}
+
+TEST_CASE( "Stroked polylines", "[watertight][triangle][stroke]" )
+{
+	// Zig-zag with both sharp and shallow turns to either side, and one turn
+	// that exceeds the default miter limit.
+	Vec2f const points[] = {
+		{ 8.3f, 50.2f }, { 22.6f, 12.1f }, { 37.4f, 48.7f }, { 55.1f, 40.3f },
+		{ 61.8f, 10.6f }, { 64.2f, 52.9f }, { 88.5f, 30.4f }
+	};
+	constexpr std::size_t count = sizeof(points)/sizeof(points[0]);
+
+	Mat22f const identity{ 1.f, 0.f, 0.f, 1.f };
+
+	constexpr std::uint32_t width = 96, height = 64;
+
+	auto const check = [&] (EJoin aJoin) {
+		StrokeStyle style;
+		style.width = 4.f;
+		style.join = aJoin;
+
+		StrokeMesh mesh;
+		REQUIRE( mesh.update( count, points, identity, { 0.f, 0.f }, style ) );
+
+		CoverageCounter_ coverage( width, height );
+
+		auto const verts = mesh.vertices();
+		auto const indices = mesh.indices();
+		REQUIRE( 0 == indices.size() % 3 );
+
+		for( std::size_t i = 0; i < indices.size(); i += 3 )
+			coverage.add( verts[indices[i]], verts[indices[i+1]], verts[indices[i+2]] );
+
+		int overlaps = 0;
+		for( std::uint32_t y = 0; y < height; ++y )
+		{
+			for( std::uint32_t x = 0; x < width; ++x )
+			{
+				if( coverage.count( x, y ) > 1 )
+					++overlaps;
+			}
+		}
+
+		// Pixels on the center line, including the joints, are covered.
+		// (The pixels of the two end points may lie beyond the butt caps.)
+		int holes = 0;
+		for( std::size_t i = 1; i < count; ++i )
+		{
+			for( int k = (1 == i); k <= 16 - (count-1 == i); ++k )
+			{
+				Vec2f const p = points[i-1] + (points[i] - points[i-1]) * (float(k) / 16.f);
+				if( 0 == coverage.count( std::uint32_t(p.x), std::uint32_t(p.y) ) )
+					++holes;
+			}
+		}
+
+		REQUIRE( 0 == overlaps );
+		REQUIRE( 0 == holes );
+
+		// Unchanged inputs reuse the outline; any change rebuilds it.
+		REQUIRE( !mesh.update( count, points, identity, { 0.f, 0.f }, style ) );
+		REQUIRE( mesh.update( count, points, identity, { 1.f, 0.f }, style ) );
+		style.width = 5.f;
+		REQUIRE( mesh.update( count, points, identity, { 1.f, 0.f }, style ) );
+	};
+
+	SECTION( "Miter joins" )
+	{
+		check( EJoin::miter );
+	}
+	SECTION( "Bevel joins" )
+	{
+		check( EJoin::bevel );
+	}
+}
@@ -0,0 +1,321 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+#include <algorithm>
+
+#include <cmath>
+
+#include "helpers.hpp"
+
+#include "../vmlib/vec2_batch.hpp"
+#include "../vmlib/mat22_batch.hpp"
+
+// The kernels process 8 (AVX2) and then 4 (SSE2) elements at a time, and the
+// rest in a scalar loop. A kernel that is called with a single element only
+// runs the scalar loop, so each test compares the batch result for element i
+// with that of a call for element i alone. The counts cover every remainder
+// modulo 8, plus a few longer runs. The data starts one float past the
+// beginning of each array, so that the loads are never 32-byte aligned.
+
+namespace
+{
+	std::size_t batch_count_()
+	{
+		return std::size_t(GENERATE( range( 0, 18 ), 31, 203 ));
+	}
+
+	Mat22fBatch random_mats_( std::size_t aCount, std::uint32_t aSeed )
+	{
+		Mat22fBatch ret;
+		ret._00 = random_floats( aCount, -2.f, 2.f, aSeed+0 );
+		ret._01 = random_floats( aCount, -2.f, 2.f, aSeed+1 );
+		ret._10 = random_floats( aCount, -2.f, 2.f, aSeed+2 );
+		ret._11 = random_floats( aCount, -2.f, 2.f, aSeed+3 );
+		return ret;
+	}
+}
+
+
+TEST_CASE( "Batch transform_points", "[batch]" )
+{
+	auto const count = batch_count_();
+	auto const seed = std::uint32_t(count) * 16;
+
+	auto const x = random_floats( count+1, -100.f, 100.f, seed+0 );
+	auto const y = random_floats( count+1, -100.f, 100.f, seed+1 );
+
+	Mat22f const mat{ 0.8f, -1.7f, 1.3f, 0.4f };
+	Vec2f const transl{ 12.5f, -31.f };
+	float const magnitude = 2.f * 100.f + 31.f;
+
+	SECTION( "SoA" )
+	{
+		std::vector<float> ox( count+1 ), oy( count+1 );
+		transform_points( count, x.data()+1, y.data()+1, mat, transl, ox.data()+1, oy.data()+1 );
+
+		for( std::size_t i = 1; i <= count; ++i )
+		{
+			float rx, ry;
+			transform_points( 1, x.data()+i, y.data()+i, mat, transl, &rx, &ry );
+
+			INFO( "i = " << i-1 << " of " << count );
+			REQUIRE( nearly_equal( ox[i], rx, magnitude ) );
+			REQUIRE( nearly_equal( oy[i], ry, magnitude ) );
+		}
+	}
+
+	SECTION( "AoS" )
+	{
+		std::vector<Vec2f> in( count+1 ), out( count+1 );
+		for( std::size_t i = 0; i <= count; ++i )
+			in[i] = Vec2f{ x[i], y[i] };
+
+		transform_points( count, in.data()+1, mat, transl, out.data()+1 );
+
+		for( std::size_t i = 1; i <= count; ++i )
+		{
+			Vec2f ref;
+			transform_points( 1, in.data()+i, mat, transl, &ref );
+
+			INFO( "i = " << i-1 << " of " << count );
+			REQUIRE( nearly_equal( out[i].x, ref.x, magnitude ) );
+			REQUIRE( nearly_equal( out[i].y, ref.y, magnitude ) );
+		}
+	}
+
+	SECTION( "in place" )
+	{
+		auto ix = x, iy = y;
+		transform_points( count, ix.data()+1, iy.data()+1, mat, transl, ix.data()+1, iy.data()+1 );
+
+		for( std::size_t i = 1; i <= count; ++i )
+		{
+			float rx, ry;
+			transform_points( 1, x.data()+i, y.data()+i, mat, transl, &rx, &ry );
+
+			REQUIRE( nearly_equal( ix[i], rx, magnitude ) );
+			REQUIRE( nearly_equal( iy[i], ry, magnitude ) );
+		}
+
+		// Element before the range is untouched.
+		REQUIRE( ix[0] == x[0] );
+		REQUIRE( iy[0] == y[0] );
+	}
+}
+
+TEST_CASE( "Batch translate_points and add_scaled", "[batch]" )
+{
+	auto const count = batch_count_();
+	auto const seed = std::uint32_t(count) * 16;
+
+	auto const x = random_floats( count+1, -100.f, 100.f, seed+0 );
+	auto const y = random_floats( count+1, -100.f, 100.f, seed+1 );
+	auto const dx = random_floats( count+1, -10.f, 10.f, seed+2 );
+	auto const dy = random_floats( count+1, -10.f, 10.f, seed+3 );
+
+	Vec2f const offset{ -3.25f, 7.5f };
+
+	SECTION( "translate_points" )
+	{
+		auto ox = x, oy = y;
+		translate_points( count, ox.data()+1, oy.data()+1, offset );
+
+		// A single addition rounds the same way in every path.
+		for( std::size_t i = 1; i <= count; ++i )
+		{
+			float rx = x[i], ry = y[i];
+			translate_points( 1, &rx, &ry, offset );
+
+			REQUIRE( ox[i] == rx );
+			REQUIRE( oy[i] == ry );
+		}
+	}
+
+	SECTION( "add_scaled" )
+	{
+		float const scale = 1.f / 60.f;
+
+		auto ox = x, oy = y;
+		add_scaled( count, ox.data()+1, oy.data()+1, dx.data()+1, dy.data()+1, scale, offset );
+
+		for( std::size_t i = 1; i <= count; ++i )
+		{
+			float rx = x[i], ry = y[i];
+			add_scaled( 1, &rx, &ry, dx.data()+i, dy.data()+i, scale, offset );
+
+			INFO( "i = " << i-1 << " of " << count );
+			REQUIRE( nearly_equal( ox[i], rx, 110.f ) );
+			REQUIRE( nearly_equal( oy[i], ry, 110.f ) );
+		}
+	}
+}
+
+TEST_CASE( "Batch bounding_box", "[batch]" )
+{
+	auto const count = batch_count_();
+	auto const seed = std::uint32_t(count) * 16;
+
+	auto const x = random_floats( count+1, -100.f, 100.f, seed+0 );
+	auto const y = random_floats( count+1, -100.f, 100.f, seed+1 );
+
+	// Minimum and maximum are exact, so the results must match exactly.
+	Box2f ref{ { x[1], y[1] }, { x[1], y[1] } };
+	for( std::size_t i = 1; i <= count; ++i )
+	{
+		auto const one = bounding_box( 1, x.data()+i, y.data()+i );
+		ref.min.x = std::min( ref.min.x, one.min.x );
+		ref.min.y = std::min( ref.min.y, one.min.y );
+		ref.max.x = std::max( ref.max.x, one.max.x );
+		ref.max.y = std::max( ref.max.y, one.max.y );
+	}
+
+	SECTION( "SoA" )
+	{
+		auto const box = bounding_box( count, x.data()+1, y.data()+1 );
+		if( 0 == count )
+		{
+			REQUIRE( box.min.x > box.max.x );
+			REQUIRE( box.min.y > box.max.y );
+		}
+		else
+		{
+			REQUIRE( box.min.x == ref.min.x );
+			REQUIRE( box.min.y == ref.min.y );
+			REQUIRE( box.max.x == ref.max.x );
+			REQUIRE( box.max.y == ref.max.y );
+		}
+	}
+
+	SECTION( "AoS" )
+	{
+		std::vector<Vec2f> pts( count+1 );
+		for( std::size_t i = 0; i <= count; ++i )
+			pts[i] = Vec2f{ x[i], y[i] };
+
+		auto const box = bounding_box( count, pts.data()+1 );
+		if( 0 == count )
+		{
+			REQUIRE( box.min.x > box.max.x );
+			REQUIRE( box.min.y > box.max.y );
+		}
+		else
+		{
+			REQUIRE( box.min.x == ref.min.x );
+			REQUIRE( box.min.y == ref.min.y );
+			REQUIRE( box.max.x == ref.max.x );
+			REQUIRE( box.max.y == ref.max.y );
+		}
+	}
+}
+
+TEST_CASE( "Batch circles_in_box", "[batch]" )
+{
+	auto const count = batch_count_();
+	auto const seed = std::uint32_t(count) * 16;
+
+	auto const x = random_floats( count+1, -80.f, 180.f, seed+0 );
+	auto const y = random_floats( count+1, -80.f, 180.f, seed+1 );
+	auto const r = random_floats( count+1, 0.f, 40.f, seed+2 );
+
+	Box2f const box{ { 0.f, 0.f }, { 100.f, 60.f } };
+
+	std::vector<std::uint32_t> expected;
+	for( std::size_t i = 1; i <= count; ++i )
+	{
+		std::uint32_t dummy;
+		if( 1 == circles_in_box( 1, x.data()+i, y.data()+i, r.data()+i, box, &dummy ) )
+			expected.push_back( std::uint32_t(i-1) );
+	}
+
+	std::vector<std::uint32_t> found( count );
+	found.resize( circles_in_box( count, x.data()+1, y.data()+1, r.data()+1, box, found.data() ) );
+
+	REQUIRE( found == expected );
+}
+
+TEST_CASE( "Batch per-element matrix kernels", "[batch]" )
+{
+	auto const count = batch_count_();
+	auto const seed = std::uint32_t(count) * 16;
+
+	auto const mats = random_mats_( count, seed );
+
+	SECTION( "transform_each" )
+	{
+		Vec2fBatch in, transl, out;
+		in.x = random_floats( count, -100.f, 100.f, seed+4 );
+		in.y = random_floats( count, -100.f, 100.f, seed+5 );
+		transl.x = random_floats( count, -50.f, 50.f, seed+6 );
+		transl.y = random_floats( count, -50.f, 50.f, seed+7 );
+
+		transform_each( in, mats, transl, out );
+		REQUIRE( out.size() == count );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			Vec2fBatch oneIn, oneTransl, oneOut;
+			oneIn.push_back( in.get( i ) );
+			oneTransl.push_back( transl.get( i ) );
+
+			Mat22fBatch oneMat;
+			oneMat.push_back( mats.get( i ) );
+
+			transform_each( oneIn, oneMat, oneTransl, oneOut );
+
+			INFO( "i = " << i << " of " << count );
+			REQUIRE( nearly_equal( out.x[i], oneOut.x[0], 450.f ) );
+			REQUIRE( nearly_equal( out.y[i], oneOut.y[0], 450.f ) );
+		}
+	}
+
+	SECTION( "premultiply_each" )
+	{
+		auto const left = random_mats_( count, seed+8 );
+
+		auto prod = mats;
+		premultiply_each( prod, left );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			Mat22fBatch one, oneLeft;
+			one.push_back( mats.get( i ) );
+			oneLeft.push_back( left.get( i ) );
+
+			premultiply_each( one, oneLeft );
+
+			auto const a = prod.get( i ), b = one.get( 0 );
+
+			INFO( "i = " << i << " of " << count );
+			REQUIRE( nearly_equal( a._00, b._00, 8.f ) );
+			REQUIRE( nearly_equal( a._01, b._01, 8.f ) );
+			REQUIRE( nearly_equal( a._10, b._10, 8.f ) );
+			REQUIRE( nearly_equal( a._11, b._11, 8.f ) );
+		}
+	}
+
+	SECTION( "renormalize_rotations" )
+	{
+		auto norm = mats;
+		renormalize_rotations( norm );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			Mat22fBatch one;
+			one.push_back( mats.get( i ) );
+			renormalize_rotations( one );
+
+			auto const a = norm.get( i ), b = one.get( 0 );
+
+			INFO( "i = " << i << " of " << count );
+			REQUIRE( nearly_equal( a._00, b._00, 1.f ) );
+			REQUIRE( nearly_equal( a._01, b._01, 1.f ) );
+			REQUIRE( nearly_equal( a._10, b._10, 1.f ) );
+			REQUIRE( nearly_equal( a._11, b._11, 1.f ) );
+
+			// ... and the result is a rotation.
+			REQUIRE( std::abs( a._00*a._00 + a._10*a._10 - 1.f ) < 1e-6f );
+			REQUIRE( a._00 == a._11 );
+			REQUIRE( a._01 == -a._10 );
+		}
+	}
+}
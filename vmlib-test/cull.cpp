@@ -0,0 +1,53 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <limits>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/vec2_batch.hpp"
+
+
+TEST_CASE( "Circles against a box", "[cull]" )
+{
+	// circles_in_box() (used to cull the asteroids) should agree with a
+	// direct test. 203 circles exercise the SIMD loops and the scalar tail.
+	Box2f const box{ { 0.f, 0.f }, { 100.f, 60.f } };
+
+	std::minstd_rand rng( 42 );
+	std::uniform_real_distribution<float> pos( -80.f, 180.f ), rad( 0.f, 40.f );
+
+	std::size_t const count = 203;
+	std::vector<float> x( count ), y( count ), r( count );
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		x[i] = pos( rng );
+		y[i] = pos( rng );
+		r[i] = rad( rng );
+	}
+
+	// Touching the corner and an edge exactly.
+	x[5] = 103.f; y[5] = 64.f; r[5] = 5.f;
+	x[6] = -10.f; y[6] = 30.f; r[6] = 10.f;
+	// Near a corner, but outside of the circle.
+	x[7] = -10.f; y[7] = -10.f; r[7] = 14.f;
+	x[8] = std::numeric_limits<float>::quiet_NaN(); r[8] = 1000.f;
+
+	std::vector<std::uint32_t> expected;
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		float const dx = std::max( { box.min.x - x[i], x[i] - box.max.x, 0.f } );
+		float const dy = std::max( { box.min.y - y[i], y[i] - box.max.y, 0.f } );
+		if( dx*dx + dy*dy <= r[i]*r[i] )
+			expected.push_back( std::uint32_t(i) );
+	}
+
+	std::vector<std::uint32_t> found( count );
+	found.resize( circles_in_box( count, x.data(), y.data(), r.data(), box, found.data() ) );
+
+	REQUIRE( found == expected );
+	REQUIRE( std::find( found.begin(), found.end(), 5u ) != found.end() );
+	REQUIRE( std::find( found.begin(), found.end(), 6u ) != found.end() );
+	REQUIRE( std::find( found.begin(), found.end(), 7u ) == found.end() );
+	REQUIRE( std::find( found.begin(), found.end(), 8u ) == found.end() );
+}
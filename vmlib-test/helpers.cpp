@@ -0,0 +1,25 @@
+#include "helpers.hpp"
+
+#include <limits>
+#include <random>
+#include <algorithm>
+
+#include <cmath>
+
+std::vector<float> random_floats( std::size_t aCount, float aMin, float aMax, std::uint32_t aSeed )
+{
+	std::minstd_rand rng( aSeed );
+	std::uniform_real_distribution<float> dist( aMin, aMax );
+
+	std::vector<float> ret( aCount );
+	for( auto& v : ret )
+		v = dist( rng );
+
+	return ret;
+}
+
+bool nearly_equal( float aValue, float aExpected, float aMagnitude )
+{
+	float const tolerance = 4.f * std::numeric_limits<float>::epsilon() * std::max( aMagnitude, 1.f );
+	return std::abs( aValue - aExpected ) <= tolerance;
+}
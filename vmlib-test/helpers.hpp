@@ -0,0 +1,19 @@
+#ifndef HELPERS_HPP_3CF7BD23_0DFD_42DB_8ACC_40C3C933D1F5
+#define HELPERS_HPP_3CF7BD23_0DFD_42DB_8ACC_40C3C933D1F5
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+std::vector<float> random_floats( std::size_t aCount, float aMin, float aMax, std::uint32_t aSeed );
+
+/* Is aValue within a few float ulps of aExpected?
+ *
+ * The SIMD paths contract a*b+c into an FMA when the target has one, so the
+ * SIMD and scalar results may differ in the last bits. aMagnitude is the size
+ * of the largest intermediate term, which determines the rounding error.
+ */
+bool nearly_equal( float aValue, float aExpected, float aMagnitude );
+
+#endif // HELPERS_HPP_3CF7BD23_0DFD_42DB_8ACC_40C3C933D1F5
@@ -0,0 +1,140 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+#include <algorithm>
+
+#include <cmath>
+
+#include "helpers.hpp"
+
+#include "../vmlib/mat22.hpp"
+#include "../vmlib/sincos.hpp"
+#include "../vmlib/mat22_batch.hpp"
+
+// Error bounds as documented in sincos.hpp, measured against double precision
+// std::sin()/std::cos() of the (float) angle.
+
+namespace
+{
+	struct MaxError_
+	{
+		double sin = 0.0, cos = 0.0;
+		float sinAt = 0.f, cosAt = 0.f;
+	};
+
+	// aCount evenly spaced angles from aMin to aMax (inclusive), through the
+	// batch version (aScale = 1).
+	MaxError_ sweep_batch_( float aMin, float aMax, std::size_t aCount )
+	{
+		std::vector<float> angles( aCount ), s( aCount ), c( aCount );
+		for( std::size_t i = 0; i < aCount; ++i )
+			angles[i] = float(aMin + (double(aMax) - aMin) * double(i) / double(aCount-1));
+
+		fast_sincos( aCount, angles.data(), 1.f, s.data(), c.data() );
+
+		MaxError_ ret;
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			auto const es = std::abs( double(s[i]) - std::sin( double(angles[i]) ) );
+			auto const ec = std::abs( double(c[i]) - std::cos( double(angles[i]) ) );
+
+			if( es > ret.sin ) { ret.sin = es; ret.sinAt = angles[i]; }
+			if( ec > ret.cos ) { ret.cos = ec; ret.cosAt = angles[i]; }
+		}
+
+		return ret;
+	}
+}
+
+
+TEST_CASE( "fast_sincos error bound", "[sincos]" )
+{
+	SECTION( "dense, a few turns" )
+	{
+		auto const err = sweep_batch_( -40.f, 40.f, 1 << 20 );
+
+		INFO( "sin " << err.sin << " at " << err.sinAt << ", cos " << err.cos << " at " << err.cosAt );
+		REQUIRE( err.sin < 1e-7 );
+		REQUIRE( err.cos < 1e-7 );
+	}
+
+	SECTION( "full documented range" )
+	{
+		auto const err = sweep_batch_( -131072.f, 131072.f, 1 << 22 );
+
+		INFO( "sin " << err.sin << " at " << err.sinAt << ", cos " << err.cos << " at " << err.cosAt );
+		REQUIRE( err.sin < 1e-7 );
+		REQUIRE( err.cos < 1e-7 );
+	}
+
+	SECTION( "large angles" )
+	{
+		// Past 131072 the error grows slowly; 1.2e-7 at 1e6.
+		auto const err = sweep_batch_( -1e6f, 1e6f, 1 << 20 );
+
+		INFO( "sin " << err.sin << " at " << err.sinAt << ", cos " << err.cos << " at " << err.cosAt );
+		REQUIRE( err.sin < 1.25e-7 );
+		REQUIRE( err.cos < 1.25e-7 );
+	}
+}
+
+TEST_CASE( "fast_sincos scalar and batch agree", "[sincos]" )
+{
+	// Includes negative and large angles, and the points between quadrants.
+	auto angles = random_floats( 4099, -1e5f, 1e5f, 3811 );
+	for( int k = -8; k <= 8; ++k )
+	{
+		float const q = float(k) * 1.57079632679f;
+		angles.insert( angles.end(), { q, std::nextafter( q, -1e9f ), std::nextafter( q, 1e9f ) } );
+	}
+
+	float const scale = GENERATE( 1.f, 1.f/60.f, -3.5f );
+
+	std::vector<float> s( angles.size() ), c( angles.size() );
+	fast_sincos( angles.size(), angles.data(), scale, s.data(), c.data() );
+
+	for( std::size_t i = 0; i < angles.size(); ++i )
+	{
+		float rs, rc;
+		fast_sincos( scale * angles[i], rs, rc );
+
+		INFO( "angle " << angles[i] << " * " << scale );
+		REQUIRE( nearly_equal( s[i], rs, 1.f ) );
+		REQUIRE( nearly_equal( c[i], rc, 1.f ) );
+	}
+}
+
+TEST_CASE( "Batch make_rotation_2d", "[sincos][batch]" )
+{
+	auto const angles = random_floats( 1 << 16, -1000.f, 1000.f, 42 );
+	float const scale = GENERATE( 1.f, -0.25f );
+
+	Mat22fBatch rots;
+	make_rotation_2d( angles.size(), angles.data(), rots, scale );
+	REQUIRE( rots.size() == angles.size() );
+
+	// Same error bound as fast_sincos(); make_rotation_2d() uses std::sin()
+	// and std::cos(), which are each within half an ulp.
+	double maxErr = 0.0;
+	for( std::size_t i = 0; i < angles.size(); ++i )
+	{
+		float const angle = scale * angles[i];
+
+		auto const m = rots.get( i );
+		auto const ref = make_rotation_2d( angle );
+
+		REQUIRE( m._01 == -m._10 );
+		REQUIRE( m._11 == m._00 );
+
+		maxErr = std::max( { maxErr,
+			std::abs( double(m._00) - std::cos( double(angle) ) ),
+			std::abs( double(m._10) - std::sin( double(angle) ) )
+		} );
+
+		REQUIRE( std::abs( m._00 - ref._00 ) < 1.6e-7f );
+		REQUIRE( std::abs( m._10 - ref._10 ) < 1.6e-7f );
+	}
+
+	INFO( "max error " << maxErr );
+	REQUIRE( maxErr < 1e-7 );
+}
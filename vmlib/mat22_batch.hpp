@@ -0,0 +1,88 @@
+#ifndef MAT22_BATCH_HPP_2DB4898C_537D_41CA_87F2_5E442AB614B0
+#define MAT22_BATCH_HPP_2DB4898C_537D_41CA_87F2_5E442AB614B0
+
+#include <vector>
+
+#include <cstddef>
+
+#include "mat22.hpp"
+#include "sincos.hpp"
+#include "vec2_batch.hpp"
+
+/** Mat22fBatch : many 2x2 matrices, stored as structure-of-arrays (SoA)
+ *
+ * See Vec2fBatch. Each of the four matrix elements is stored in its own array.
+ * Typically used for per-element rotations, e.g. one rotation per asteroid.
+ */
+struct Mat22fBatch
+{
+	std::vector<float> _00, _01;
+	std::vector<float> _10, _11;
+
+	std::size_t size() const noexcept { return _00.size(); }
+	bool empty() const noexcept { return _00.empty(); }
+
+	void resize( std::size_t aCount )
+	{
+		_00.resize( aCount ); _01.resize( aCount );
+		_10.resize( aCount ); _11.resize( aCount );
+	}
+	void reserve( std::size_t aCount )
+	{
+		_00.reserve( aCount ); _01.reserve( aCount );
+		_10.reserve( aCount ); _11.reserve( aCount );
+	}
+	void clear() noexcept
+	{
+		_00.clear(); _01.clear();
+		_10.clear(); _11.clear();
+	}
+
+	void push_back( Mat22f const& aMat )
+	{
+		_00.push_back( aMat._00 ); _01.push_back( aMat._01 );
+		_10.push_back( aMat._10 ); _11.push_back( aMat._11 );
+	}
+
+	Mat22f get( std::size_t aIndex ) const noexcept
+	{
+		return { _00[aIndex], _01[aIndex], _10[aIndex], _11[aIndex] };
+	}
+	void set( std::size_t aIndex, Mat22f const& aMat ) noexcept
+	{
+		_00[aIndex] = aMat._00; _01[aIndex] = aMat._01;
+		_10[aIndex] = aMat._10; _11[aIndex] = aMat._11;
+	}
+};
+
+
+// Kernels. See vec2_batch.hpp for general remarks.
+
+/* Per-element transform: out[i] = aMats[i] * in[i] + aTransl[i] */
+void transform_each( Vec2fBatch const& aIn, Mat22fBatch const& aMats, Vec2fBatch const& aTransl, Vec2fBatch& aOut );
+
+/* Per-element matrix product: inout[i] = aLeft[i] * inout[i]
+ *
+ * With rotations, this applies the rotation aLeft[i] after inout[i].
+ */
+void premultiply_each( Mat22fBatch& aInOut, Mat22fBatch const& aLeft ) noexcept;
+
+/* Batch rotations: aOut[i] = make_rotation_2d( aAngleScale * aAngles[i] )
+ *
+ * Resizes aOut to aCount. Uses fast_sincos() (see sincos.hpp) rather than
+ * std::sin()/std::cos(), so results may differ from the scalar
+ * make_rotation_2d() by about 1e-7.
+ */
+void make_rotation_2d( std::size_t aCount, float const* aAngles, Mat22fBatch& aOut, float aAngleScale = 1.f );
+
+/* Re-orthonormalize rotation matrices
+ *
+ * Rotations that are accumulated by repeated multiplication (premultiply_each)
+ * slowly drift away from being orthonormal due to rounding. This rebuilds each
+ * matrix from its normalized first column. Calling it every few dozen frames
+ * is plenty.
+ */
+void renormalize_rotations( Mat22fBatch& aInOut ) noexcept;
+
+#include "mat22_batch.inl"
+#endif // MAT22_BATCH_HPP_2DB4898C_537D_41CA_87F2_5E442AB614B0
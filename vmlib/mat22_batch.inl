@@ -0,0 +1,220 @@
+#include <cassert>
+#include <cmath>
+
+inline
+void transform_each( Vec2fBatch const& aIn, Mat22fBatch const& aMats, Vec2fBatch const& aTransl, Vec2fBatch& aOut )
+{
+	assert( aIn.size() == aMats.size() && aIn.size() == aTransl.size() );
+
+	auto const count = aIn.size();
+	aOut.resize( count );
+
+	float const* ix = aIn.x.data();
+	float const* iy = aIn.y.data();
+	float const* tx = aTransl.x.data();
+	float const* ty = aTransl.y.data();
+	float const* m00 = aMats._00.data();
+	float const* m01 = aMats._01.data();
+	float const* m10 = aMats._10.data();
+	float const* m11 = aMats._11.data();
+	float* ox = aOut.x.data();
+	float* oy = aOut.y.data();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		using namespace vmlib_detail;
+
+		for( ; i + 8 <= count; i += 8 )
+		{
+			__m256 const x = _mm256_loadu_ps( ix+i );
+			__m256 const y = _mm256_loadu_ps( iy+i );
+
+			__m256 const rx = madd8_( _mm256_loadu_ps( m00+i ), x, madd8_( _mm256_loadu_ps( m01+i ), y, _mm256_loadu_ps( tx+i ) ) );
+			__m256 const ry = madd8_( _mm256_loadu_ps( m10+i ), x, madd8_( _mm256_loadu_ps( m11+i ), y, _mm256_loadu_ps( ty+i ) ) );
+
+			_mm256_storeu_ps( ox+i, rx );
+			_mm256_storeu_ps( oy+i, ry );
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		using namespace vmlib_detail;
+
+		for( ; i + 4 <= count; i += 4 )
+		{
+			__m128 const x = _mm_loadu_ps( ix+i );
+			__m128 const y = _mm_loadu_ps( iy+i );
+
+			__m128 const rx = madd4_( _mm_loadu_ps( m00+i ), x, madd4_( _mm_loadu_ps( m01+i ), y, _mm_loadu_ps( tx+i ) ) );
+			__m128 const ry = madd4_( _mm_loadu_ps( m10+i ), x, madd4_( _mm_loadu_ps( m11+i ), y, _mm_loadu_ps( ty+i ) ) );
+
+			_mm_storeu_ps( ox+i, rx );
+			_mm_storeu_ps( oy+i, ry );
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < count; ++i )
+	{
+		float const x = ix[i], y = iy[i];
+		ox[i] = m00[i] * x + m01[i] * y + tx[i];
+		oy[i] = m10[i] * x + m11[i] * y + ty[i];
+	}
+}
+
+inline
+void premultiply_each( Mat22fBatch& aInOut, Mat22fBatch const& aLeft ) noexcept
+{
+	assert( aInOut.size() == aLeft.size() );
+
+	auto const count = aInOut.size();
+
+	float const* l00 = aLeft._00.data();
+	float const* l01 = aLeft._01.data();
+	float const* l10 = aLeft._10.data();
+	float const* l11 = aLeft._11.data();
+	float* r00 = aInOut._00.data();
+	float* r01 = aInOut._01.data();
+	float* r10 = aInOut._10.data();
+	float* r11 = aInOut._11.data();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		using namespace vmlib_detail;
+
+		for( ; i + 8 <= count; i += 8 )
+		{
+			__m256 const a00 = _mm256_loadu_ps( l00+i ), a01 = _mm256_loadu_ps( l01+i );
+			__m256 const a10 = _mm256_loadu_ps( l10+i ), a11 = _mm256_loadu_ps( l11+i );
+			__m256 const b00 = _mm256_loadu_ps( r00+i ), b01 = _mm256_loadu_ps( r01+i );
+			__m256 const b10 = _mm256_loadu_ps( r10+i ), b11 = _mm256_loadu_ps( r11+i );
+
+			_mm256_storeu_ps( r00+i, madd8_( a00, b00, _mm256_mul_ps( a01, b10 ) ) );
+			_mm256_storeu_ps( r01+i, madd8_( a00, b01, _mm256_mul_ps( a01, b11 ) ) );
+			_mm256_storeu_ps( r10+i, madd8_( a10, b00, _mm256_mul_ps( a11, b10 ) ) );
+			_mm256_storeu_ps( r11+i, madd8_( a10, b01, _mm256_mul_ps( a11, b11 ) ) );
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		using namespace vmlib_detail;
+
+		for( ; i + 4 <= count; i += 4 )
+		{
+			__m128 const a00 = _mm_loadu_ps( l00+i ), a01 = _mm_loadu_ps( l01+i );
+			__m128 const a10 = _mm_loadu_ps( l10+i ), a11 = _mm_loadu_ps( l11+i );
+			__m128 const b00 = _mm_loadu_ps( r00+i ), b01 = _mm_loadu_ps( r01+i );
+			__m128 const b10 = _mm_loadu_ps( r10+i ), b11 = _mm_loadu_ps( r11+i );
+
+			_mm_storeu_ps( r00+i, madd4_( a00, b00, _mm_mul_ps( a01, b10 ) ) );
+			_mm_storeu_ps( r01+i, madd4_( a00, b01, _mm_mul_ps( a01, b11 ) ) );
+			_mm_storeu_ps( r10+i, madd4_( a10, b00, _mm_mul_ps( a11, b10 ) ) );
+			_mm_storeu_ps( r11+i, madd4_( a10, b01, _mm_mul_ps( a11, b11 ) ) );
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < count; ++i )
+	{
+		float const b00 = r00[i], b01 = r01[i], b10 = r10[i], b11 = r11[i];
+		r00[i] = l00[i] * b00 + l01[i] * b10;
+		r01[i] = l00[i] * b01 + l01[i] * b11;
+		r10[i] = l10[i] * b00 + l11[i] * b10;
+		r11[i] = l10[i] * b01 + l11[i] * b11;
+	}
+}
+
+inline
+void make_rotation_2d( std::size_t aCount, float const* aAngles, Mat22fBatch& aOut, float aAngleScale )
+{
+	aOut.resize( aCount );
+
+	float* m00 = aOut._00.data();
+	float* m01 = aOut._01.data();
+	float* m10 = aOut._10.data();
+	float* m11 = aOut._11.data();
+
+	fast_sincos( aCount, aAngles, aAngleScale, m10, m00 );
+
+	// Matches make_rotation_2d(): [ c -s ; s c ]
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		m01[i] = -m10[i];
+		m11[i] = m00[i];
+	}
+}
+
+inline
+void renormalize_rotations( Mat22fBatch& aInOut ) noexcept
+{
+	auto const count = aInOut.size();
+
+	float* m00 = aInOut._00.data();
+	float* m01 = aInOut._01.data();
+	float* m10 = aInOut._10.data();
+	float* m11 = aInOut._11.data();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		using namespace vmlib_detail;
+
+		__m256 const sign = _mm256_set1_ps( -0.f );
+		for( ; i + 8 <= count; i += 8 )
+		{
+			__m256 const c = _mm256_loadu_ps( m00+i );
+			__m256 const s = _mm256_loadu_ps( m10+i );
+
+			__m256 const len = _mm256_sqrt_ps( madd8_( c, c, _mm256_mul_ps( s, s ) ) );
+			__m256 const nc = _mm256_div_ps( c, len );
+			__m256 const ns = _mm256_div_ps( s, len );
+
+			_mm256_storeu_ps( m00+i, nc );
+			_mm256_storeu_ps( m01+i, _mm256_xor_ps( ns, sign ) );
+			_mm256_storeu_ps( m10+i, ns );
+			_mm256_storeu_ps( m11+i, nc );
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		using namespace vmlib_detail;
+
+		__m128 const sign = _mm_set1_ps( -0.f );
+		for( ; i + 4 <= count; i += 4 )
+		{
+			__m128 const c = _mm_loadu_ps( m00+i );
+			__m128 const s = _mm_loadu_ps( m10+i );
+
+			__m128 const len = _mm_sqrt_ps( madd4_( c, c, _mm_mul_ps( s, s ) ) );
+			__m128 const nc = _mm_div_ps( c, len );
+			__m128 const ns = _mm_div_ps( s, len );
+
+			_mm_storeu_ps( m00+i, nc );
+			_mm_storeu_ps( m01+i, _mm_xor_ps( ns, sign ) );
+			_mm_storeu_ps( m10+i, ns );
+			_mm_storeu_ps( m11+i, nc );
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < count; ++i )
+	{
+		float const c = m00[i], s = m10[i];
+		float const len = std::sqrt( c*c + s*s );
+		m00[i] = c / len;
+		m01[i] = -s / len;
+		m10[i] = s / len;
+		m11[i] = c / len;
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef SIMD_HPP_7BF0BD40_A7A0_40F9_B5F6_DC55CACCE0F3
+#define SIMD_HPP_7BF0BD40_A7A0_40F9_B5F6_DC55CACCE0F3
+
+/* SIMD instruction set selection for the vmlib batch kernels
+ *
+ * The batch kernels (vec2_batch.hpp, mat22_batch.hpp, sincos.hpp) have an
+ * AVX2, an SSE2 and a plain scalar implementation behind a single API. The
+ * implementation is picked at compile time, based on what the compiler is
+ * allowed to target. With
+ * the default premake configuration (-march=native with GCC/clang) this is the
+ * best that the build machine supports.
+ *
+ * Define VMLIB_SIMD_LEVEL before including any vmlib header to override this.
+ * For example, -DVMLIB_SIMD_LEVEL=0 forces the scalar fallback. This must be
+ * consistent across the whole program.
+ */
+
+#define VMLIB_SIMD_SCALAR 0
+#define VMLIB_SIMD_SSE2 1
+#define VMLIB_SIMD_AVX2 2
+
+#if !defined(VMLIB_SIMD_LEVEL)
+#	if defined(__AVX2__)
+#		define VMLIB_SIMD_LEVEL VMLIB_SIMD_AVX2
+#	elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define VMLIB_SIMD_LEVEL VMLIB_SIMD_SSE2
+#	else
+#		define VMLIB_SIMD_LEVEL VMLIB_SIMD_SCALAR
+#	endif
+#endif // ~ VMLIB_SIMD_LEVEL
+
+#if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+#	include <immintrin.h>
+#endif
+
+namespace vmlib_detail
+{
+	// a*b + c, fused if the target has FMA.
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	inline
+	__m256 madd8_( __m256 aA, __m256 aB, __m256 aC ) noexcept
+	{
+#		if defined(__FMA__)
+		return _mm256_fmadd_ps( aA, aB, aC );
+#		else
+		return _mm256_add_ps( _mm256_mul_ps( aA, aB ), aC );
+#		endif
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	inline
+	__m128 madd4_( __m128 aA, __m128 aB, __m128 aC ) noexcept
+	{
+#		if defined(__FMA__)
+		return _mm_fmadd_ps( aA, aB, aC );
+#		else
+		return _mm_add_ps( _mm_mul_ps( aA, aB ), aC );
+#		endif
+	}
+#	endif // ~ SSE2
+}
+
+#endif // SIMD_HPP_7BF0BD40_A7A0_40F9_B5F6_DC55CACCE0F3
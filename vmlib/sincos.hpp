@@ -0,0 +1,45 @@
+#ifndef SINCOS_HPP_24B976C4_BFE1_48B1_849E_6B00E78DDA99
+#define SINCOS_HPP_24B976C4_BFE1_48B1_849E_6B00E78DDA99
+
+#include <cstddef>
+
+#include "simd.hpp"
+
+/* Fast sine and cosine
+ *
+ * Computes sin(x) and cos(x) together, for use with rotations. Compared to
+ * std::sin() and std::cos(), this
+ *  - computes both values with a single range reduction,
+ *  - has no branches (and no special handling of NaN/infinity), and
+ *  - has a batch version with AVX2/SSE2 implementations (see simd.hpp).
+ *
+ * Method: the angle is reduced to r in [-pi/4, pi/4] with x = r + k*pi/2,
+ * where k is the nearest integer to x*2/pi. The multiple of pi/2 is subtracted
+ * in three steps (Cody-Waite), with pi/2 split into parts that multiply k
+ * exactly. sin(r) and cos(r) are then evaluated with minimax polynomials of
+ * degree 7 and 8 (the single precision coefficients from Cephes). The
+ * quadrant k mod 4 selects which of the two is the sine/cosine and their
+ * signs.
+ *
+ * Error bound: for |x| <= 131072, the absolute error of both sin(x) and
+ * cos(x) is below 1e-7 (less than 1 ulp of 1.0), as measured against double
+ * precision std::sin()/std::cos() over 4M evenly spaced samples. Past that,
+ * k * kPiOver2A is no longer exact and the error grows slowly (1.2e-7 at
+ * |x| = 1e6).
+ *
+ * The batch version and the scalar version return identical results, with
+ * the possible exception of the last bit when the compiler contracts
+ * operations into FMAs differently.
+ */
+void fast_sincos( float aAngle, float& aSin, float& aCos ) noexcept;
+
+/* Batch version: aSin[i], aCos[i] = sincos( aScale * aAngles[i] )
+ *
+ * aScale is applied before the range reduction. This is mainly for computing
+ * the rotation of something for a time step, where aAngles holds angular
+ * velocities and aScale is the step size.
+ */
+void fast_sincos( std::size_t aCount, float const* aAngles, float aScale, float* aSin, float* aCos ) noexcept;
+
+#include "sincos.inl"
+#endif // SINCOS_HPP_24B976C4_BFE1_48B1_849E_6B00E78DDA99
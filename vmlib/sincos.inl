@@ -0,0 +1,158 @@
+#include <cmath>
+#include <cstdint>
+
+namespace vmlib_detail
+{
+	constexpr float kTwoOverPi = 0.636619772367581343f;
+
+	// pi/2 = kPiOver2A + kPiOver2B + kPiOver2C. The first two parts have few
+	// significant bits, so that k * kPiOver2A and k * kPiOver2B are exact for
+	// the range of k that we care about.
+	constexpr float kPiOver2A = 1.5703125f;
+	constexpr float kPiOver2B = 4.837512969970703125e-4f;
+	constexpr float kPiOver2C = 7.54978995489188216e-8f;
+
+	// sin(r) ~= r + r^3 * (kSin0 + r^2 * (kSin1 + r^2 * kSin2)), |r| <= pi/4
+	constexpr float kSin0 = -1.6666654611e-1f;
+	constexpr float kSin1 = 8.3321608736e-3f;
+	constexpr float kSin2 = -1.9515295891e-4f;
+
+	// cos(r) ~= 1 - r^2/2 + r^4 * (kCos0 + r^2 * (kCos1 + r^2 * kCos2))
+	constexpr float kCos0 = 4.166664568298827e-2f;
+	constexpr float kCos1 = -1.388731625493765e-3f;
+	constexpr float kCos2 = 2.443315711809948e-5f;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	inline
+	void sincos8_( __m256 aX, __m256& aSin, __m256& aCos ) noexcept
+	{
+		__m256i const k = _mm256_cvtps_epi32( _mm256_mul_ps( aX, _mm256_set1_ps( kTwoOverPi ) ) );
+		__m256 const kf = _mm256_cvtepi32_ps( k );
+
+		__m256 r = madd8_( kf, _mm256_set1_ps( -kPiOver2A ), aX );
+		r = madd8_( kf, _mm256_set1_ps( -kPiOver2B ), r );
+		r = madd8_( kf, _mm256_set1_ps( -kPiOver2C ), r );
+
+		__m256 const z = _mm256_mul_ps( r, r );
+
+		__m256 sp = madd8_( _mm256_set1_ps( kSin2 ), z, _mm256_set1_ps( kSin1 ) );
+		sp = madd8_( sp, z, _mm256_set1_ps( kSin0 ) );
+		sp = madd8_( _mm256_mul_ps( sp, z ), r, r );
+
+		__m256 cp = madd8_( _mm256_set1_ps( kCos2 ), z, _mm256_set1_ps( kCos1 ) );
+		cp = madd8_( cp, z, _mm256_set1_ps( kCos0 ) );
+		cp = madd8_( _mm256_mul_ps( cp, z ), z, madd8_( _mm256_set1_ps( -0.5f ), z, _mm256_set1_ps( 1.f ) ) );
+
+		// Odd quadrants swap sine and cosine
+		__m256i const one = _mm256_set1_epi32( 1 );
+		__m256 const swap = _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_and_si256( k, one ), one ) );
+
+		__m256 const s = _mm256_blendv_ps( sp, cp, swap );
+		__m256 const c = _mm256_blendv_ps( cp, sp, swap );
+
+		// Signs: sine is negative in quadrants 2,3; cosine in quadrants 1,2.
+		__m256i const two = _mm256_set1_epi32( 2 );
+		__m256i const ssign = _mm256_slli_epi32( _mm256_and_si256( k, two ), 30 );
+		__m256i const csign = _mm256_slli_epi32( _mm256_and_si256( _mm256_add_epi32( k, one ), two ), 30 );
+
+		aSin = _mm256_xor_ps( s, _mm256_castsi256_ps( ssign ) );
+		aCos = _mm256_xor_ps( c, _mm256_castsi256_ps( csign ) );
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	inline
+	void sincos4_( __m128 aX, __m128& aSin, __m128& aCos ) noexcept
+	{
+		__m128i const k = _mm_cvtps_epi32( _mm_mul_ps( aX, _mm_set1_ps( kTwoOverPi ) ) );
+		__m128 const kf = _mm_cvtepi32_ps( k );
+
+		__m128 r = madd4_( kf, _mm_set1_ps( -kPiOver2A ), aX );
+		r = madd4_( kf, _mm_set1_ps( -kPiOver2B ), r );
+		r = madd4_( kf, _mm_set1_ps( -kPiOver2C ), r );
+
+		__m128 const z = _mm_mul_ps( r, r );
+
+		__m128 sp = madd4_( _mm_set1_ps( kSin2 ), z, _mm_set1_ps( kSin1 ) );
+		sp = madd4_( sp, z, _mm_set1_ps( kSin0 ) );
+		sp = madd4_( _mm_mul_ps( sp, z ), r, r );
+
+		__m128 cp = madd4_( _mm_set1_ps( kCos2 ), z, _mm_set1_ps( kCos1 ) );
+		cp = madd4_( cp, z, _mm_set1_ps( kCos0 ) );
+		cp = madd4_( _mm_mul_ps( cp, z ), z, madd4_( _mm_set1_ps( -0.5f ), z, _mm_set1_ps( 1.f ) ) );
+
+		// SSE2 has no blendv; select with and/andnot/or instead.
+		__m128i const one = _mm_set1_epi32( 1 );
+		__m128 const swap = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( k, one ), one ) );
+
+		__m128 const s = _mm_or_ps( _mm_and_ps( swap, cp ), _mm_andnot_ps( swap, sp ) );
+		__m128 const c = _mm_or_ps( _mm_and_ps( swap, sp ), _mm_andnot_ps( swap, cp ) );
+
+		__m128i const two = _mm_set1_epi32( 2 );
+		__m128i const ssign = _mm_slli_epi32( _mm_and_si128( k, two ), 30 );
+		__m128i const csign = _mm_slli_epi32( _mm_and_si128( _mm_add_epi32( k, one ), two ), 30 );
+
+		aSin = _mm_xor_ps( s, _mm_castsi128_ps( ssign ) );
+		aCos = _mm_xor_ps( c, _mm_castsi128_ps( csign ) );
+	}
+#	endif // ~ SSE2
+}
+
+inline
+void fast_sincos( float aAngle, float& aSin, float& aCos ) noexcept
+{
+	using namespace vmlib_detail;
+
+	// std::lrint() rounds to nearest even, like cvtps2dq in the SIMD paths.
+	auto const k = std::int32_t(std::lrint( aAngle * kTwoOverPi ));
+	float const kf = float(k);
+
+	float r = aAngle - kf * kPiOver2A;
+	r = r - kf * kPiOver2B;
+	r = r - kf * kPiOver2C;
+
+	float const z = r * r;
+	float const sp = ((kSin2 * z + kSin1) * z + kSin0) * z * r + r;
+	float const cp = ((kCos2 * z + kCos1) * z + kCos0) * z * z - 0.5f * z + 1.f;
+
+	float const s = (k & 1) ? cp : sp;
+	float const c = (k & 1) ? sp : cp;
+
+	aSin = (k & 2) ? -s : s;
+	aCos = ((k+1) & 2) ? -c : c;
+}
+
+inline
+void fast_sincos( std::size_t aCount, float const* aAngles, float aScale, float* aSin, float* aCos ) noexcept
+{
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		__m256 const scale = _mm256_set1_ps( aScale );
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			__m256 s, c;
+			vmlib_detail::sincos8_( _mm256_mul_ps( _mm256_loadu_ps( aAngles+i ), scale ), s, c );
+			_mm256_storeu_ps( aSin+i, s );
+			_mm256_storeu_ps( aCos+i, c );
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		__m128 const scale = _mm_set1_ps( aScale );
+		for( ; i + 4 <= aCount; i += 4 )
+		{
+			__m128 s, c;
+			vmlib_detail::sincos4_( _mm_mul_ps( _mm_loadu_ps( aAngles+i ), scale ), s, c );
+			_mm_storeu_ps( aSin+i, s );
+			_mm_storeu_ps( aCos+i, c );
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < aCount; ++i )
+		fast_sincos( aScale * aAngles[i], aSin[i], aCos[i] );
+}
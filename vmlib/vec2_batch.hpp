@@ -0,0 +1,97 @@
+#ifndef VEC2_BATCH_HPP_9A58D802_292C_4EF0_9BD9_5BC0EB8BDE76
+#define VEC2_BATCH_HPP_9A58D802_292C_4EF0_9BD9_5BC0EB8BDE76
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vec2.hpp"
+#include "mat22.hpp"
+#include "simd.hpp"
+
+/** Vec2fBatch : many 2D vectors, stored as structure-of-arrays (SoA)
+ *
+ * Instead of an array of Vec2f { x, y } pairs, all x coordinates are stored
+ * in one array, and all y coordinates in another. This lets the batch kernels
+ * below process 4 (SSE) or 8 (AVX) vectors per instruction without shuffling
+ * data around.
+ *
+ * Use get()/set() for individual elements. The x and y arrays are public, so
+ * they can be passed to the pointer-based kernels directly.
+ */
+struct Vec2fBatch
+{
+	std::vector<float> x, y;
+
+	std::size_t size() const noexcept { return x.size(); }
+	bool empty() const noexcept { return x.empty(); }
+
+	void resize( std::size_t aCount ) { x.resize( aCount ); y.resize( aCount ); }
+	void reserve( std::size_t aCount ) { x.reserve( aCount ); y.reserve( aCount ); }
+	void clear() noexcept { x.clear(); y.clear(); }
+
+	void push_back( Vec2f aVec ) { x.push_back( aVec.x ); y.push_back( aVec.y ); }
+
+	Vec2f get( std::size_t aIndex ) const noexcept { return { x[aIndex], y[aIndex] }; }
+	void set( std::size_t aIndex, Vec2f aVec ) noexcept { x[aIndex] = aVec.x; y[aIndex] = aVec.y; }
+};
+
+/** Box2f : axis aligned bounding box
+ *
+ * An empty box (e.g., from bounding_box() with zero points) has min > max.
+ */
+struct Box2f
+{
+	Vec2f min, max;
+};
+
+
+// Kernels. The pointer-based versions are the actual implementations; the
+// Vec2fBatch overloads forward to them. Unless stated otherwise, the output
+// may alias the input (in-place operation), but must not overlap it
+// partially.
+
+/* Transform points: out[i] = aMat * in[i] + aTransl
+ *
+ * This is the transformation that LineStrip::draw() and TriangleFan::draw()
+ * apply to their vertices. The AoS version is provided for those, since they
+ * store their vertices as arrays of Vec2f.
+ */
+void transform_points( std::size_t aCount, float const* aInX, float const* aInY, Mat22f const& aMat, Vec2f aTransl, float* aOutX, float* aOutY ) noexcept;
+void transform_points( std::size_t aCount, Vec2f const* aIn, Mat22f const& aMat, Vec2f aTransl, Vec2f* aOut ) noexcept;
+
+void transform_points( Vec2fBatch const& aIn, Mat22f const& aMat, Vec2f aTransl, Vec2fBatch& aOut );
+
+/* Translate points: inout[i] += aOffset */
+void translate_points( std::size_t aCount, float* aX, float* aY, Vec2f aOffset ) noexcept;
+void translate_points( Vec2fBatch& aInOut, Vec2f aOffset ) noexcept;
+
+/* Add scaled vectors: inout[i] += aScale * aDir[i] + aOffset
+ *
+ * E.g., advance positions by velocity * dt, while also moving them by a
+ * common offset.
+ */
+void add_scaled( std::size_t aCount, float* aX, float* aY, float const* aDirX, float const* aDirY, float aScale, Vec2f aOffset ) noexcept;
+void add_scaled( Vec2fBatch& aInOut, Vec2fBatch const& aDir, float aScale, Vec2f aOffset ) noexcept;
+
+/* Bounding box of the points */
+Box2f bounding_box( std::size_t aCount, float const* aX, float const* aY ) noexcept;
+Box2f bounding_box( std::size_t aCount, Vec2f const* aPoints ) noexcept;
+
+Box2f bounding_box( Vec2fBatch const& ) noexcept;
+
+/* Circles that overlap a box
+ *
+ * Writes the index i of each circle (aX[i], aY[i]) with radius aRadius[i]
+ * that overlaps aBox, i.e., whose center is at most aRadius[i] away from the
+ * box, to aOut, in increasing order. Returns the number of indices written;
+ * aOut must have room for aCount. Circles with NaN coordinates are rejected.
+ *
+ * E.g., cull objects with a bounding circle against the viewport.
+ */
+std::size_t circles_in_box( std::size_t aCount, float const* aX, float const* aY, float const* aRadius, Box2f const& aBox, std::uint32_t* aOut ) noexcept;
+std::size_t circles_in_box( Vec2fBatch const& aCenters, float const* aRadius, Box2f const& aBox, std::uint32_t* aOut ) noexcept;
+
+#include "vec2_batch.inl"
+#endif // VEC2_BATCH_HPP_9A58D802_292C_4EF0_9BD9_5BC0EB8BDE76
@@ -0,0 +1,484 @@
+#include <bit>
+#include <limits>
+#include <algorithm>
+
+#include <cassert>
+
+/* Implementation notes
+ *
+ * Each kernel consists of a SIMD main loop followed by a scalar tail loop that
+ * handles the remaining elements (and all elements in the scalar fallback).
+ * With AVX2, the main loop processes 8 floats per iteration; if the remainder
+ * is large enough, an SSE loop over 4 floats follows. Loads and stores are
+ * unaligned; std::vector does not provide 32-byte alignment, and unaligned
+ * accesses to aligned data have no penalty on current x86 CPUs.
+ */
+
+namespace vmlib_detail
+{
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	// Reduce the upper and lower 128-bit halves into one.
+	inline
+	__m128 min_halves_( __m256 aV ) noexcept
+	{
+		return _mm_min_ps( _mm256_castps256_ps128( aV ), _mm256_extractf128_ps( aV, 1 ) );
+	}
+	inline
+	__m128 max_halves_( __m256 aV ) noexcept
+	{
+		return _mm_max_ps( _mm256_castps256_ps128( aV ), _mm256_extractf128_ps( aV, 1 ) );
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	inline
+	float hmin4_( __m128 aV ) noexcept
+	{
+		aV = _mm_min_ps( aV, _mm_movehl_ps( aV, aV ) );
+		aV = _mm_min_ss( aV, _mm_shuffle_ps( aV, aV, _MM_SHUFFLE(1,1,1,1) ) );
+		return _mm_cvtss_f32( aV );
+	}
+	inline
+	float hmax4_( __m128 aV ) noexcept
+	{
+		aV = _mm_max_ps( aV, _mm_movehl_ps( aV, aV ) );
+		aV = _mm_max_ss( aV, _mm_shuffle_ps( aV, aV, _MM_SHUFFLE(1,1,1,1) ) );
+		return _mm_cvtss_f32( aV );
+	}
+#	endif // ~ SSE2
+
+	inline
+	Box2f empty_box_() noexcept
+	{
+		constexpr float kInf = std::numeric_limits<float>::infinity();
+		return { { kInf, kInf }, { -kInf, -kInf } };
+	}
+}
+
+
+inline
+void transform_points( std::size_t aCount, float const* aInX, float const* aInY, Mat22f const& aMat, Vec2f aTransl, float* aOutX, float* aOutY ) noexcept
+{
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		using namespace vmlib_detail;
+
+		__m256 const m00 = _mm256_set1_ps( aMat._00 ), m01 = _mm256_set1_ps( aMat._01 );
+		__m256 const m10 = _mm256_set1_ps( aMat._10 ), m11 = _mm256_set1_ps( aMat._11 );
+		__m256 const tx = _mm256_set1_ps( aTransl.x ), ty = _mm256_set1_ps( aTransl.y );
+
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			__m256 const x = _mm256_loadu_ps( aInX+i );
+			__m256 const y = _mm256_loadu_ps( aInY+i );
+
+			_mm256_storeu_ps( aOutX+i, madd8_( m00, x, madd8_( m01, y, tx ) ) );
+			_mm256_storeu_ps( aOutY+i, madd8_( m10, x, madd8_( m11, y, ty ) ) );
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		using namespace vmlib_detail;
+
+		__m128 const m00 = _mm_set1_ps( aMat._00 ), m01 = _mm_set1_ps( aMat._01 );
+		__m128 const m10 = _mm_set1_ps( aMat._10 ), m11 = _mm_set1_ps( aMat._11 );
+		__m128 const tx = _mm_set1_ps( aTransl.x ), ty = _mm_set1_ps( aTransl.y );
+
+		for( ; i + 4 <= aCount; i += 4 )
+		{
+			__m128 const x = _mm_loadu_ps( aInX+i );
+			__m128 const y = _mm_loadu_ps( aInY+i );
+
+			_mm_storeu_ps( aOutX+i, madd4_( m00, x, madd4_( m01, y, tx ) ) );
+			_mm_storeu_ps( aOutY+i, madd4_( m10, x, madd4_( m11, y, ty ) ) );
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < aCount; ++i )
+	{
+		float const x = aInX[i], y = aInY[i];
+		aOutX[i] = aMat._00 * x + aMat._01 * y + aTransl.x;
+		aOutY[i] = aMat._10 * x + aMat._11 * y + aTransl.y;
+	}
+}
+
+inline
+void transform_points( std::size_t aCount, Vec2f const* aIn, Mat22f const& aMat, Vec2f aTransl, Vec2f* aOut ) noexcept
+{
+	// AoS: a register holds interleaved x0 y0 x1 y1 ... Swapping neighbours
+	// gives y0 x0 y1 x1 ..., so that
+	//   out = in * (m00 m11 ...) + swapped * (m01 m10 ...) + (tx ty ...)
+	// computes both components without horizontal operations.
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	float const* in = reinterpret_cast<float const*>(aIn);
+	float* out = reinterpret_cast<float*>(aOut);
+#	endif // ~ SSE2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		using namespace vmlib_detail;
+
+		__m256 const ma = _mm256_setr_ps( aMat._00, aMat._11, aMat._00, aMat._11, aMat._00, aMat._11, aMat._00, aMat._11 );
+		__m256 const mb = _mm256_setr_ps( aMat._01, aMat._10, aMat._01, aMat._10, aMat._01, aMat._10, aMat._01, aMat._10 );
+		__m256 const tt = _mm256_setr_ps( aTransl.x, aTransl.y, aTransl.x, aTransl.y, aTransl.x, aTransl.y, aTransl.x, aTransl.y );
+
+		for( ; i + 4 <= aCount; i += 4 )
+		{
+			__m256 const v = _mm256_loadu_ps( in + 2*i );
+			__m256 const s = _mm256_permute_ps( v, _MM_SHUFFLE(2,3,0,1) );
+			_mm256_storeu_ps( out + 2*i, madd8_( v, ma, madd8_( s, mb, tt ) ) );
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		using namespace vmlib_detail;
+
+		__m128 const ma = _mm_setr_ps( aMat._00, aMat._11, aMat._00, aMat._11 );
+		__m128 const mb = _mm_setr_ps( aMat._01, aMat._10, aMat._01, aMat._10 );
+		__m128 const tt = _mm_setr_ps( aTransl.x, aTransl.y, aTransl.x, aTransl.y );
+
+		for( ; i + 2 <= aCount; i += 2 )
+		{
+			__m128 const v = _mm_loadu_ps( in + 2*i );
+			__m128 const s = _mm_shuffle_ps( v, v, _MM_SHUFFLE(2,3,0,1) );
+			_mm_storeu_ps( out + 2*i, madd4_( v, ma, madd4_( s, mb, tt ) ) );
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < aCount; ++i )
+		aOut[i] = aMat * aIn[i] + aTransl;
+}
+
+inline
+void transform_points( Vec2fBatch const& aIn, Mat22f const& aMat, Vec2f aTransl, Vec2fBatch& aOut )
+{
+	aOut.resize( aIn.size() );
+	transform_points( aIn.size(), aIn.x.data(), aIn.y.data(), aMat, aTransl, aOut.x.data(), aOut.y.data() );
+}
+
+
+inline
+void translate_points( std::size_t aCount, float* aX, float* aY, Vec2f aOffset ) noexcept
+{
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		__m256 const ox = _mm256_set1_ps( aOffset.x ), oy = _mm256_set1_ps( aOffset.y );
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			_mm256_storeu_ps( aX+i, _mm256_add_ps( _mm256_loadu_ps( aX+i ), ox ) );
+			_mm256_storeu_ps( aY+i, _mm256_add_ps( _mm256_loadu_ps( aY+i ), oy ) );
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		__m128 const ox = _mm_set1_ps( aOffset.x ), oy = _mm_set1_ps( aOffset.y );
+		for( ; i + 4 <= aCount; i += 4 )
+		{
+			_mm_storeu_ps( aX+i, _mm_add_ps( _mm_loadu_ps( aX+i ), ox ) );
+			_mm_storeu_ps( aY+i, _mm_add_ps( _mm_loadu_ps( aY+i ), oy ) );
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < aCount; ++i )
+	{
+		aX[i] += aOffset.x;
+		aY[i] += aOffset.y;
+	}
+}
+
+inline
+void translate_points( Vec2fBatch& aInOut, Vec2f aOffset ) noexcept
+{
+	translate_points( aInOut.size(), aInOut.x.data(), aInOut.y.data(), aOffset );
+}
+
+
+inline
+void add_scaled( std::size_t aCount, float* aX, float* aY, float const* aDirX, float const* aDirY, float aScale, Vec2f aOffset ) noexcept
+{
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		using namespace vmlib_detail;
+
+		__m256 const s = _mm256_set1_ps( aScale );
+		__m256 const ox = _mm256_set1_ps( aOffset.x ), oy = _mm256_set1_ps( aOffset.y );
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			__m256 const x = _mm256_add_ps( _mm256_loadu_ps( aX+i ), ox );
+			__m256 const y = _mm256_add_ps( _mm256_loadu_ps( aY+i ), oy );
+			_mm256_storeu_ps( aX+i, madd8_( s, _mm256_loadu_ps( aDirX+i ), x ) );
+			_mm256_storeu_ps( aY+i, madd8_( s, _mm256_loadu_ps( aDirY+i ), y ) );
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		using namespace vmlib_detail;
+
+		__m128 const s = _mm_set1_ps( aScale );
+		__m128 const ox = _mm_set1_ps( aOffset.x ), oy = _mm_set1_ps( aOffset.y );
+		for( ; i + 4 <= aCount; i += 4 )
+		{
+			__m128 const x = _mm_add_ps( _mm_loadu_ps( aX+i ), ox );
+			__m128 const y = _mm_add_ps( _mm_loadu_ps( aY+i ), oy );
+			_mm_storeu_ps( aX+i, madd4_( s, _mm_loadu_ps( aDirX+i ), x ) );
+			_mm_storeu_ps( aY+i, madd4_( s, _mm_loadu_ps( aDirY+i ), y ) );
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < aCount; ++i )
+	{
+		aX[i] += aScale * aDirX[i] + aOffset.x;
+		aY[i] += aScale * aDirY[i] + aOffset.y;
+	}
+}
+
+inline
+void add_scaled( Vec2fBatch& aInOut, Vec2fBatch const& aDir, float aScale, Vec2f aOffset ) noexcept
+{
+	assert( aInOut.size() == aDir.size() );
+	add_scaled( aInOut.size(), aInOut.x.data(), aInOut.y.data(), aDir.x.data(), aDir.y.data(), aScale, aOffset );
+}
+
+
+inline
+Box2f bounding_box( std::size_t aCount, float const* aX, float const* aY ) noexcept
+{
+	Box2f ret = vmlib_detail::empty_box_();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		using namespace vmlib_detail;
+
+		__m128 minx = _mm_set1_ps( ret.min.x ), miny = minx;
+		__m128 maxx = _mm_set1_ps( ret.max.x ), maxy = maxx;
+
+#		if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+		if( aCount >= 8 )
+		{
+			__m256 minx8 = _mm256_set1_ps( ret.min.x ), miny8 = minx8;
+			__m256 maxx8 = _mm256_set1_ps( ret.max.x ), maxy8 = maxx8;
+			for( ; i + 8 <= aCount; i += 8 )
+			{
+				__m256 const x = _mm256_loadu_ps( aX+i );
+				__m256 const y = _mm256_loadu_ps( aY+i );
+				minx8 = _mm256_min_ps( minx8, x );
+				miny8 = _mm256_min_ps( miny8, y );
+				maxx8 = _mm256_max_ps( maxx8, x );
+				maxy8 = _mm256_max_ps( maxy8, y );
+			}
+
+			minx = min_halves_( minx8 );
+			miny = min_halves_( miny8 );
+			maxx = max_halves_( maxx8 );
+			maxy = max_halves_( maxy8 );
+		}
+#		endif // ~ AVX2
+
+		for( ; i + 4 <= aCount; i += 4 )
+		{
+			__m128 const x = _mm_loadu_ps( aX+i );
+			__m128 const y = _mm_loadu_ps( aY+i );
+			minx = _mm_min_ps( minx, x );
+			miny = _mm_min_ps( miny, y );
+			maxx = _mm_max_ps( maxx, x );
+			maxy = _mm_max_ps( maxy, y );
+		}
+
+		ret.min = Vec2f{ hmin4_( minx ), hmin4_( miny ) };
+		ret.max = Vec2f{ hmax4_( maxx ), hmax4_( maxy ) };
+	}
+#	endif // ~ SSE2
+
+	for( ; i < aCount; ++i )
+	{
+		ret.min.x = std::min( ret.min.x, aX[i] );
+		ret.min.y = std::min( ret.min.y, aY[i] );
+		ret.max.x = std::max( ret.max.x, aX[i] );
+		ret.max.y = std::max( ret.max.y, aY[i] );
+	}
+
+	return ret;
+}
+
+inline
+Box2f bounding_box( std::size_t aCount, Vec2f const* aPoints ) noexcept
+{
+	Box2f ret = vmlib_detail::empty_box_();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		// AoS: lanes alternate between x and y. The accumulators hold
+		// per-lane minima/maxima, which are reduced to a single x/y pair at
+		// the end.
+		using namespace vmlib_detail;
+
+		float const* pts = reinterpret_cast<float const*>(aPoints);
+
+		__m128 lo = _mm_setr_ps( ret.min.x, ret.min.y, ret.min.x, ret.min.y );
+		__m128 hi = _mm_setr_ps( ret.max.x, ret.max.y, ret.max.x, ret.max.y );
+
+#		if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+		if( aCount >= 4 )
+		{
+			__m256 lo8 = _mm256_set1_ps( ret.min.x );
+			__m256 hi8 = _mm256_set1_ps( ret.max.x );
+			for( ; i + 4 <= aCount; i += 4 )
+			{
+				__m256 const v = _mm256_loadu_ps( pts + 2*i );
+				lo8 = _mm256_min_ps( lo8, v );
+				hi8 = _mm256_max_ps( hi8, v );
+			}
+
+			lo = min_halves_( lo8 );
+			hi = max_halves_( hi8 );
+		}
+#		endif // ~ AVX2
+
+		for( ; i + 2 <= aCount; i += 2 )
+		{
+			__m128 const v = _mm_loadu_ps( pts + 2*i );
+			lo = _mm_min_ps( lo, v );
+			hi = _mm_max_ps( hi, v );
+		}
+
+		// Lanes 0,1 = min(lanes 0,2), min(lanes 1,3)
+		lo = _mm_min_ps( lo, _mm_movehl_ps( lo, lo ) );
+		hi = _mm_max_ps( hi, _mm_movehl_ps( hi, hi ) );
+
+		alignas(16) float tmp[8];
+		_mm_store_ps( tmp, lo );
+		_mm_store_ps( tmp+4, hi );
+
+		ret.min = Vec2f{ tmp[0], tmp[1] };
+		ret.max = Vec2f{ tmp[4], tmp[5] };
+	}
+#	endif // ~ SSE2
+
+	for( ; i < aCount; ++i )
+	{
+		ret.min.x = std::min( ret.min.x, aPoints[i].x );
+		ret.min.y = std::min( ret.min.y, aPoints[i].y );
+		ret.max.x = std::max( ret.max.x, aPoints[i].x );
+		ret.max.y = std::max( ret.max.y, aPoints[i].y );
+	}
+
+	return ret;
+}
+
+inline
+Box2f bounding_box( Vec2fBatch const& aPoints ) noexcept
+{
+	return bounding_box( aPoints.size(), aPoints.x.data(), aPoints.y.data() );
+}
+
+
+inline
+std::size_t circles_in_box( std::size_t aCount, float const* aX, float const* aY, float const* aRadius, Box2f const& aBox, std::uint32_t* aOut ) noexcept
+{
+	assert( aCount <= std::numeric_limits<std::uint32_t>::max() );
+
+	// Squared distance from the center to the box, compared against the
+	// squared radius. The distance along an axis is max(min-x, x-max, 0).
+	std::size_t i = 0, n = 0;
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_AVX2
+	{
+		using namespace vmlib_detail;
+
+		__m256 const minx = _mm256_set1_ps( aBox.min.x ), miny = _mm256_set1_ps( aBox.min.y );
+		__m256 const maxx = _mm256_set1_ps( aBox.max.x ), maxy = _mm256_set1_ps( aBox.max.y );
+		__m256 const zero = _mm256_setzero_ps();
+
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			__m256 const x = _mm256_loadu_ps( aX+i );
+			__m256 const y = _mm256_loadu_ps( aY+i );
+			__m256 const r = _mm256_loadu_ps( aRadius+i );
+
+			__m256 const dx = _mm256_max_ps( _mm256_max_ps( _mm256_sub_ps( minx, x ), _mm256_sub_ps( x, maxx ) ), zero );
+			__m256 const dy = _mm256_max_ps( _mm256_max_ps( _mm256_sub_ps( miny, y ), _mm256_sub_ps( y, maxy ) ), zero );
+
+			// The max()es may drop NaNs (they return the second operand if
+			// either is NaN), hence the explicit check.
+			__m256 const d2 = madd8_( dx, dx, _mm256_mul_ps( dy, dy ) );
+			__m256 const inside = _mm256_and_ps(
+				_mm256_cmp_ps( d2, _mm256_mul_ps( r, r ), _CMP_LE_OQ ),
+				_mm256_cmp_ps( x, y, _CMP_ORD_Q )
+			);
+
+			for( unsigned mask = unsigned(_mm256_movemask_ps( inside )); mask; mask &= mask-1 )
+				aOut[n++] = std::uint32_t(i + std::countr_zero( mask ));
+		}
+	}
+#	endif // ~ AVX2
+
+#	if VMLIB_SIMD_LEVEL >= VMLIB_SIMD_SSE2
+	{
+		using namespace vmlib_detail;
+
+		__m128 const minx = _mm_set1_ps( aBox.min.x ), miny = _mm_set1_ps( aBox.min.y );
+		__m128 const maxx = _mm_set1_ps( aBox.max.x ), maxy = _mm_set1_ps( aBox.max.y );
+		__m128 const zero = _mm_setzero_ps();
+
+		for( ; i + 4 <= aCount; i += 4 )
+		{
+			__m128 const x = _mm_loadu_ps( aX+i );
+			__m128 const y = _mm_loadu_ps( aY+i );
+			__m128 const r = _mm_loadu_ps( aRadius+i );
+
+			__m128 const dx = _mm_max_ps( _mm_max_ps( _mm_sub_ps( minx, x ), _mm_sub_ps( x, maxx ) ), zero );
+			__m128 const dy = _mm_max_ps( _mm_max_ps( _mm_sub_ps( miny, y ), _mm_sub_ps( y, maxy ) ), zero );
+
+			__m128 const d2 = madd4_( dx, dx, _mm_mul_ps( dy, dy ) );
+			__m128 const inside = _mm_and_ps(
+				_mm_cmple_ps( d2, _mm_mul_ps( r, r ) ),
+				_mm_cmpord_ps( x, y )
+			);
+
+			for( unsigned mask = unsigned(_mm_movemask_ps( inside )); mask; mask &= mask-1 )
+				aOut[n++] = std::uint32_t(i + std::countr_zero( mask ));
+		}
+	}
+#	endif // ~ SSE2
+
+	for( ; i < aCount; ++i )
+	{
+		float const dx = std::max( std::max( aBox.min.x - aX[i], aX[i] - aBox.max.x ), 0.f );
+		float const dy = std::max( std::max( aBox.min.y - aY[i], aY[i] - aBox.max.y ), 0.f );
+
+		if( dx*dx + dy*dy <= aRadius[i]*aRadius[i] && aX[i] == aX[i] && aY[i] == aY[i] )
+			aOut[n++] = std::uint32_t(i);
+	}
+
+	return n;
+}
+
+inline
+std::size_t circles_in_box( Vec2fBatch const& aCenters, float const* aRadius, Box2f const& aBox, std::uint32_t* aOut ) noexcept
+{
+	return circles_in_box( aCenters.size(), aCenters.x.data(), aCenters.y.data(), aRadius, aBox, aOut );
+}